@@ -0,0 +1,72 @@
+#!/bin/bash
+#
+# Runs the enumerator on each configuration of bench/configs.txt and writes
+# one tab-separated line per configuration:
+#
+#   version  config  args  wall_s  peak_rss_kb  n_visited  n_distinct  checksum
+#
+# n_visited is the number of output lines (derivative genomes reached),
+# n_distinct the number of them printed with a genome string, and checksum
+# the SHA-256 of the output, which is deterministic. Peak RSS needs GNU time
+# (/usr/bin/time) and is NA without it.
+#
+# Usage: bench/bench.sh <binary>
+# Environment: BENCH_ARGS (extra arguments for every run), BENCH_OUT (results
+# file, default bench/results/<version>.tsv), BENCH_CONFIGS (configurations
+# file, default bench/configs.txt).
+
+set -euo pipefail
+
+if [ $# -ne 1 ]; then
+    echo "Usage: $0 <binary>" >&2
+    exit 1
+fi
+binary=$1
+bench_dir=$(cd "$(dirname "$0")" && pwd)
+configs=${BENCH_CONFIGS:-$bench_dir/configs.txt}
+args=${BENCH_ARGS:-}
+
+version=$(git -C "$bench_dir" describe --always --dirty 2>/dev/null || echo unknown)
+out=${BENCH_OUT:-}
+if [ -z "$out" ]; then
+    mkdir -p "$bench_dir/results"
+    out=$bench_dir/results/$version.tsv
+fi
+
+time_bin=""
+if [ -x /usr/bin/time ] && /usr/bin/time -f "%M" true >/dev/null 2>&1; then
+    time_bin=/usr/bin/time
+fi
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+printf "version\tconfig\targs\twall_s\tpeak_rss_kb\tn_visited\tn_distinct\tchecksum\n" > "$out"
+while read -r config; do
+    case "$config" in
+        ""|\#*) continue ;;
+    esac
+
+    echo "Running $config $args..." >&2
+    start=$(date +%s%N)
+    if [ -n "$time_bin" ]; then
+        # shellcheck disable=SC2086
+        "$time_bin" -f "%M" -o "$tmp/rss" "$binary" $config $args > "$tmp/out" 2> "$tmp/err"
+        rss=$(tail -n 1 "$tmp/rss")
+    else
+        # shellcheck disable=SC2086
+        "$binary" $config $args > "$tmp/out" 2> "$tmp/err"
+        rss=NA
+    fi
+    end=$(date +%s%N)
+
+    wall=$(awk -v ns=$((end - start)) 'BEGIN { printf "%.3f", ns / 1e9 }')
+    n_visited=$(wc -l < "$tmp/out" | tr -d ' ')
+    n_distinct=$(awk '$NF ~ /^{/' "$tmp/out" | wc -l | tr -d ' ')
+    checksum=$(sha256sum < "$tmp/out" | cut -d ' ' -f 1)
+
+    printf "%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\n" "$version" "$config" "$args" "$wall" "$rss" "$n_visited" "$n_distinct" "$checksum" >> "$out"
+done < "$configs"
+
+cat "$out"
+echo "Results written to $out" >&2
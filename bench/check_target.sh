@@ -0,0 +1,79 @@
+#!/bin/bash
+#
+# Checks that --target finds each rearrangement pattern at the same minimal
+# overall depth as the exhaustive enumeration, e.g. after changing the lower
+# bounds used to prune the target search.
+#
+# The exhaustive output is reduced to the minimal depth of every distinct
+# pattern (columns 3 and 4), and a sample of evenly spaced patterns is then
+# searched with --target. The check fails for a pattern if --target finds no
+# histories, or prints a line with another pattern or another depth.
+#
+# Usage: bench/check_target.sh <binary> <n_chrs> <diploid> <max_dup_depth> <max_overall_depth> [n_patterns]
+# n_patterns defaults to 20. Exits with status 0 if all sampled patterns agree,
+# 1 otherwise.
+
+set -euo pipefail
+
+if [ $# -lt 5 ] || [ $# -gt 6 ]; then
+    echo "Usage: $0 <binary> <n_chrs> <diploid> <max_dup_depth> <max_overall_depth> [n_patterns]" >&2
+    exit 1
+fi
+bin=$1
+config="$2 $3 $4 $5"
+n_patterns=${6:-20}
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# Writes the records "<depth>\t<cn_pattern>\t<rg_pattern>" of output $1, with
+# the minimal depth of each pattern
+min_depths() {
+    awk -F'[ ]' '
+        {
+            depth = ($2 == "" ? 0 : split($2, events, "-"))
+            pattern = $3 "\t" $4
+            if (!(pattern in min_depth) || depth < min_depth[pattern]) {
+                min_depth[pattern] = depth
+            }
+        }
+        END {
+            for (pattern in min_depth) {
+                printf("%d\t%s\n", min_depth[pattern], pattern)
+            }
+        }
+    ' "$1"
+}
+
+echo "Enumerating $config exhaustively..." >&2
+$bin $config > "$tmp/exhaustive.txt" 2> /dev/null
+min_depths "$tmp/exhaustive.txt" | LC_ALL=C sort -t$'\t' -k2 > "$tmp/patterns.tsv"
+n_total=$(wc -l < "$tmp/patterns.tsv")
+step=$(( n_total > n_patterns ? n_total / n_patterns : 1 ))
+
+n_checked=0
+n_failed=0
+while IFS=$'\t' read -r depth cn_pattern rg_pattern; do
+    n_checked=$((n_checked + 1))
+    $bin $config --target "$cn_pattern" "$rg_pattern" > "$tmp/target.txt" 2> /dev/null
+    result=$(min_depths "$tmp/target.txt" | awk -F'\t' -v depth="$depth" -v cn="$cn_pattern" -v rg="$rg_pattern" '
+        $1 != depth || $2 != cn || $3 != rg {
+            n_other++
+        }
+        END {
+            if (NR == 0) {
+                print "not found"
+            }
+            else if (n_other > 0) {
+                print "found at another depth or with another pattern"
+            }
+        }
+    ')
+    if [ -n "$result" ]; then
+        n_failed=$((n_failed + 1))
+        echo "Pattern '$cn_pattern $rg_pattern' of minimal depth $depth: $result" >&2
+    fi
+done < <(awk -v step="$step" -v n="$n_patterns" '(NR - 1) % step == 0 && (NR - 1) / step < n' "$tmp/patterns.tsv")
+
+echo "Patterns: $n_checked of $n_total checked, $n_failed with a different minimal depth"
+exit $(( n_failed > 0 ? 1 : 0 ))
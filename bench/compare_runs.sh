@@ -0,0 +1,144 @@
+#!/bin/bash
+#
+# Compares the outputs of two runs of the enumerator independently of the
+# order of their lines and of the histories chosen to represent each genome,
+# e.g. to verify a reworked engine against the original one.
+#
+# Each output is reduced to the set of distinct canonical genome strings
+# (column 5, or the genome of the line referred to by column 5) with the
+# minimal (depth, dup_depth) among all the lines reaching each genome, and to
+# the set of distinct rearrangement patterns (columns 3 and 4). The patterns
+# are compared as a set rather than per genome, because a pattern is written
+# in the reference coordinates of the history reaching the genome, so the
+# same genome can be printed with equivalent patterns, e.g. with maternal and
+# paternal copy numbers swapped. The two runs agree if they have the same
+# genomes, with the same minimal depths, and the same patterns.
+#
+# Usage: bench/compare_runs.sh <output_a> <output_b>
+# Exits with status 0 if the runs agree, 1 otherwise.
+
+set -euo pipefail
+
+if [ $# -ne 2 ]; then
+    echo "Usage: $0 <output_a> <output_b>" >&2
+    exit 1
+fi
+
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# Writes the records "genome <genome> <depth> <dup_depth>" and
+# "pattern <cn_pattern> <rg_pattern>", tab-separated, of output $1, sorted
+summarise() {
+    awk -F'[ ]' -v name="$1" '
+        BEGIN {
+            is_dup["td"] = is_dup["id"] = is_dup["fb"] = is_dup["wcg"] = is_dup["wgd"] = 1
+            n_pending = n_genomes = 0
+        }
+        function record(genome, depth, dup_depth) {
+            if (!(genome in min_depth)) {
+                n_genomes++
+            }
+            if (!(genome in min_depth) || depth < min_depth[genome] || (depth == min_depth[genome] && dup_depth < min_dup_depth[genome])) {
+                min_depth[genome] = depth
+                min_dup_depth[genome] = dup_depth
+            }
+        }
+        {
+            depth = ($2 == "" ? 0 : split($2, events, "-"))
+            dup_depth = 0
+            for (i=1; i<=depth; i++) {
+                if (events[i] in is_dup) {
+                    dup_depth++
+                }
+            }
+            patterns[$3 "\t" $4] = 1
+
+            if (substr($5, 1, 1) == "{") {
+                genome_of[$1] = $5
+                record($5, depth, dup_depth)
+            }
+            else {
+                # A reference to the history of an earlier line, resolved at the end
+                n_pending++
+                pending_hist[n_pending] = $5
+                pending_depth[n_pending] = depth
+                pending_dup_depth[n_pending] = dup_depth
+            }
+        }
+        END {
+            n_unresolved = 0
+            for (i=1; i<=n_pending; i++) {
+                if (pending_hist[i] in genome_of) {
+                    record(genome_of[pending_hist[i]], pending_depth[i], pending_dup_depth[i])
+                }
+                else {
+                    n_unresolved++
+                }
+            }
+            if (n_unresolved > 0) {
+                printf("%s: %d lines refer to histories not in the output\n", name, n_unresolved) > "/dev/stderr"
+            }
+            printf("%s: %d lines, %d genomes\n", name, NR, n_genomes) > "/dev/stderr"
+            for (genome in min_depth) {
+                printf("genome\t%s\t%d\t%d\n", genome, min_depth[genome], min_dup_depth[genome])
+            }
+            for (pattern in patterns) {
+                printf("pattern\t%s\n", pattern)
+            }
+            exit(n_unresolved > 0 ? 2 : 0)
+        }
+    ' "$1" | LC_ALL=C sort > "$2"
+}
+
+status=0
+summarise "$1" "$tmp/a" || status=1
+summarise "$2" "$tmp/b" || status=1
+
+awk -F'\t' -v name_a="$1" -v name_b="$2" '
+    function report(kind, line) {
+        n[kind]++
+        if (n[kind] <= 5) {
+            print line
+        }
+    }
+    FNR == NR {
+        if ($1 == "genome") {
+            depth_a[$2] = $3 "," $4
+        }
+        else {
+            pattern_a[$2 " " $3] = 1
+        }
+        next
+    }
+    $1 == "genome" {
+        if (!($2 in depth_a)) {
+            report("genome_b", "Genome only in " name_b ": " $2)
+        }
+        else {
+            if (depth_a[$2] != $3 "," $4) {
+                report("depth", "Minimal (depth, dup_depth) of " $2 ": (" depth_a[$2] ") vs (" $3 "," $4 ")")
+            }
+            delete depth_a[$2]
+        }
+    }
+    $1 == "pattern" {
+        if (!(($2 " " $3) in pattern_a)) {
+            report("pattern_b", "Pattern only in " name_b ": " $2 " " $3)
+        }
+        delete pattern_a[$2 " " $3]
+    }
+    END {
+        for (genome in depth_a) {
+            report("genome_a", "Genome only in " name_a ": " genome)
+        }
+        for (pattern in pattern_a) {
+            report("pattern_a", "Pattern only in " name_a ": " pattern)
+        }
+        printf("Genomes: %d only in %s, %d only in %s, %d with different minimal depths\n", n["genome_a"], name_a, n["genome_b"], name_b, n["depth"])
+        printf("Patterns: %d only in %s, %d only in %s\n", n["pattern_a"], name_a, n["pattern_b"], name_b)
+        exit(n["genome_a"] + n["genome_b"] + n["depth"] + n["pattern_a"] + n["pattern_b"] > 0 ? 1 : 0)
+    }
+' "$tmp/a" "$tmp/b" || status=1
+
+exit $status
@@ -0,0 +1,136 @@
+/*
+    Generator of random synthetic genomes for the microbenchmarks and the
+    verification of the genome kernels. Included after
+    rg_enumerator_classes.c.
+*/
+
+/*
+    Functions for generating synthetic genomes
+*/
+struct genome_config {
+    int n_chrs;
+    int diploid;
+    int n_segs;             /* Number of segments to split the WT chromosomes into, if max_times_divided allows */
+    int n_dup_chrs;         /* Number of extra copies of chromosomes */
+    int max_times_divided;  /* Maximum times_divided of a segment, 1 for intact WT chromosomes */
+};
+
+/*
+    Generates a random genome like the ones reached by the enumerator. The WT
+    genome of config->n_chrs chromosomes is split at random breakpoints until
+    it has config->n_segs segments, without dividing any segment more than
+    config->max_times_divided times. The chromosomes are then rearranged by a
+    random inversion, deletion or translocation for every two breakpoints, so
+    that most breakpoints are used, and config->n_dup_chrs random chromosomes
+    are duplicated.
+*/
+struct genome* generate_genome(struct genome_config *config, GRand *rand) {
+    struct genome *g_ptr = create_genome(config->n_chrs, config->diploid);
+    struct chromosome *c_ptr, *c2_ptr, *moved_segs;
+    struct seg *s_ptr;
+    int *seg_indexes, *splittable, n_splittable;
+    int i, from, to, times_divided;
+
+    // Split segments, choosing among those that can still be divided
+    splittable = malloc(config->n_segs * sizeof(int));
+    if (splittable == NULL) {
+        fprintf(stderr, "\nFailed to malloc splittable in generate_genome(). Exiting.\n");
+        exit(1);
+    }
+    while (g_ptr->n_genome_segs < config->n_segs) {
+        n_splittable = 0;
+        for (i=0; i<g_ptr->n_genome_segs; i++) {
+            if ((*(g_ptr->genome_segs+i))->times_divided < config->max_times_divided) {
+                *(splittable+n_splittable++) = i;
+            }
+        }
+        if (n_splittable == 0) {
+            break;
+        }
+
+        // splice_all_segs() changes the segment it is given, so splice by a copy of its indexes
+        s_ptr = *(g_ptr->genome_segs + *(splittable + g_rand_int_range(rand, 0, n_splittable)));
+        times_divided = s_ptr->times_divided;
+        seg_indexes = malloc(times_divided * sizeof(int));
+        if (seg_indexes == NULL) {
+            fprintf(stderr, "\nFailed to malloc seg_indexes in generate_genome(). Exiting.\n");
+            exit(1);
+        }
+        memcpy(seg_indexes, s_ptr->seg_indexes, times_divided * sizeof(int));
+        splice_all_segs(g_ptr, seg_indexes, times_divided, (config->n_segs - g_ptr->n_genome_segs > 1 ? g_rand_int_range(rand, 2, 4) : 2));
+        free(seg_indexes);
+    }
+    free(splittable);
+
+    // Rearrange
+    for (i=0; i<(g_ptr->n_genome_segs - config->n_chrs)/2 + 1; i++) {
+        c_ptr = *(g_ptr->root_chr + g_rand_int_range(rand, 0, g_ptr->n_chrs));
+        from = g_rand_int_range(rand, 0, c_ptr->n_segs);
+        to = g_rand_int_range(rand, from, c_ptr->n_segs);
+        switch (g_rand_int_range(rand, 0, 3)) {
+            case 0:
+                invert_segs_in_chr(c_ptr, from, to);
+                break;
+            case 1:
+                // Keep at least one segment on the chromosome
+                if (to - from + 1 < c_ptr->n_segs) {
+                    delete_segs_from_chr(c_ptr, from, to);
+                }
+                break;
+            case 2:
+                // Move the segments to another chromosome, or within the same one
+                c2_ptr = *(g_ptr->root_chr + g_rand_int_range(rand, 0, g_ptr->n_chrs));
+                if (c2_ptr != c_ptr && to - from + 1 < c_ptr->n_segs) {
+                    moved_segs = yank_segments(c_ptr, from, to);
+                    delete_segs_from_chr(c_ptr, from, to);
+                    insert_segs_into_chr(c2_ptr, moved_segs, g_rand_int_range(rand, 0, c2_ptr->n_segs + 1));
+                    delete_chromosome(moved_segs);
+                }
+                break;
+        }
+    }
+
+    // Duplicate whole chromosomes
+    for (i=0; i<config->n_dup_chrs; i++) {
+        c_ptr = *(g_ptr->root_chr + g_rand_int_range(rand, 0, g_ptr->n_chrs));
+        g_ptr->n_chrs += 1;
+        g_ptr->root_chr = realloc(g_ptr->root_chr, g_ptr->n_chrs * sizeof(struct chromosome*));
+        if (g_ptr->root_chr == NULL) {
+            fprintf(stderr, "\nFailed to realloc g_ptr->root_chr in generate_genome(). Exiting.\n");
+            exit(1);
+        }
+        *(g_ptr->root_chr + g_ptr->n_chrs - 1) = copy_chromosome(c_ptr);
+    }
+
+    return(g_ptr);
+}
+
+/* Copy of *g_ptr as a freshly rearranged genome, i.e. without interned data or canonical labeling */
+struct genome* copy_genome_cold(struct genome *g_ptr) {
+    struct genome *new_g_ptr = copy_genome(g_ptr);
+    int c_idx;
+    for (c_idx=0; c_idx<new_g_ptr->n_chrs; c_idx++) {
+        (*(new_g_ptr->root_chr+c_idx))->info = NULL;
+    }
+    free(new_g_ptr->canonical_chr_ids);
+    free(new_g_ptr->canonical_wt_chr_reversed);
+    new_g_ptr->canonical_chr_ids = new_g_ptr->canonical_wt_chr_reversed = NULL;
+    new_g_ptr->n_canonical_chrs = new_g_ptr->n_canonical_wt_chrs = 0;
+    return(new_g_ptr);
+}
+/*
+    Reads the configuration <n_chrs> <diploid> <n_segs> <n_dup_chrs> <max_times_divided>
+    from the five strings at *args. Returns 0 if they are not a valid configuration.
+*/
+int parse_genome_config(char **args, struct genome_config *config) {
+    return(
+        sscanf(*(args+0), "%d", &config->n_chrs) == 1 && config->n_chrs > 0 &&
+        sscanf(*(args+1), "%d", &config->diploid) == 1 &&
+        sscanf(*(args+2), "%d", &config->n_segs) == 1 &&
+        sscanf(*(args+3), "%d", &config->n_dup_chrs) == 1 && config->n_dup_chrs >= 0 &&
+        sscanf(*(args+4), "%d", &config->max_times_divided) == 1 && config->max_times_divided > 0
+    );
+}
+/*
+    End functions for generating synthetic genomes
+*/
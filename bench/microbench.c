@@ -0,0 +1,302 @@
+/*
+    Microbenchmarks of the genome kernels of rg_enumerator_classes.c on
+    synthetic genomes.
+
+    Usage: rg_microbench [--iterations <n>] [--genomes <n>] [--seed <seed>]
+               <n_chrs> <diploid> <n_segs> <n_dup_chrs> <max_times_divided> [...]
+
+    Every group of five numbers is one configuration. For each configuration,
+    --genomes random genomes are generated (see generate_genome()) and each
+    kernel is run --iterations times, cycling through the genomes. One
+    tab-separated line is printed per kernel and configuration, with the time
+    and the number of heap allocations per call. Allocations are counted by
+    wrapping malloc(), calloc() and realloc(), so glib allocations are counted
+    as well. This relies on glibc's __libc_malloc() and friends.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <glib.h>
+#include "../src/rg_enumerator_classes.c"
+#include "../src/rg_enumerator_sink.c"
+#include "genome_generator.c"
+
+int MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
+long N_OUTPUT_BYTES = 0;
+struct genome_sink *SINK;
+GHashTable *chromosome_store;
+GMutex chromosome_store_lock;
+int chromosome_store_next_id = 0;
+
+/*
+    Functions for counting allocations
+*/
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+long N_ALLOCS = 0;
+
+void *malloc(size_t size) {
+    N_ALLOCS++;
+    return(__libc_malloc(size));
+}
+void *calloc(size_t n, size_t size) {
+    N_ALLOCS++;
+    return(__libc_calloc(n, size));
+}
+void *realloc(void *ptr, size_t size) {
+    N_ALLOCS++;
+    return(__libc_realloc(ptr, size));
+}
+/*
+    End functions for counting allocations
+*/
+
+
+/*
+    Functions for running the benchmarks
+*/
+struct kernel_result {
+    double ns_per_op;
+    double allocs_per_op;
+};
+
+double get_time_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((double)ts.tv_sec * 1e9 + ts.tv_nsec);
+}
+
+void print_result(char *kernel, struct genome_config *config, double mean_segs, int n_iterations, struct kernel_result *result) {
+    printf(
+        "%s\t%d\t%d\t%d\t%d\t%d\t%.1f\t%d\t%.1f\t%.1f\n",
+        kernel, config->n_chrs, config->diploid, config->n_segs, config->n_dup_chrs, config->max_times_divided,
+        mean_segs, n_iterations, result->ns_per_op, result->allocs_per_op
+    );
+}
+
+/*
+    Runs all the kernels on the genomes of one configuration. Kernels that
+    change their input run on copies made before the timing starts, and the
+    outputs are freed after it ends, so that only the kernel is measured.
+*/
+void run_benchmarks(struct genome_config *config, int n_genomes, int n_iterations, guint32 seed) {
+    struct genome **genomes, **copies;
+    GString **genome_strings;
+    struct kernel_result result;
+    double start, mean_segs = 0;
+    long start_allocs;
+    int i, c_idx, s_idx, n_segs;
+
+    GRand *rand = g_rand_new_with_seed(seed);
+    genomes = malloc(n_genomes * sizeof(struct genome*));
+    genome_strings = malloc(n_genomes * sizeof(GString*));
+    copies = malloc(n_iterations * sizeof(struct genome*));
+    if (genomes == NULL || genome_strings == NULL || copies == NULL) {
+        fprintf(stderr, "\nFailed to malloc genomes in run_benchmarks(). Exiting.\n");
+        exit(1);
+    }
+    for (i=0; i<n_genomes; i++) {
+        *(genomes+i) = generate_genome(config, rand);
+        n_segs = 0;
+        for (c_idx=0; c_idx<(*(genomes+i))->n_chrs; c_idx++) {
+            n_segs += (*((*(genomes+i))->root_chr+c_idx))->n_segs;
+        }
+        mean_segs += (double)n_segs / n_genomes;
+        *(genome_strings+i) = g_string_new(NULL);
+    }
+    g_rand_free(rand);
+
+    void start_timing() {
+        start_allocs = N_ALLOCS;
+        start = get_time_ns();
+    }
+    void stop_timing() {
+        result.ns_per_op = (get_time_ns() - start) / n_iterations;
+        result.allocs_per_op = (double)(N_ALLOCS - start_allocs) / n_iterations;
+    }
+    void delete_copies() {
+        for (i=0; i<n_iterations; i++) {
+            delete_genome(*(copies+i));
+        }
+    }
+
+    // copy_genome()
+    start_timing();
+    for (i=0; i<n_iterations; i++) {
+        *(copies+i) = copy_genome(*(genomes + i % n_genomes));
+    }
+    stop_timing();
+    delete_copies();
+    print_result("copy_genome", config, mean_segs, n_iterations, &result);
+
+    // splice_all_segs(), splitting a different segment each time
+    for (i=0; i<n_iterations; i++) {
+        *(copies+i) = copy_genome(*(genomes + i % n_genomes));
+    }
+    start_timing();
+    for (i=0; i<n_iterations; i++) {
+        struct seg *s_ptr = *((*(copies+i))->genome_segs + (i / n_genomes) % (*(copies+i))->n_genome_segs);
+        splice_all_segs(*(copies+i), s_ptr->seg_indexes, s_ptr->times_divided, 2);
+    }
+    stop_timing();
+    delete_copies();
+    print_result("splice_all_segs", config, mean_segs, n_iterations, &result);
+
+    // simplify_genome()
+    for (i=0; i<n_iterations; i++) {
+        *(copies+i) = copy_genome(*(genomes + i % n_genomes));
+    }
+    start_timing();
+    for (i=0; i<n_iterations; i++) {
+        simplify_genome(*(copies+i));
+    }
+    stop_timing();
+    delete_copies();
+    print_result("simplify_genome", config, mean_segs, n_iterations, &result);
+
+    // simplify_genome() of a child of a simplified genome, with its first
+    // chromosome inverted, which is all that the breakpoint uses are recounted for
+    struct genome *parent_ptr;
+    for (i=0; i<n_iterations; i++) {
+        parent_ptr = copy_genome(*(genomes + i % n_genomes));
+        simplify_genome(parent_ptr);
+        *(copies+i) = copy_genome(parent_ptr);
+        delete_genome(parent_ptr);
+        invert_segs_in_chr(*((*(copies+i))->root_chr+0), 0, (*((*(copies+i))->root_chr+0))->n_segs-1);
+    }
+    start_timing();
+    for (i=0; i<n_iterations; i++) {
+        simplify_genome(*(copies+i));
+    }
+    stop_timing();
+    delete_copies();
+    print_result("simplify_genome_child", config, mean_segs, n_iterations, &result);
+
+    // get_unique_genome_string() of a freshly rearranged genome. The chromosomes
+    // are interned after the first iterations, as they are in the enumerator.
+    for (i=0; i<n_iterations; i++) {
+        *(copies+i) = copy_genome_cold(*(genomes + i % n_genomes));
+    }
+    start_timing();
+    for (i=0; i<n_iterations; i++) {
+        get_unique_genome_string(*(copies+i), *(genome_strings + i % n_genomes));
+    }
+    stop_timing();
+    delete_copies();
+    print_result("get_unique_genome_string", config, mean_segs, n_iterations, &result);
+
+    // get_unique_genome_string() of a genome with a canonical labeling, i.e.
+    // bounded by the genome string in the order of the previous call
+    for (i=0; i<n_genomes; i++) {
+        get_unique_genome_string(*(genomes+i), *(genome_strings+i));
+    }
+    for (i=0; i<n_iterations; i++) {
+        *(copies+i) = copy_genome(*(genomes + i % n_genomes));
+    }
+    start_timing();
+    for (i=0; i<n_iterations; i++) {
+        get_unique_genome_string(*(copies+i), *(genome_strings + i % n_genomes));
+    }
+    stop_timing();
+    delete_copies();
+    print_result("get_unique_genome_string_labelled", config, mean_segs, n_iterations, &result);
+
+    // print_genome(), with stdout sent to /dev/null while timing
+    int stdout_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (stdout_fd < 0 || null_fd < 0) {
+        fprintf(stderr, "\nFailed to redirect stdout in run_benchmarks(). Exiting.\n");
+        exit(1);
+    }
+    fflush(stdout);
+    dup2(null_fd, STDOUT_FILENO);
+    start_timing();
+    for (i=0; i<n_iterations; i++) {
+        print_genome(*(genomes + i % n_genomes), (*(genome_strings + i % n_genomes))->str);
+    }
+    fflush(stdout);
+    stop_timing();
+    dup2(stdout_fd, STDOUT_FILENO);
+    close(stdout_fd);
+    close(null_fd);
+    print_result("print_genome", config, mean_segs, n_iterations, &result);
+
+    for (i=0; i<n_genomes; i++) {
+        delete_genome(*(genomes+i));
+        g_string_free(*(genome_strings+i), 1);
+    }
+    free(genomes);
+    free(genome_strings);
+    free(copies);
+
+    return;
+}
+/*
+    End functions for running the benchmarks
+*/
+
+
+int main(int argc, char *argv[]) {
+    int n_iterations = 1000, n_genomes = 16;
+    guint32 seed = 0;
+    int i, n_configs = 0;
+    struct genome_config *configs = malloc((argc / 5 + 1) * sizeof(struct genome_config));
+    if (configs == NULL) {
+        fprintf(stderr, "\nFailed to malloc configs. Exiting.\n");
+        exit(1);
+    }
+
+    for (i=1; i<argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%d", &n_iterations) != 1 || n_iterations < 1) {
+                fprintf(stderr, "Number of iterations must be a positive integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--genomes") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%d", &n_genomes) != 1 || n_genomes < 1) {
+                fprintf(stderr, "Number of genomes must be a positive integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%u", &seed) != 1) {
+                fprintf(stderr, "Seed must be a non-negative integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (i+4 < argc) {
+            if (!parse_genome_config(argv+i, configs + n_configs++)) {
+                fprintf(stderr, "Invalid configuration starting at %s. Exiting.\n", argv[i]);
+                exit(1);
+            }
+            i += 4;
+        }
+        else {
+            fprintf(stderr, "Unknown or incomplete option %s. Exiting.\n", argv[i]);
+            exit(1);
+        }
+    }
+    if (n_configs == 0) {
+        fprintf(stderr, "Usage: %s [--iterations <n>] [--genomes <n>] [--seed <seed>] <n_chrs> <diploid> <n_segs> <n_dup_chrs> <max_times_divided> [...]\n", argv[0]);
+        exit(1);
+    }
+
+    chromosome_store = g_hash_table_new(g_str_hash, g_str_equal);
+    SINK = create_text_sink(stdout);
+    printf("kernel\tn_chrs\tdiploid\tn_segs\tn_dup_chrs\tmax_times_divided\tmean_chr_segs\titerations\tns_per_op\tallocs_per_op\n");
+    for (i=0; i<n_configs; i++) {
+        run_benchmarks(configs+i, n_genomes, n_iterations, seed);
+    }
+    free(configs);
+    delete_sink(SINK);
+
+    return(0);
+}
@@ -0,0 +1,258 @@
+/*
+    Randomised test of get_unique_genome_string(): the genome string of a
+    genome must not change when the genome is relabeled, i.e. when its
+    chromosomes are reordered or read in the other orientation, or when its WT
+    chromosomes are renumbered, read in the other orientation or have their
+    parental alleles swapped.
+
+    Usage: rg_verify_canonical [--relabelings <n>] [--genomes <n>] [--seed <seed>]
+               <n_chrs> <diploid> <n_segs> <n_dup_chrs> <max_times_divided> [...]
+
+    The configurations are those of genome_generator.c. Every relabeled copy
+    is canonicalised both from scratch and with the canonical labeling of the
+    original genome, which only bounds the search. Exits with status 1 if any
+    genome string differs.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include "../src/rg_enumerator_classes.c"
+#include "genome_generator.c"
+
+int MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
+long N_OUTPUT_BYTES = 0;
+struct genome_sink *SINK = NULL;  /* Nothing is printed */
+GHashTable *chromosome_store;
+GMutex chromosome_store_lock;
+int chromosome_store_next_id = 0;
+
+/*
+    Functions for relabeling genomes
+*/
+void reverse_chromosome(struct chromosome *c_ptr) {
+    struct seg *tmp_s_ptr;
+    int s_idx;
+    for (s_idx=0; s_idx<c_ptr->n_segs/2; s_idx++) {
+        tmp_s_ptr = *(c_ptr->root_seg+s_idx);
+        *(c_ptr->root_seg+s_idx) = *(c_ptr->root_seg+c_ptr->n_segs-1-s_idx);
+        *(c_ptr->root_seg+c_ptr->n_segs-1-s_idx) = tmp_s_ptr;
+    }
+    for (s_idx=0; s_idx<c_ptr->n_segs; s_idx++) {
+        (*(c_ptr->root_seg+s_idx))->is_plus ^= 1;
+    }
+    c_ptr->info = NULL;
+}
+
+int genome_seg_cmp(const void *a, const void *b) {
+    struct seg *s1_ptr = *(struct seg**)a;
+    struct seg *s2_ptr = *(struct seg**)b;
+    return(seg_indexes_cmp(s1_ptr->times_divided, s1_ptr->seg_indexes, s2_ptr->times_divided, s2_ptr->seg_indexes));
+}
+
+/*
+    Relabels *g_ptr at random, see the top of the file. A WT chromosome is
+    read in the other orientation by giving each segment on the chromosomes
+    the indexes of the segment at the mirrored position of the WT chromosome
+    in g_ptr->genome_segs. Drops the interned data and keeps the canonical
+    labeling of *g_ptr, if any.
+*/
+void relabel_genome(struct genome *g_ptr, GRand *rand) {
+    int n_wt_chrs = *((*(g_ptr->genome_segs+g_ptr->n_genome_segs-1))->seg_indexes+0) + 1;
+    int *wt_chr_first_seg, *wt_chr_last_seg, *wt_chr_is_flipped, *wt_chr_is_swapped, *wt_chr_new_idx;
+    struct chromosome *c_ptr;
+    struct seg *s_ptr, *mirror_s_ptr;
+    int c_idx, s_idx, wt_chr, i, j, tmp;
+
+    wt_chr_first_seg = malloc(n_wt_chrs * sizeof(int));
+    wt_chr_last_seg = malloc(n_wt_chrs * sizeof(int));
+    wt_chr_is_flipped = malloc(n_wt_chrs * sizeof(int));
+    wt_chr_is_swapped = malloc(n_wt_chrs * sizeof(int));
+    wt_chr_new_idx = malloc(n_wt_chrs * sizeof(int));
+    if (wt_chr_first_seg == NULL || wt_chr_last_seg == NULL || wt_chr_is_flipped == NULL || wt_chr_is_swapped == NULL || wt_chr_new_idx == NULL) {
+        fprintf(stderr, "\nFailed to malloc WT chromosome arrays in relabel_genome(). Exiting.\n");
+        exit(1);
+    }
+    for (wt_chr=0; wt_chr<n_wt_chrs; wt_chr++) {
+        *(wt_chr_first_seg+wt_chr) = -1;
+        *(wt_chr_is_flipped+wt_chr) = g_rand_int_range(rand, 0, 2);
+        *(wt_chr_is_swapped+wt_chr) = g_rand_int_range(rand, 0, 2);
+        *(wt_chr_new_idx+wt_chr) = wt_chr;
+    }
+    for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
+        wt_chr = *((*(g_ptr->genome_segs+s_idx))->seg_indexes+0);
+        if (*(wt_chr_first_seg+wt_chr) == -1) {
+            *(wt_chr_first_seg+wt_chr) = s_idx;
+        }
+        *(wt_chr_last_seg+wt_chr) = s_idx;
+    }
+    for (i=n_wt_chrs-1; i>0; i--) {
+        j = g_rand_int_range(rand, 0, i+1);
+        tmp = *(wt_chr_new_idx+i);
+        *(wt_chr_new_idx+i) = *(wt_chr_new_idx+j);
+        *(wt_chr_new_idx+j) = tmp;
+    }
+
+    // WT chromosome orientation and parental alleles
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+        for (s_idx=0; s_idx<c_ptr->n_segs; s_idx++) {
+            s_ptr = *(c_ptr->root_seg+s_idx);
+            wt_chr = *(s_ptr->seg_indexes+0);
+            if (*(wt_chr_is_flipped+wt_chr)) {
+                i = find_genome_seg_idx(g_ptr, s_ptr);
+                mirror_s_ptr = *(g_ptr->genome_segs + *(wt_chr_first_seg+wt_chr) + *(wt_chr_last_seg+wt_chr) - i);
+                s_ptr->times_divided = mirror_s_ptr->times_divided;
+                s_ptr->seg_indexes = realloc(s_ptr->seg_indexes, s_ptr->times_divided * sizeof(int));
+                if (s_ptr->seg_indexes == NULL) {
+                    fprintf(stderr, "\nFailed to realloc seg_indexes in relabel_genome(). Exiting.\n");
+                    exit(1);
+                }
+                memcpy(s_ptr->seg_indexes, mirror_s_ptr->seg_indexes, s_ptr->times_divided * sizeof(int));
+                s_ptr->is_plus ^= 1;
+            }
+            s_ptr->is_maternal ^= *(wt_chr_is_swapped+wt_chr);
+        }
+    }
+
+    // WT chromosome numbering, which changes the order of g_ptr->genome_segs
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+        for (s_idx=0; s_idx<c_ptr->n_segs; s_idx++) {
+            s_ptr = *(c_ptr->root_seg+s_idx);
+            *(s_ptr->seg_indexes+0) = *(wt_chr_new_idx + *(s_ptr->seg_indexes+0));
+        }
+    }
+    for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
+        s_ptr = *(g_ptr->genome_segs+s_idx);
+        *(s_ptr->seg_indexes+0) = *(wt_chr_new_idx + *(s_ptr->seg_indexes+0));
+    }
+    qsort(g_ptr->genome_segs, g_ptr->n_genome_segs, sizeof(struct seg*), genome_seg_cmp);
+
+    // Chromosome orientation and order
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+        c_ptr->info = NULL;
+        if (g_rand_int_range(rand, 0, 2)) {
+            reverse_chromosome(c_ptr);
+        }
+    }
+    for (i=g_ptr->n_chrs-1; i>0; i--) {
+        j = g_rand_int_range(rand, 0, i+1);
+        c_ptr = *(g_ptr->root_chr+i);
+        *(g_ptr->root_chr+i) = *(g_ptr->root_chr+j);
+        *(g_ptr->root_chr+j) = c_ptr;
+    }
+
+    free(wt_chr_first_seg);
+    free(wt_chr_last_seg);
+    free(wt_chr_is_flipped);
+    free(wt_chr_is_swapped);
+    free(wt_chr_new_idx);
+    return;
+}
+/*
+    End functions for relabeling genomes
+*/
+
+
+/* Returns the number of relabeled copies of the genomes of *config with a different genome string */
+int verify_config(struct genome_config *config, int n_genomes, int n_relabelings, GRand *rand) {
+    struct genome *g_ptr, *relabeled_g_ptr, *cold_g_ptr;
+    GString *genome_string = g_string_new(NULL);
+    GString *relabeled_string = g_string_new(NULL);
+    int i, k, cold, n_failed = 0;
+
+    for (i=0; i<n_genomes; i++) {
+        g_ptr = generate_genome(config, rand);
+        get_unique_genome_string(g_ptr, genome_string);
+
+        for (k=0; k<n_relabelings; k++) {
+            relabeled_g_ptr = copy_genome(g_ptr);
+            relabel_genome(relabeled_g_ptr, rand);
+            for (cold=0; cold<2; cold++) {
+                cold_g_ptr = (cold ? copy_genome_cold(relabeled_g_ptr) : copy_genome(relabeled_g_ptr));
+                get_unique_genome_string(cold_g_ptr, relabeled_string);
+                if (strcmp(genome_string->str, relabeled_string->str) != 0) {
+                    n_failed++;
+                    if (n_failed <= 5) {
+                        fprintf(stderr, "Genome string %s of a relabeled copy (%s) of %s\n", relabeled_string->str, (cold ? "from scratch" : "labelled"), genome_string->str);
+                    }
+                }
+                delete_genome(cold_g_ptr);
+            }
+            delete_genome(relabeled_g_ptr);
+        }
+        delete_genome(g_ptr);
+    }
+
+    g_string_free(genome_string, 1);
+    g_string_free(relabeled_string, 1);
+    return(n_failed);
+}
+
+int main(int argc, char *argv[]) {
+    int n_relabelings = 20, n_genomes = 100;
+    guint32 seed = 0;
+    int i, n_configs = 0, n_failed, n_failed_total = 0;
+    struct genome_config *configs = malloc((argc / 5 + 1) * sizeof(struct genome_config));
+    if (configs == NULL) {
+        fprintf(stderr, "\nFailed to malloc configs. Exiting.\n");
+        exit(1);
+    }
+
+    for (i=1; i<argc; i++) {
+        if (strcmp(argv[i], "--relabelings") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%d", &n_relabelings) != 1 || n_relabelings < 1) {
+                fprintf(stderr, "Number of relabelings must be a positive integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--genomes") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%d", &n_genomes) != 1 || n_genomes < 1) {
+                fprintf(stderr, "Number of genomes must be a positive integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%u", &seed) != 1) {
+                fprintf(stderr, "Seed must be a non-negative integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (i+4 < argc) {
+            if (!parse_genome_config(argv+i, configs + n_configs++)) {
+                fprintf(stderr, "Invalid configuration starting at %s. Exiting.\n", argv[i]);
+                exit(1);
+            }
+            i += 4;
+        }
+        else {
+            fprintf(stderr, "Unknown or incomplete option %s. Exiting.\n", argv[i]);
+            exit(1);
+        }
+    }
+    if (n_configs == 0) {
+        fprintf(stderr, "Usage: %s [--relabelings <n>] [--genomes <n>] [--seed <seed>] <n_chrs> <diploid> <n_segs> <n_dup_chrs> <max_times_divided> [...]\n", argv[0]);
+        exit(1);
+    }
+
+    chromosome_store = g_hash_table_new(g_str_hash, g_str_equal);
+    GRand *rand = g_rand_new_with_seed(seed);
+    for (i=0; i<n_configs; i++) {
+        n_failed = verify_config(configs+i, n_genomes, n_relabelings, rand);
+        printf(
+            "%d %d %d %d %d: %d of %d relabeled genomes with a different genome string\n",
+            (configs+i)->n_chrs, (configs+i)->diploid, (configs+i)->n_segs, (configs+i)->n_dup_chrs, (configs+i)->max_times_divided,
+            n_failed, 2 * n_genomes * n_relabelings
+        );
+        n_failed_total += n_failed;
+    }
+    g_rand_free(rand);
+    free(configs);
+
+    return(n_failed_total > 0 ? 1 : 0);
+}
@@ -0,0 +1,168 @@
+/*
+    Library interface of the rearrangement enumerator.
+
+    `make lib` builds librg_enumerator.a from rg_enumerator_lib.c, which
+    includes all the modules, as the program does. Link it with glib and
+    -pthread. An engine holds the parameters of an enumeration, and every
+    derivative genome it visits is passed to its sink as a struct
+    visited_genome, in the order the program prints them. The built-in sinks
+    write the usual text output, a binary format, counts only, or nothing.
+    Other sinks are made by filling in a struct genome_sink.
+
+        struct rg_engine *e_ptr = create_engine(1, 1, 2, 3);
+        struct genome_sink *sink = create_count_sink(e_ptr->max_overall_depth);
+        e_ptr->sink = sink;
+        run_engine(e_ptr);
+        ... ((struct genome_counts*)sink->data)->n_visited ...
+        delete_sink(sink);
+        delete_engine(e_ptr);
+
+    For search algorithms of their own, get_successors() does one step of the
+    enumeration for a batch of genomes, between start_engine() and
+    stop_engine():
+
+        start_engine(e_ptr);
+        struct successor_set *ss_ptr = create_successor_set();
+        struct genome *wt = create_genome(e_ptr->n_chrs, e_ptr->is_diploid);
+        struct successor *children = get_successors(ss_ptr, &wt, 1, &n);
+        ...
+        delete_successor_set(ss_ptr);
+        delete_genome(wt);
+        stop_engine(e_ptr);
+
+    The engine still works on the process-wide state of the modules (the
+    table of seen genomes, the chromosome store and the depth limits), which
+    it sets up and tears down in run_engine(), so only one engine can run at
+    a time in a process.
+*/
+#ifndef RG_ENUMERATOR_H
+#define RG_ENUMERATOR_H
+
+#include <stdio.h>
+
+enum rg_type {
+    DEL,
+    TD,
+    INV_DUP,
+    INV,
+    TEL_BREAK,
+    FOLD_BACK,
+    BAL_TRANSLOC,
+    UNBAL_TRANSLOC,
+    WC_DUP,
+    WC_DEL,
+    WG_DUP
+};
+#define N_RG_TYPES (WG_DUP + 1)
+
+/*
+    A derivative genome as visited by the engine. The strings and arrays
+    belong to the engine and are only valid during the call to the sink.
+*/
+struct visited_genome {
+    int depth;               /* Number of events */
+    int dup_depth;           /* Number of duplicative events */
+    enum rg_type *history;   /* The events, depth of them */
+    int *history_idx;        /* Which of the possible applications of each event */
+    char *cn_string;         /* Allelic copy number portion of the rearrangement pattern */
+    char *rg_string;         /* Rearrangement portion of the rearrangement pattern */
+    char *genome_string;     /* Canonical genome string, or the detailed history of the earlier visit if is_seen */
+    int is_seen;             /* Whether the genome was expanded before with at most as many events and duplicative events, so it is not expanded */
+};
+
+struct genome_sink {
+    void (*visit)(struct genome_sink *sink, struct visited_genome *v_ptr);
+    void (*flush)(struct genome_sink *sink);     /* Called at the end of every run, NULL if not needed */
+    void (*delete_data)(void *data);             /* Called by delete_sink(), NULL if not needed */
+    void *data;
+};
+
+/* Data of the sink of create_count_sink() */
+struct genome_counts {
+    long n_visited;
+    long n_seen;         /* Visits of genomes visited before */
+    long *n_by_depth;    /* Visits by number of events, max_depth + 1 of them */
+    int max_depth;
+};
+
+struct genome;  /* A derivative genome, only handled through the functions below */
+struct successor_set;
+
+/* A child of get_successors() */
+struct successor {
+    int parent_idx;        /* Index of the parent in the genomes passed */
+    enum rg_type rg;       /* Event producing the child from the parent */
+    int hist_idx;          /* Which of the possible applications of the event */
+    int depth;
+    int dup_depth;
+    char *genome_string;   /* Canonical genome string, in the buffer of the successor set */
+    int key_offset;        /* Offset of genome_string in that buffer */
+    struct genome *g_ptr;  /* The child, deleted by the successor set unless set to NULL */
+};
+
+struct rg_engine {
+    int n_chrs;
+    int is_diploid;
+    int max_dup_depth;
+    int max_overall_depth;
+    int n_threads;               /* Threads canonicalising the children of a genome, 1 by default */
+    long max_seen_memory;        /* MB for the table of seen genomes, 0 for no limit */
+    double progress_interval;    /* Seconds between progress reports on stderr, 0 for none */
+    char *metrics_path;          /* Prometheus metrics file, NULL for none */
+    int max_events[N_RG_TYPES];  /* Most events of each type in a history, -1 for no limit, 0 to disable the type */
+    int reduce_commuting;        /* Whether run_engine() enumerates commuting events on different chromosomes in one order only */
+    struct genome_sink *sink;    /* NULL for the text output on stdout */
+    struct genome_sink *stdout_sink;  /* Text sink used while sink is NULL */
+};
+
+/*
+    Sinks. The text and binary sinks write to out, which they do not close.
+    Binary records are, in native byte order: int32 depth, dup_depth and
+    is_seen, the depth int32 events (enum rg_type) and their depth int32
+    indexes, then cn_string, rg_string and genome_string, each as an int32
+    length followed by the characters without a terminating NUL.
+*/
+struct genome_sink* create_text_sink(FILE *out);
+struct genome_sink* create_binary_sink(FILE *out);
+struct genome_sink* create_count_sink(int max_depth);
+struct genome_sink* create_null_sink();
+void delete_sink(struct genome_sink *sink);
+
+/*
+    Engines. run_engine() enumerates all the derivative genomes of the WT
+    genome and returns the number of genomes visited. The sink is not
+    deleted by delete_engine(). By default all the rearrangement types but
+    inverted duplications are enumerated, with no limit on their number.
+*/
+struct rg_engine* create_engine(int n_chrs, int is_diploid, int max_dup_depth, int max_overall_depth);
+void delete_engine(struct rg_engine *e_ptr);
+long run_engine(struct rg_engine *e_ptr);
+void start_engine(struct rg_engine *e_ptr);
+void stop_engine(struct rg_engine *e_ptr);
+void set_enabled_rg_types(struct rg_engine *e_ptr, char *types_string);
+void set_max_events(struct rg_engine *e_ptr, char *max_events_string);
+
+/*
+    Multi-process enumeration. run_workers() forks n_workers processes, which
+    take parts of the enumeration from each other as they run out of work,
+    share a table of the genomes they expand in shared_memory MB, or
+    partition it between them if shared_memory is 0, and write the text (or
+    binary) output to <output_prefix>.<worker>. It returns the number of
+    genomes visited by all of them. The sink of the engine is not used.
+*/
+long run_workers(struct rg_engine *e_ptr, int n_workers, long shared_memory, char *output_prefix, int is_binary);
+
+/*
+    Genomes and their successors. get_successors() returns the distinct
+    children of genomes[0..n_genomes-1], with their number in *n_successors.
+    The successors belong to the successor set until its next use. Different
+    successor sets can be used on different threads at the same time, on
+    different genomes. Genomes must be deleted before stop_engine().
+*/
+struct genome* create_genome(int n_chrs, int paired);
+void delete_genome(struct genome *g_ptr);
+struct successor_set* create_successor_set();
+void delete_successor_set(struct successor_set *ss_ptr);
+struct successor* get_successors(struct successor_set *ss_ptr, struct genome **genomes, int n_genomes, int *n_successors);
+
+#endif
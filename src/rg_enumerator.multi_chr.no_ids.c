@@ -8,8 +8,195 @@
     Decision whether to bridge or terminate is dependent on a predefined depth.
 */
 
-extern int MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
+extern int N_CHRS, IS_DIPLOID, MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
+extern int MAX_EVENTS_OF_TYPE[N_RG_TYPES];
+extern int REDUCE_COMMUTING;
+extern GHashTable *reduced_genomes;
 extern GHashTable *seen_somatic_genomes;
+extern struct seen_budget *seen_budget;
+extern struct work_stack *WORK_STACK;
+extern struct worker_link *WORKER_LINK;
+extern struct worker_link **PEER_LINKS;
+extern int N_WORKERS, WORKER_IDX;
+extern struct target_pattern *TARGET;
+extern __thread struct event_collector *collector;
+extern GThreadPool *batch_pool;
+extern struct progress *progress;
+
+/*
+    An event is described by the rearrangement type, the chromosomes it acts on
+    and its index in the history. The enumerators go through the events of a
+    type chromosome by chromosome (pair by pair for translocations), and the
+    events on one chromosome form a block whose events and their order depend
+    only on the content of the chromosome. A block on chromosomes identical to
+    those of an earlier block of the same genome therefore results in the same
+    genomes, and its events are recorded as twins of the earlier ones without
+    building their genomes. materialize_event() builds the genome of any event
+    of a genome when it is needed after all.
+*/
+struct rg_event {
+    enum rg_type rg;
+    int hist_idx;
+    int c1_idx;          /* Chromosome the event acts on, -1 for whole-genome events */
+    int c2_idx;          /* Second chromosome of translocations, -1 otherwise */
+    int block_hist_idx;  /* hist_idx of the first event of the block */
+    int twin_idx;        /* Index of the earlier event with the same resulting genome, -1 if none */
+    struct genome *g_ptr;  /* Resulting genome, NULL if not built */
+};
+struct event_block {
+    int first_event;  /* Index of the first event of the block in collector->events */
+    int c1_idx;
+    int c2_idx;
+};
+struct event_collector {
+    GArray *events;      /* struct rg_event of the events enumerated so far, NULL when materialising wanted */
+    GHashTable *blocks;  /* First block on each combination of rearrangement type and chromosome contents */
+    int skip_twins;      /* Whether to skip building the genomes of twin events */
+    struct block_counts *known_blocks;  /* Blocks whose events are only counted, NULL if none */
+    int count_only;      /* Whether to only count the events in n_counted, events is NULL then */
+    int n_counted;
+    enum rg_type block_rg;  /* Block currently being enumerated */
+    int block_c1_idx;
+    int block_c2_idx;
+    int block_hist_idx;
+    struct rg_event *wanted;     /* Only event whose genome is built in materialize_event() */
+    struct genome *wanted_g_ptr;
+    struct breakpoint_catalog *catalog;  /* Breakpoints of the genome enumerated, NULL until used */
+};
+
+/*
+    A collector enumerates the events of a single genome, and its breakpoints
+    are catalogued once for all the enumerators, see get_chr_breakpoints().
+    There is one breakpoint per segment of each chromosome. All copies of a
+    segment are in the same class, and the enumerators compare classes
+    instead of segment indexes. The number of copies tells them whether other
+    copies are left to split, see splice_breakpoint_copies(). The segment
+    indexes belong to the genome, which the enumerators do not change.
+*/
+struct breakpoint {
+    int *seg_indexes;
+    int times_divided;
+    int seg_class;  /* Index of the segment in genome_segs */
+    int n_copies;   /* Copies of the segment in the genome */
+};
+struct breakpoint_catalog {
+    struct breakpoint *breakpoints;
+    struct breakpoint **chr_breakpoints;  /* First breakpoint of each chromosome, and the end */
+    int n_chrs;
+    guint64 *commuting_chrs;  /* Of each chromosome with REDUCE_COMMUTING, NULL otherwise, see add_commuting_chrs() */
+    int explored_types;       /* Bit mask of the types enumerated for the genome, with REDUCE_COMMUTING */
+};
+
+/*
+    Number of events of each block, keyed like event_collector->blocks. Since
+    the events of a block only depend on the contents of its chromosomes, the
+    counts hold for any genome and are counted on a genome of just those
+    chromosomes, see count_events_of_type(). Shared by all threads, and only
+    valid until the chromosome store is cleared.
+*/
+struct block_counts {
+    GHashTable *counts;
+    GMutex lock;
+};
+
+struct batch_child {
+    struct rg_event *e_ptr;  /* The event producing this child */
+    struct genome *g_ptr;    /* NULL for twins, until materialised */
+    GString *unique_genome_string;
+    GString *cn_string;
+    GString *rg_string;
+    int is_target;
+    int can_reach_target;
+    int claim_state;      /* With a partitioned table of seen genomes, see claim_batch_children() */
+    char *claim_hist;     /* History of the expansion of the genome elsewhere, if CLAIM_SEEN */
+    struct batch *b_ptr;  /* Batch this child belongs to */
+};
+enum claim_state {
+    CLAIM_NONE,     /* Checked against seen_somatic_genomes when handled */
+    CLAIM_PENDING,  /* Waiting for the answer of the owner of the genome */
+    CLAIM_GRANTED,  /* To be expanded here, remembered by the owner */
+    CLAIM_SEEN      /* Expanded elsewhere with at most as many events and duplicative events */
+};
+struct batch {
+    struct genome *g_ptr;  /* Parent of the children */
+    GArray *events;
+    struct batch_child *children;  /* In the order the children were enumerated */
+    int n_children;
+    int n_pending;  /* Number of children still being rendered on batch_pool */
+    GMutex lock;
+    GCond all_rendered;
+    guint64 unexplored_chrs[N_RG_TYPES];  /* Blocks with a child not explored in full, see update_sleep_set() */
+    int next_child;  /* Children next_child to end_child - 1 are still to be handled */
+    int end_child;
+};
+
+/*
+    In a worker process of run_workers(), the enumeration is made of work
+    units handed out by the coordinator: the events leading from the WT genome
+    to a genome, which are replayed with materialize_event(), and the range of
+    the children of that genome to handle. The batches being handled are kept
+    by depth, so that the children left in the shallowest one, which have the
+    largest subtrees, can be given away as a new unit when the coordinator
+    asks for work for an idle worker.
+*/
+struct work_stack {
+    struct rg_event *base_path;  /* Events leading to the genome of the current unit */
+    int base_depth;
+    char *base_claims;           /* 'G' for each child of the unit granted to the worker giving it away, or NULL */
+    struct batch **batches;      /* Batch of the genome at each depth from base_depth, NULL below the path */
+    struct pollfd *peer_pfds;    /* For serve_peers(), N_WORKERS + 1 of them */
+};
+#define WORK_REQUEST_INTERVAL 16  /* Children handled between checks for requests of the coordinator */
+
+/*
+    A genome can be reached with histories none of which is better than the
+    others in both the number of events and of duplicative events, e.g. (3,2)
+    and (4,1), and each of them leaves budget for descendants the others
+    cannot reach. seen_somatic_genomes therefore keeps, for every genome, the
+    Pareto front of the (depth, dup_depth) with which it was expanded. A visit
+    dominated by a point of the front is not expanded again; any other visit
+    is, and its point replaces those it dominates. Its descendants are checked
+    against their own fronts, so only the part of the subtree beyond the
+    budget of the earlier expansions is explored anew. A point only dominates
+    a visit whose restrictions include its own, e.g. an expansion right after
+    a fold-back does not stand in for one that can be followed by any event.
+*/
+struct seen_point {
+    int depth;
+    int dup_depth;
+    guint64 restrictions;  /* See get_child_restrictions() */
+    char *genome_hist;     /* Detailed history of the expansion */
+};
+struct seen_genome {
+    int n_points;
+    struct seen_point *points;  /* By increasing depth */
+};
+#define RESTRICTED_AFTER_FOLD_BACK 1  /* Only telomeric breaks and fold-backs can follow */
+#define RESTRICTED_AFTER_WG_DUP    2  /* No other whole-genome duplication can follow */
+
+/*
+    With --max-seen-memory, seen_somatic_genomes is kept within a memory
+    budget. When the estimated size of its entries exceeds the budget, the
+    genomes reached with the most events are evicted first, since the
+    subtrees they spare from re-exploration are the smallest. Evicted genomes
+    are treated as new when they are reached again, so their subtrees are
+    explored and printed again, but the enumeration still completes. The
+    chromosome store is not part of the budget, since its entries are freed
+    with the last genome holding them, and the table only keeps strings. A
+    blocked Bloom filter of the keys answers most lookups of new genomes
+    without touching the table. It is rebuilt after every eviction, since
+    evicted keys cannot be removed from it.
+*/
+struct seen_budget {
+    long max_bytes;  /* Budget for the entries and the filter */
+    long n_bytes;    /* Estimated size of the entries */
+    guint64 *filter;       /* SEEN_FILTER_BLOCK_WORDS words per block */
+    long n_filter_blocks;
+    long n_evicted;
+};
+#define SEEN_ENTRY_OVERHEAD 64     /* Bytes of a table entry besides its strings and points */
+#define SEEN_FILTER_BLOCK_WORDS 8  /* One cache line */
+#define SEEN_FILTER_N_HASHES 6
 
 void bridge(struct genome *g_ptr);
 void enum_dels(struct genome *g_ptr);
@@ -23,179 +210,1741 @@ void enum_wc_dup(struct genome *g_ptr);
 void enum_wc_del(struct genome *g_ptr);
 void enum_wg_dup(struct genome *g_ptr);
 void enum_fbs(struct genome *g_ptr);
+struct chromosome* get_bfb_chr(struct chromosome *c_ptr, struct breakpoint *c_bps, int b1, int is_left, int is_fold_back);
+void enum_events(struct genome *g_ptr, GArray *events, int skip_twins, int allow_dup);
+void enum_events_of_type(struct genome *g_ptr, enum rg_type rg, GArray *events, int skip_twins);
+int rg_type_is_enumerated(struct genome *g_ptr, enum rg_type rg, int allow_dup);
+int get_n_events_of_type(struct genome *g_ptr, enum rg_type rg);
+int get_n_restriction_bits();
+guint64 get_child_restrictions(struct genome *parent_ptr, enum rg_type rg);
+void run_enumerator(struct genome *g_ptr, enum rg_type rg);
+void enum_children(struct genome *g_ptr, GPtrArray *children, int allow_dup);
+struct event_collector* create_event_collector(GArray *events, int skip_twins);
+void delete_event_collector(struct event_collector *ec_ptr);
+struct breakpoint_catalog* create_breakpoint_catalog(struct genome *g_ptr);
+void delete_breakpoint_catalog(struct breakpoint_catalog *bc_ptr);
+struct breakpoint* get_chr_breakpoints(struct genome *g_ptr, int c_idx);
+void splice_breakpoint_copies(struct genome *g_ptr, struct breakpoint *bp_ptr, int split_into);
+void get_block_key(struct genome *g_ptr, enum rg_type rg, int c1_idx, int c2_idx, GString *key);
+int is_twin_block(struct genome *g_ptr, enum rg_type rg, int c1_idx, int c2_idx, int *hist_idx);
+struct block_counts* create_block_counts();
+void delete_block_counts(struct block_counts *bc_ptr);
+void count_events_of_type(struct genome *g_ptr, enum rg_type rg, GArray *events, struct block_counts *known_blocks);
+int count_block_events(struct genome *g_ptr, enum rg_type rg, int c1_idx, int c2_idx);
+int rg_type_commutes(enum rg_type rg);
+void add_commuting_chrs(struct breakpoint_catalog *bc_ptr, struct genome *g_ptr);
+void set_sleep_set(struct genome *g_ptr, enum rg_type rg);
+int is_sleeping_block(struct genome *g_ptr, enum rg_type rg, int c_idx);
+int count_sleeping_block_events(struct genome *g_ptr, enum rg_type rg, int c_idx);
+struct genome* materialize_event(struct genome *g_ptr, struct rg_event *e_ptr);
+int skip_events(int *hist_idx, int n_events);
+
+struct batch* create_batch(struct genome *g_ptr);
+void delete_batch(struct batch *b_ptr);
+void render_batch_child(struct batch_child *bc_ptr);
+void render_batch_child_in_pool(gpointer data, gpointer user_data);
+void render_batch(struct batch *b_ptr);
+void handle_batch_child(struct batch_child *bc_ptr);
+void update_sleep_set(struct batch_child *bc_ptr, int is_new, int is_expanded);
+void copy_twin_rendering(struct batch *b_ptr);
+
+struct seen_budget* create_seen_budget(long max_bytes);
+void delete_seen_budget(struct seen_budget *sb_ptr);
+guint64 hash_genome_string(char *genome_string);
+void add_to_seen_filter(guint64 hash);
+int is_in_seen_filter(guint64 hash);
+void rebuild_seen_filter();
+void delete_seen_genome(struct seen_genome *sg_ptr);
+long get_seen_genome_size(struct seen_genome *sg_ptr);
+char* lookup_seen_genome(char *genome_string, int depth, int dup_depth, guint64 restrictions);
+void remember_seen_genome(char *genome_string, char *genome_hist, int depth, int dup_depth, guint64 restrictions);
+void evict_seen_genomes();
+void forget_seen_genomes();
+
+void bridge_children(struct genome *g_ptr, int first_child, int last_child);
+void discard_batch_child(struct batch_child *bc_ptr);
+void run_work_units();
+struct genome* replay_work_path(struct rg_event *path, int depth);
+void check_work_request();
+void donate_work();
+char* wait_coordinator_message();
+
+int get_seen_owner(char *genome_string);
+char* claim_seen_genome(char *genome_string, char *genome_hist, int depth, int dup_depth, guint64 restrictions);
+void claim_batch_children(struct batch *b_ptr, char *granted);
+int serve_peers(struct worker_link *wake_ptr, int timeout);
+void handle_peer_messages(struct worker_link *wl_ptr);
+
+/*
+    Children of a genome are processed as a batch. The enumerators only collect
+    the children, then the canonical genome strings and rearrangement patterns
+    of the whole batch are computed in one pass, on batch_pool if more than one
+    thread is used. Twins (see struct rg_event) take them from the child they
+    are a twin of. Only then are the children checked against
+    seen_somatic_genomes, printed and recursed into one by one, in the order
+    they were enumerated, so the output does not depend on the number of
+    threads.
+*/
+void bridge(struct genome *g_ptr) {
+    bridge_children(g_ptr, 0, -1);
+    return;
+}
+
+/*
+    Handles the children first_child to last_child - 1 of g_ptr, to the last
+    one if last_child is -1, and deletes g_ptr.
+*/
+void bridge_children(struct genome *g_ptr, int first_child, int last_child) {
+    if (g_ptr->depth < MAX_DEPTH_NONDUP) {
+        struct batch *b_ptr = create_batch(g_ptr);
+        render_batch(b_ptr);
+        copy_twin_rendering(b_ptr);
+        start_progress_children(progress, g_ptr->depth, b_ptr->n_children);
+
+        int i;
+        if (last_child >= 0 && last_child < b_ptr->n_children) {
+            b_ptr->end_child = last_child;
+        }
+        b_ptr->next_child = (first_child < b_ptr->end_child ? first_child : b_ptr->end_child);
+        for (i=0; i<b_ptr->n_children; i++) {
+            if (i < b_ptr->next_child || i >= b_ptr->end_child) {
+                discard_batch_child(b_ptr->children+i);
+            }
+        }
+        if (PEER_LINKS != NULL) {
+            claim_batch_children(b_ptr, (g_ptr->depth == WORK_STACK->base_depth ? WORK_STACK->base_claims : NULL));
+        }
+
+        if (WORK_STACK != NULL) {
+            *(WORK_STACK->batches+g_ptr->depth) = b_ptr;
+        }
+        while (b_ptr->next_child < b_ptr->end_child) {
+            handle_batch_child(b_ptr->children + b_ptr->next_child++);
+            finish_progress_child(progress, g_ptr->depth);
+            if (WORK_STACK != NULL) {
+                check_work_request();
+            }
+        }
+        if (WORK_STACK != NULL) {
+            *(WORK_STACK->batches+g_ptr->depth) = NULL;
+        }
+        end_progress_children(progress, g_ptr->depth);
+        delete_batch(b_ptr);
+    }
+
+    delete_genome(g_ptr);
+
+    return;
+}
+
+/*
+    Order in which enum_events() goes through the rearrangement types
+*/
+enum rg_type ENUMERATION_ORDER[] = {DEL, INV, TEL_BREAK, BAL_TRANSLOC, UNBAL_TRANSLOC, WC_DEL, TD, INV_DUP, FOLD_BACK, WC_DUP, WG_DUP};
+#define N_ENUMERATED_RG_TYPES ((int)(sizeof(ENUMERATION_ORDER) / sizeof(enum rg_type)))
+
+/*
+    Enumerates all the one-step events of *g_ptr into *events (struct
+    rg_event), with the resulting genomes simplified. If skip_twins is set, the
+    genomes of twin events are not built. Depth budgets are left to the caller,
+    apart from duplicative events that are only enumerated if allow_dup is set.
+*/
+void enum_events(struct genome *g_ptr, GArray *events, int skip_twins, int allow_dup) {
+    struct event_collector *prev_collector = collector;
+    collector = create_event_collector(events, skip_twins);
+
+    int i;
+    for (i=0; i<N_ENUMERATED_RG_TYPES; i++) {
+        if (rg_type_is_enumerated(g_ptr, ENUMERATION_ORDER[i], allow_dup)) {
+            run_enumerator(g_ptr, ENUMERATION_ORDER[i]);
+        }
+    }
+
+    delete_event_collector(collector);
+    collector = prev_collector;
+    return;
+}
+
+/*
+    Same as enum_events(), but only for the events of type rg. Whether rg can
+    follow *g_ptr at all is left to the caller, see rg_type_is_enumerated().
+*/
+void enum_events_of_type(struct genome *g_ptr, enum rg_type rg, GArray *events, int skip_twins) {
+    struct event_collector *prev_collector = collector;
+    collector = create_event_collector(events, skip_twins);
+
+    run_enumerator(g_ptr, rg);
+
+    delete_event_collector(collector);
+    collector = prev_collector;
+    return;
+}
+
+/*
+    Whether enum_events() enumerates events of type rg for *g_ptr. Only
+    telomeric breaks and fold-backs follow a fold-back, whole-genome
+    duplication happens at most once, and no type goes beyond its
+    MAX_EVENTS_OF_TYPE, which disables inverted duplications by default.
+*/
+int rg_type_is_enumerated(struct genome *g_ptr, enum rg_type rg, int allow_dup) {
+    if (rg_type_is_dup(rg) && !allow_dup) {
+        return(0);
+    }
+    if (MAX_EVENTS_OF_TYPE[rg] >= 0 && get_n_events_of_type(g_ptr, rg) >= MAX_EVENTS_OF_TYPE[rg]) {
+        return(0);
+    }
+    if (g_ptr->depth > 0 && *(g_ptr->history+g_ptr->depth-1) == FOLD_BACK) {
+        return(rg == TEL_BREAK || rg == FOLD_BACK);
+    }
+
+    switch(rg) {
+        case WC_DEL  : return(g_ptr->n_chrs > 1);
+        case WG_DUP  : return(g_ptr->wgd_depth == 0);
+        default      : return(1);
+    }
+}
+
+int get_n_events_of_type(struct genome *g_ptr, enum rg_type rg) {
+    int i, n = 0;
+    for (i=0; i<g_ptr->depth; i++) {
+        n += (*(g_ptr->history+i) == rg);
+    }
+    return(n);
+}
+
+/*
+    The bits of the restrictions of a genome, see get_child_restrictions():
+    two for the rules on fold-backs and whole-genome duplication, then, for
+    each type with a positive MAX_EVENTS_OF_TYPE, one per event that a
+    history can have, which is also bounded by MAX_DEPTH_NONDUP.
+*/
+int get_n_restriction_bits() {
+    int rg, n_bits = 2;
+    for (rg=0; rg<N_RG_TYPES; rg++) {
+        if (MAX_EVENTS_OF_TYPE[rg] > 0) {
+            n_bits += (MAX_EVENTS_OF_TYPE[rg] < MAX_DEPTH_NONDUP ? MAX_EVENTS_OF_TYPE[rg] : MAX_DEPTH_NONDUP);
+        }
+    }
+    return(n_bits);
+}
+
+/*
+    The rules of rg_type_is_enumerated() that depend on the history of a
+    genome rather than on its number of events and duplicative events, as a
+    mask, for the child of *parent_ptr by an event of type rg. An expansion
+    of a genome only stands in for another one if its restrictions are a
+    subset of the other's, since the other can otherwise have children it
+    cannot. Each limited type has a bit set per event used, so fewer events
+    used are a subset of more.
+*/
+guint64 get_child_restrictions(struct genome *parent_ptr, enum rg_type rg) {
+    guint64 restrictions = 0;
+    int type, n, offset = 2;
+
+    if (rg == FOLD_BACK) {
+        restrictions |= RESTRICTED_AFTER_FOLD_BACK;
+    }
+    if (rg == WG_DUP || parent_ptr->wgd_depth > 0) {
+        restrictions |= RESTRICTED_AFTER_WG_DUP;
+    }
+    for (type=0; type<N_RG_TYPES; type++) {
+        if (MAX_EVENTS_OF_TYPE[type] > 0) {
+            n = get_n_events_of_type(parent_ptr, type) + ((int)rg == type);
+            restrictions |= (((guint64)1 << n) - 1) << offset;
+            offset += (MAX_EVENTS_OF_TYPE[type] < MAX_DEPTH_NONDUP ? MAX_EVENTS_OF_TYPE[type] : MAX_DEPTH_NONDUP);
+        }
+    }
+    return(restrictions);
+}
+
+/*
+    Runs the enumerator of rearrangement type rg on *g_ptr, under the current
+    collector.
+*/
+void run_enumerator(struct genome *g_ptr, enum rg_type rg) {
+    switch(rg) {
+        case DEL            : enum_dels(g_ptr); break;
+        case TD             : enum_tds(g_ptr); break;
+        case INV_DUP        : enum_inv_dups(g_ptr); break;
+        case INV            : enum_invs(g_ptr); break;
+        case TEL_BREAK      : enum_tel_break(g_ptr); break;
+        case FOLD_BACK      : enum_fbs(g_ptr); break;
+        case BAL_TRANSLOC   : enum_bal_transloc(g_ptr); break;
+        case UNBAL_TRANSLOC : enum_unbal_transloc(g_ptr); break;
+        case WC_DUP         : enum_wc_dup(g_ptr); break;
+        case WC_DEL         : enum_wc_del(g_ptr); break;
+        case WG_DUP         : enum_wg_dup(g_ptr); break;
+    }
+    return;
+}
+
+/*
+    Collects all the one-step children of *g_ptr into *children as simplified
+    genomes, see enum_events().
+*/
+void enum_children(struct genome *g_ptr, GPtrArray *children, int allow_dup) {
+    GArray *events = g_array_new(0, 0, sizeof(struct rg_event));
+    enum_events(g_ptr, events, 0, allow_dup);
+
+    int i;
+    for (i=0; i<events->len; i++) {
+        g_ptr_array_add(children, g_array_index(events, struct rg_event, i).g_ptr);
+    }
+    g_array_free(events, 1);
+
+    return;
+}
+
+struct event_collector* create_event_collector(GArray *events, int skip_twins) {
+    struct event_collector *ec_ptr = malloc(sizeof(struct event_collector));
+    if (ec_ptr == NULL) {
+        fprintf(stderr, "\nCreation of event collector failed. Exiting.\n");
+        exit(1);
+    }
+    ec_ptr->events = events;
+    ec_ptr->blocks = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free);
+    ec_ptr->skip_twins = skip_twins;
+    ec_ptr->known_blocks = NULL;
+    ec_ptr->count_only = 0;
+    ec_ptr->n_counted = 0;
+    ec_ptr->block_rg = -1;
+    ec_ptr->block_c1_idx = ec_ptr->block_c2_idx = -1;
+    ec_ptr->block_hist_idx = 0;
+    ec_ptr->wanted = NULL;
+    ec_ptr->wanted_g_ptr = NULL;
+    ec_ptr->catalog = NULL;
+
+    return(ec_ptr);
+}
+
+void delete_event_collector(struct event_collector *ec_ptr) {
+    g_hash_table_destroy(ec_ptr->blocks);
+    if (ec_ptr->catalog != NULL) {
+        delete_breakpoint_catalog(ec_ptr->catalog);
+    }
+    free(ec_ptr);
+    return;
+}
+
+struct breakpoint_catalog* create_breakpoint_catalog(struct genome *g_ptr) {
+    struct breakpoint_catalog *bc_ptr = malloc(sizeof(struct breakpoint_catalog));
+    int *n_copies = calloc(g_ptr->n_genome_segs, sizeof(int));
+    struct breakpoint *bp_ptr;
+    struct seg *s_ptr;
+    int n_breakpoints = 0, c_idx, s_idx;
+
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        n_breakpoints += (*(g_ptr->root_chr+c_idx))->n_segs;
+    }
+    if (bc_ptr == NULL || n_copies == NULL) {
+        fprintf(stderr, "\nCreation of breakpoint catalog failed. Exiting.\n");
+        exit(1);
+    }
+    bc_ptr->breakpoints = malloc(n_breakpoints * sizeof(struct breakpoint));
+    bc_ptr->chr_breakpoints = malloc((g_ptr->n_chrs + 1) * sizeof(struct breakpoint*));
+    if (bc_ptr->breakpoints == NULL || bc_ptr->chr_breakpoints == NULL) {
+        fprintf(stderr, "\nCreation of breakpoints failed. Exiting.\n");
+        exit(1);
+    }
+
+    bp_ptr = bc_ptr->breakpoints;
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        *(bc_ptr->chr_breakpoints+c_idx) = bp_ptr;
+        for (s_idx=0; s_idx<(*(g_ptr->root_chr+c_idx))->n_segs; s_idx++) {
+            s_ptr = *((*(g_ptr->root_chr+c_idx))->root_seg+s_idx);
+            bp_ptr->seg_indexes = s_ptr->seg_indexes;
+            bp_ptr->times_divided = s_ptr->times_divided;
+            bp_ptr->seg_class = find_genome_seg_idx(g_ptr, s_ptr);
+            *(n_copies+bp_ptr->seg_class) += 1;
+            bp_ptr++;
+        }
+    }
+    *(bc_ptr->chr_breakpoints+g_ptr->n_chrs) = bp_ptr;
+    bc_ptr->n_chrs = g_ptr->n_chrs;
+    for (bp_ptr=bc_ptr->breakpoints; bp_ptr<bc_ptr->breakpoints+n_breakpoints; bp_ptr++) {
+        bp_ptr->n_copies = *(n_copies+bp_ptr->seg_class);
+    }
+    free(n_copies);
+
+    bc_ptr->commuting_chrs = NULL;
+    if (REDUCE_COMMUTING) {
+        add_commuting_chrs(bc_ptr, g_ptr);
+    }
+
+    return(bc_ptr);
+}
+
+void delete_breakpoint_catalog(struct breakpoint_catalog *bc_ptr) {
+    free(bc_ptr->breakpoints);
+    free(bc_ptr->chr_breakpoints);
+    free(bc_ptr->commuting_chrs);
+    free(bc_ptr);
+    return;
+}
+
+/*
+    Breakpoints of chromosome c_idx of *g_ptr, the genome of the current
+    collector, indexed like its segments.
+*/
+struct breakpoint* get_chr_breakpoints(struct genome *g_ptr, int c_idx) {
+    if (collector->catalog == NULL) {
+        collector->catalog = create_breakpoint_catalog(g_ptr);
+    }
+    return(*(collector->catalog->chr_breakpoints+c_idx));
+}
+
+/*
+    Single-chromosome events that keep the chromosomes of the genome in place,
+    so that two of them on different chromosomes can commute.
+*/
+int rg_type_commutes(enum rg_type rg) {
+    switch(rg) {
+        case DEL       :
+        case TD        :
+        case INV_DUP   :
+        case INV       :
+        case TEL_BREAK :
+        case FOLD_BACK : return(1);
+        default        : return(0);
+    }
+}
+
+/*
+    For each chromosome of *g_ptr, the chromosomes with no segment in common
+    with it, as a bit mask. Events on two such chromosomes neither change nor
+    split the segments of each other, so they give exactly the same genome in
+    either order. Only the first 64 chromosomes are considered.
+*/
+void add_commuting_chrs(struct breakpoint_catalog *bc_ptr, struct genome *g_ptr) {
+    guint64 *class_chrs = calloc(g_ptr->n_genome_segs, sizeof(guint64));  // Chromosomes having each class
+    struct breakpoint *bp_ptr;
+    guint64 shared, all_chrs;
+    int c_idx, rg;
+
+    bc_ptr->commuting_chrs = malloc(bc_ptr->n_chrs * sizeof(guint64));
+    if (class_chrs == NULL || bc_ptr->commuting_chrs == NULL) {
+        fprintf(stderr, "\nFailed to malloc commuting chromosomes. Exiting.\n");
+        exit(1);
+    }
+    for (c_idx=0; c_idx<bc_ptr->n_chrs && c_idx<64; c_idx++) {
+        for (bp_ptr=*(bc_ptr->chr_breakpoints+c_idx); bp_ptr<*(bc_ptr->chr_breakpoints+c_idx+1); bp_ptr++) {
+            *(class_chrs+bp_ptr->seg_class) |= (guint64)1 << c_idx;
+        }
+    }
+    all_chrs = (bc_ptr->n_chrs >= 64 ? ~(guint64)0 : ((guint64)1 << bc_ptr->n_chrs) - 1);
+    for (c_idx=0; c_idx<bc_ptr->n_chrs; c_idx++) {
+        shared = 0;
+        for (bp_ptr=*(bc_ptr->chr_breakpoints+c_idx); bp_ptr<*(bc_ptr->chr_breakpoints+c_idx+1); bp_ptr++) {
+            shared |= *(class_chrs+bp_ptr->seg_class);
+        }
+        *(bc_ptr->commuting_chrs+c_idx) = (c_idx < 64 ? ~shared & all_chrs : 0);
+    }
+    free(class_chrs);
+
+    bc_ptr->explored_types = 0;
+    for (rg=0; rg<N_RG_TYPES; rg++) {
+        if (rg_type_is_enumerated(g_ptr, rg, g_ptr->dup_depth < MAX_DEPTH_DUP)) {
+            bc_ptr->explored_types |= 1 << rg;
+        }
+    }
+    return;
+}
+
+/*
+    Sleep set of the child *g_ptr of the genome of the current collector by
+    the event of type rg just enumerated, which starts as the sleep set of
+    the parent. A block of events stays asleep, or falls asleep if the parent
+    enumerates it before the event, when it commutes with the event, since
+    its genomes with the event are then reached through the earlier children
+    of the parent. Only the single-chromosome events that keep the other
+    chromosomes in place commute, and a fold-back only with the events it can
+    be followed by, see rg_type_is_enumerated().
+*/
+void set_sleep_set(struct genome *g_ptr, enum rg_type rg) {
+    struct breakpoint_catalog *bc_ptr = collector->catalog;
+    guint64 commuting_chrs, explored_chrs;
+    int i, c_idx = collector->block_c1_idx, is_before = 1;
+
+    if (rg != collector->block_rg || !rg_type_commutes(rg) || bc_ptr == NULL || bc_ptr->commuting_chrs == NULL) {
+        memset(g_ptr->sleep_set, 0, sizeof(g_ptr->sleep_set));
+        return;
+    }
+
+    commuting_chrs = *(bc_ptr->commuting_chrs+c_idx);
+    for (i=0; i<N_ENUMERATED_RG_TYPES; i++) {
+        enum rg_type t = ENUMERATION_ORDER[i];
+        if (t == rg) {
+            explored_chrs = (c_idx < 64 ? ((guint64)1 << c_idx) - 1 : ~(guint64)0);
+            is_before = 0;
+        }
+        else {
+            explored_chrs = (is_before && (bc_ptr->explored_types & (1 << t)) ? ~(guint64)0 : 0);
+        }
+
+        if (!rg_type_commutes(t) || (t == FOLD_BACK && rg != TEL_BREAK && rg != FOLD_BACK)) {
+            g_ptr->sleep_set[t] = 0;
+        }
+        else {
+            g_ptr->sleep_set[t] = (g_ptr->sleep_set[t] | explored_chrs) & commuting_chrs;
+        }
+    }
+    return;
+}
+
+/*
+    Whether the events of type rg on chromosome c_idx of *g_ptr are asleep
+    with REDUCE_COMMUTING, see set_sleep_set(). Translocations and whole
+    chromosome events never sleep.
+*/
+int is_sleeping_block(struct genome *g_ptr, enum rg_type rg, int c_idx) {
+    if (!REDUCE_COMMUTING || collector->known_blocks != NULL || collector->count_only || c_idx >= 64) {
+        return(0);
+    }
+    return((g_ptr->sleep_set[rg] >> c_idx) & 1);
+}
+
+/*
+    Number of events of a sleeping block, as the enumerators would go
+    through them: one for each segment and each pair of segments of the
+    chromosome, and one more for pairs of copies of the same segment, twice
+    for inverted duplications, and two for each segment for telomeric breaks
+    and fold-backs.
+*/
+int count_sleeping_block_events(struct genome *g_ptr, enum rg_type rg, int c_idx) {
+    struct breakpoint *c_bps = get_chr_breakpoints(g_ptr, c_idx);
+    int n_segs = (*(g_ptr->root_chr+c_idx))->n_segs;
+    int b1, b2, n_events;
+
+    if (rg == TEL_BREAK || rg == FOLD_BACK) {
+        return(2 * n_segs);
+    }
+    n_events = n_segs * (n_segs + 1) / 2;
+    for (b1=0; b1<n_segs; b1++) {
+        for (b2=b1+1; b2<n_segs; b2++) {
+            n_events += ((c_bps+b1)->seg_class == (c_bps+b2)->seg_class);
+        }
+    }
+    return(rg == INV_DUP ? 2 * n_events : n_events);
+}
+
+/*
+    Splits the copies of the segment of breakpoint *bp_ptr left in the child
+    *g_ptr, and genome_segs, as splice_all_segs() does. The enumerators split
+    the broken copies themselves first, so if the parent had no other copy
+    only genome_segs is left to split.
+*/
+void splice_breakpoint_copies(struct genome *g_ptr, struct breakpoint *bp_ptr, int split_into) {
+    if (bp_ptr->n_copies > 1) {
+        splice_all_segs(g_ptr, bp_ptr->seg_indexes, bp_ptr->times_divided, split_into);
+    }
+    else {
+        splice_genome_segs(g_ptr, bp_ptr->seg_indexes, bp_ptr->times_divided, split_into);
+    }
+    return;
+}
+
+void get_block_key(struct genome *g_ptr, enum rg_type rg, int c1_idx, int c2_idx, GString *key) {
+    g_string_printf(
+        key,
+        "%d,%d,%d",
+        rg,
+        get_chromosome_info(*(g_ptr->root_chr+c1_idx))->id,
+        (c2_idx < 0 ? -1 : get_chromosome_info(*(g_ptr->root_chr+c2_idx))->id)
+    );
+    return;
+}
+
+/*
+    Called by the enumerators before the block of events of type rg on
+    chromosome c1_idx (and c2_idx for translocations, -1 otherwise) of *g_ptr,
+    with *hist_idx the index the first event of the block would get. Returns
+    whether the enumerator must skip the block, in which case its events have
+    been recorded as twins, or without genomes when counting with
+    known_blocks, or not at all if they are asleep (see set_sleep_set()),
+    and *hist_idx is advanced past them.
+*/
+int is_twin_block(struct genome *g_ptr, enum rg_type rg, int c1_idx, int c2_idx, int *hist_idx) {
+    collector->block_rg = rg;
+    collector->block_c1_idx = c1_idx;
+    collector->block_c2_idx = c2_idx;
+    collector->block_hist_idx = *hist_idx;
+
+    // Materialising a single event, skip all the other blocks
+    if (collector->wanted != NULL) {
+        if (rg != collector->wanted->rg || c1_idx != collector->wanted->c1_idx || c2_idx != collector->wanted->c2_idx) {
+            return(1);
+        }
+        *hist_idx = collector->block_hist_idx = collector->wanted->block_hist_idx;
+        return(0);
+    }
+
+    // Sleeping block, skip its events but keep the indexes of the later ones
+    if (is_sleeping_block(g_ptr, rg, c1_idx)) {
+        *hist_idx += count_sleeping_block_events(g_ptr, rg, c1_idx);
+        return(1);
+    }
+
+    if (!collector->skip_twins && collector->known_blocks == NULL) {
+        return(0);
+    }
+
+    GString *key = g_string_new(NULL);
+    get_block_key(g_ptr, rg, c1_idx, c2_idx, key);
+
+    int i, n_events;
+    struct rg_event e;
+    if (collector->known_blocks != NULL) {
+        struct block_counts *known_blocks = collector->known_blocks;
+        g_mutex_lock(&(known_blocks->lock));
+        int *n_events_ptr = (int*)g_hash_table_lookup(known_blocks->counts, key->str);
+        n_events = (n_events_ptr == NULL ? -1 : *n_events_ptr);
+        g_mutex_unlock(&(known_blocks->lock));
+
+        if (n_events < 0) {
+            n_events = count_block_events(g_ptr, rg, c1_idx, c2_idx);
+            n_events_ptr = malloc(sizeof(int));
+            if (n_events_ptr == NULL) {
+                fprintf(stderr, "\nFailed to malloc block count. Exiting.\n");
+                exit(1);
+            }
+            *n_events_ptr = n_events;
+            g_mutex_lock(&(known_blocks->lock));
+            g_hash_table_replace(known_blocks->counts, g_strdup(key->str), n_events_ptr);
+            g_mutex_unlock(&(known_blocks->lock));
+        }
+
+        e.rg = rg;
+        e.c1_idx = c1_idx;
+        e.c2_idx = c2_idx;
+        e.block_hist_idx = collector->block_hist_idx;
+        e.twin_idx = -1;
+        e.g_ptr = NULL;
+        for (i=0; i<n_events; i++) {
+            e.hist_idx = collector->block_hist_idx + i;
+            g_array_append_val(collector->events, e);
+        }
+        *hist_idx += n_events;
+        g_string_free(key, 1);
+        return(1);
+    }
+
+    struct event_block *block_ptr = (struct event_block*)g_hash_table_lookup(collector->blocks, key->str);
+    if (block_ptr == NULL) {
+        block_ptr = malloc(sizeof(struct event_block));
+        if (block_ptr == NULL) {
+            fprintf(stderr, "\nCreation of event block failed. Exiting.\n");
+            exit(1);
+        }
+        block_ptr->first_event = collector->events->len;
+        block_ptr->c1_idx = c1_idx;
+        block_ptr->c2_idx = c2_idx;
+        g_hash_table_insert(collector->blocks, g_string_free(key, 0), block_ptr);
+        return(0);
+    }
+    g_string_free(key, 1);
+
+    // Twin block, record its events from the earlier block
+    n_events = collector->events->len;
+    for (i=block_ptr->first_event; i<n_events; i++) {
+        e = g_array_index(collector->events, struct rg_event, i);
+        if (e.rg != rg || e.c1_idx != block_ptr->c1_idx || e.c2_idx != block_ptr->c2_idx) {
+            break;
+        }
+        e.hist_idx = collector->block_hist_idx + e.hist_idx - e.block_hist_idx;
+        e.c1_idx = c1_idx;
+        e.c2_idx = c2_idx;
+        e.block_hist_idx = collector->block_hist_idx;
+        e.twin_idx = i;
+        e.g_ptr = NULL;
+        g_array_append_val(collector->events, e);
+        *hist_idx = e.hist_idx + 1;
+    }
+
+    return(1);
+}
+
+struct block_counts* create_block_counts() {
+    struct block_counts *bc_ptr = malloc(sizeof(struct block_counts));
+    if (bc_ptr == NULL) {
+        fprintf(stderr, "\nCreation of block counts failed. Exiting.\n");
+        exit(1);
+    }
+    bc_ptr->counts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free);
+    g_mutex_init(&(bc_ptr->lock));
+    return(bc_ptr);
+}
+
+void delete_block_counts(struct block_counts *bc_ptr) {
+    g_hash_table_destroy(bc_ptr->counts);
+    g_mutex_clear(&(bc_ptr->lock));
+    free(bc_ptr);
+    return;
+}
+
+/*
+    Same as enum_events_of_type() with twins skipped, but the genomes of the
+    events in blocks are not built at all: the events are only recorded, with
+    the number of events of each block taken from *known_blocks.
+*/
+void count_events_of_type(struct genome *g_ptr, enum rg_type rg, GArray *events, struct block_counts *known_blocks) {
+    struct event_collector *prev_collector = collector;
+    collector = create_event_collector(events, 1);
+    collector->known_blocks = known_blocks;
+
+    run_enumerator(g_ptr, rg);
+
+    delete_event_collector(collector);
+    collector = prev_collector;
+    return;
+}
+
+/*
+    Number of events of type rg on chromosome c1_idx (and c2_idx) of *g_ptr,
+    enumerated on a copy of *g_ptr with only these chromosomes.
+*/
+int count_block_events(struct genome *g_ptr, enum rg_type rg, int c1_idx, int c2_idx) {
+    // Whole-chromosome events, one per chromosome
+    if (rg == WC_DUP || rg == WC_DEL) {
+        return(1);
+    }
+
+    // The copy has a single block, so there are no twins to skip
+    struct genome *part_ptr = copy_genome_part(g_ptr, c1_idx, c2_idx);
+    struct event_collector *prev_collector = collector;
+    collector = create_event_collector(NULL, 0);
+    collector->count_only = 1;
+
+    run_enumerator(part_ptr, rg);
+
+    int n_events = collector->n_counted;
+    delete_event_collector(collector);
+    collector = prev_collector;
+    delete_genome(part_ptr);
+
+    return(n_events);
+}
+
+/*
+    Builds the simplified genome resulting from the event *e_ptr of *g_ptr, as
+    enumerated by enum_events(), by enumerating only the block of the event.
+*/
+struct genome* materialize_event(struct genome *g_ptr, struct rg_event *e_ptr) {
+    struct event_collector *prev_collector = collector;
+    collector = create_event_collector(NULL, 0);
+    collector->wanted = e_ptr;
+
+    run_enumerator(g_ptr, e_ptr->rg);
+
+    struct genome *new_g_ptr = collector->wanted_g_ptr;
+    delete_event_collector(collector);
+    collector = prev_collector;
+    if (new_g_ptr == NULL) {
+        fprintf(stderr, "\nEvent %s%d not found in materialize_event(). Exiting.\n", rg_type_to_txt(e_ptr->rg), e_ptr->hist_idx);
+        exit(1);
+    }
+
+    return(new_g_ptr);
+}
+
+
+/*
+    Little helper function
+*/
+char *get_detailed_history(struct genome *g_ptr) {
+    GString *bfr = g_string_new(NULL);
+
+    int i;
+    for (i=0; i<g_ptr->depth; i++) {
+        g_string_append_printf(
+            bfr,
+            "%s%d%s",
+            rg_type_to_txt(*(g_ptr->history+i)),
+            *(g_ptr->history_idx+i),
+            (i == g_ptr->depth - 1 ? " " : "-")
+        );
+    }
+
+    return(g_string_free(bfr, 0));
+}
+
+// Detailed history of the child of *g_ptr produced by the event *e_ptr, without building the child
+char *get_child_detailed_history(struct genome *g_ptr, struct rg_event *e_ptr) {
+    GString *bfr = g_string_new(NULL);
+
+    int i;
+    for (i=0; i<g_ptr->depth; i++) {
+        g_string_append_printf(bfr, "%s%d-", rg_type_to_txt(*(g_ptr->history+i)), *(g_ptr->history_idx+i));
+    }
+    g_string_append_printf(bfr, "%s%d ", rg_type_to_txt(e_ptr->rg), e_ptr->hist_idx);
+
+    return(g_string_free(bfr, 0));
+}
+
+/*
+    Whether the genomes of the next n_events events, from *hist_idx on, are
+    not needed, so that the enumerator can skip building them: when the events
+    are only counted, or when another event is being materialised. Their
+    history indexes are used up here then. The enumerators building two
+    genomes at once skip both together.
+*/
+int skip_events(int *hist_idx, int n_events) {
+    if (collector->count_only) {
+        collector->n_counted += n_events;
+    }
+    else if (
+        collector->wanted == NULL ||
+        (collector->wanted->hist_idx >= *hist_idx && collector->wanted->hist_idx < *hist_idx + n_events)
+    ) {
+        return(0);
+    }
+    *hist_idx += n_events;
+    return(1);
+}
+
+/*
+    Every enumerated child is passed to one of these, which only record the
+    event producing the child in the collector.
+*/
+void handle_next_step(struct genome *g_ptr) {
+    if (collector->count_only) {
+        collector->n_counted++;
+        delete_genome(g_ptr);
+        return;
+    }
+
+    struct rg_event e;
+    e.rg = *(g_ptr->history+g_ptr->depth-1);
+    e.hist_idx = *(g_ptr->history_idx+g_ptr->depth-1);
+
+    if (REDUCE_COMMUTING) {
+        set_sleep_set(g_ptr, e.rg);
+    }
+
+    if (collector->wanted != NULL) {
+        if (e.rg == collector->wanted->rg && e.hist_idx == collector->wanted->hist_idx) {
+            simplify_genome(g_ptr);
+            collector->wanted_g_ptr = g_ptr;
+        }
+        else {
+            delete_genome(g_ptr);
+        }
+        return;
+    }
+
+    simplify_genome(g_ptr);
+    if (e.rg == collector->block_rg) {
+        e.c1_idx = collector->block_c1_idx;
+        e.c2_idx = collector->block_c2_idx;
+        e.block_hist_idx = collector->block_hist_idx;
+    }
+    else {
+        e.c1_idx = e.c2_idx = -1;
+        e.block_hist_idx = e.hist_idx;
+    }
+    e.twin_idx = -1;
+    e.g_ptr = g_ptr;
+    g_array_append_val(collector->events, e);
+    return;
+}
+
+void handle_next_step_after_fold_back(struct genome *g_ptr) {
+    handle_next_step(g_ptr);
+    return;
+}
+/*
+    End helper functions
+*/
+
+
+/*
+    Functions for processing the children of a genome in batches
+*/
+struct batch* create_batch(struct genome *g_ptr) {
+    struct batch *b_ptr = malloc(sizeof(struct batch));
+    if (b_ptr == NULL) {
+        fprintf(stderr, "\nCreation of batch failed. Exiting.\n");
+        exit(1);
+    }
+    b_ptr->g_ptr = g_ptr;
+    b_ptr->events = g_array_new(0, 0, sizeof(struct rg_event));
+    enum_events(g_ptr, b_ptr->events, 1, g_ptr->dup_depth < MAX_DEPTH_DUP);
+
+    b_ptr->n_children = b_ptr->events->len;
+    b_ptr->children = malloc(b_ptr->n_children * sizeof(struct batch_child));
+    if (b_ptr->children == NULL && b_ptr->n_children > 0) {
+        fprintf(stderr, "\nCreation of batch children failed. Exiting.\n");
+        exit(1);
+    }
+    b_ptr->n_pending = 0;
+    memset(b_ptr->unexplored_chrs, 0, sizeof(b_ptr->unexplored_chrs));
+    b_ptr->next_child = 0;
+    b_ptr->end_child = b_ptr->n_children;
+    g_mutex_init(&(b_ptr->lock));
+    g_cond_init(&(b_ptr->all_rendered));
+
+    int i;
+    struct batch_child *bc_ptr;
+    for (i=0; i<b_ptr->n_children; i++) {
+        bc_ptr = b_ptr->children+i;
+        bc_ptr->e_ptr = &g_array_index(b_ptr->events, struct rg_event, i);
+        bc_ptr->g_ptr = bc_ptr->e_ptr->g_ptr;
+        bc_ptr->unique_genome_string = g_string_new(NULL);
+        bc_ptr->cn_string = g_string_new(NULL);
+        bc_ptr->rg_string = g_string_new(NULL);
+        bc_ptr->is_target = 1;
+        bc_ptr->can_reach_target = 1;
+        bc_ptr->claim_state = CLAIM_NONE;
+        bc_ptr->claim_hist = NULL;
+        bc_ptr->b_ptr = b_ptr;
+    }
+
+    return(b_ptr);
+}
+
+void delete_batch(struct batch *b_ptr) {
+    g_mutex_clear(&(b_ptr->lock));
+    g_cond_clear(&(b_ptr->all_rendered));
+    g_array_free(b_ptr->events, 1);
+    free(b_ptr->children);
+    free(b_ptr);
+    return;
+}
+
+/*
+    Computes everything about a child that does not depend on the other
+    genomes: its unique genome string, its rearrangement pattern and whether it
+    is or can still become the target.
+*/
+void render_batch_child(struct batch_child *bc_ptr) {
+    if (bc_ptr->g_ptr == NULL) {
+        return;
+    }
+    get_unique_genome_string(bc_ptr->g_ptr, bc_ptr->unique_genome_string);
+    get_rg_pattern(bc_ptr->g_ptr, bc_ptr->cn_string, bc_ptr->rg_string);
+    if (TARGET != NULL) {
+        bc_ptr->is_target = check_target(bc_ptr->g_ptr, bc_ptr->cn_string, bc_ptr->rg_string, &(bc_ptr->can_reach_target));
+    }
+    return;
+}
+
+// Task function of batch_pool
+void render_batch_child_in_pool(gpointer data, gpointer user_data) {
+    struct batch_child *bc_ptr = (struct batch_child*)data;
+    struct batch *b_ptr = bc_ptr->b_ptr;
+
+    render_batch_child(bc_ptr);
+
+    g_mutex_lock(&(b_ptr->lock));
+    b_ptr->n_pending--;
+    if (b_ptr->n_pending == 0) {
+        g_cond_signal(&(b_ptr->all_rendered));
+    }
+    g_mutex_unlock(&(b_ptr->lock));
+    return;
+}
+
+void render_batch(struct batch *b_ptr) {
+    int i;
+    if (batch_pool == NULL || b_ptr->n_children < 2) {
+        for (i=0; i<b_ptr->n_children; i++) {
+            render_batch_child(b_ptr->children+i);
+        }
+        return;
+    }
+
+    g_mutex_lock(&(b_ptr->lock));
+    b_ptr->n_pending = b_ptr->n_children;
+    for (i=0; i<b_ptr->n_children; i++) {
+        g_thread_pool_push(batch_pool, b_ptr->children+i, NULL);
+    }
+    while (b_ptr->n_pending > 0) {
+        g_cond_wait(&(b_ptr->all_rendered), &(b_ptr->lock));
+    }
+    g_mutex_unlock(&(b_ptr->lock));
+
+    return;
+}
+
+void copy_twin_rendering(struct batch *b_ptr) {
+    int i;
+    struct batch_child *bc_ptr, *twin_ptr;
+    for (i=0; i<b_ptr->n_children; i++) {
+        bc_ptr = b_ptr->children+i;
+        if (bc_ptr->g_ptr != NULL) {
+            continue;
+        }
+        twin_ptr = b_ptr->children+bc_ptr->e_ptr->twin_idx;
+        g_string_assign(bc_ptr->unique_genome_string, twin_ptr->unique_genome_string->str);
+        g_string_assign(bc_ptr->cn_string, twin_ptr->cn_string->str);
+        g_string_assign(bc_ptr->rg_string, twin_ptr->rg_string->str);
+        bc_ptr->is_target = twin_ptr->is_target;
+        bc_ptr->can_reach_target = twin_ptr->can_reach_target;
+    }
+
+    return;
+}
+
+/*
+    Checks a rendered child against seen_somatic_genomes, prints it and recurses
+    into it if it was not expanded before with at most as many events and
+    duplicative events, here or, with run_workers(), by another worker.
+*/
+void handle_batch_child(struct batch_child *bc_ptr) {
+    struct genome *parent_ptr = bc_ptr->b_ptr->g_ptr;
+    struct genome *g_ptr = bc_ptr->g_ptr;
+    struct rg_event *e_ptr = bc_ptr->e_ptr;
+    char *previous_somatic_genome, *genome_hist;
+    int depth = parent_ptr->depth + 1;
+    int dup_depth = parent_ptr->dup_depth + rg_type_is_dup(e_ptr->rg);
+    guint64 restrictions = get_child_restrictions(parent_ptr, e_ptr->rg);
+    int is_new = 1;
+
+    if (TARGET != NULL && bc_ptr->is_target) {
+        TARGET_N_FOUND++;
+    }
 
-void bridge(struct genome *g_ptr) {
-    if (g_ptr->depth < MAX_DEPTH_NONDUP) {
-        enum_dels(g_ptr);
-        enum_invs(g_ptr);
-        enum_tel_break(g_ptr);
-        enum_bal_transloc(g_ptr);
-        enum_unbal_transloc(g_ptr);
-        if (g_ptr->n_chrs > 1) {
-            enum_wc_del(g_ptr);
-        }
-
-        if (g_ptr->dup_depth < MAX_DEPTH_DUP) {
-            enum_tds(g_ptr);
-            // enum_inv_dups(g_ptr);
-            enum_fbs(g_ptr);
-            enum_wc_dup(g_ptr);
-
-            if (g_ptr->wgd_depth == 0) {
-                enum_wg_dup(g_ptr);
+    // Previous genome with the same configuration as the current one was reached with fewer events?
+    if (bc_ptr->claim_state == CLAIM_NONE) {
+        previous_somatic_genome = lookup_seen_genome(bc_ptr->unique_genome_string->str, depth, dup_depth, restrictions);
+    }
+    else {  // Answered by the owner of the genome
+        previous_somatic_genome = bc_ptr->claim_hist;
+    }
+    if (previous_somatic_genome != NULL) {
+        if (bc_ptr->is_target) { print_child_with_pattern(parent_ptr, e_ptr->rg, e_ptr->hist_idx, bc_ptr->cn_string->str, bc_ptr->rg_string->str, previous_somatic_genome); }
+        is_new = 0;
+    }
+
+    if (is_new) {
+        // A twin improving on the previously seen genome is expanded after all
+        if (g_ptr == NULL) {
+            g_ptr = bc_ptr->g_ptr = materialize_event(parent_ptr, e_ptr);
+            get_unique_genome_string(g_ptr, bc_ptr->unique_genome_string);
+        }
+
+        if (bc_ptr->claim_state == CLAIM_GRANTED) {  // Remembered by the owner of the genome
+            if (bc_ptr->is_target) { print_genome_with_pattern(g_ptr, bc_ptr->cn_string->str, bc_ptr->rg_string->str, bc_ptr->unique_genome_string->str); }
+        }
+        else {
+            genome_hist = get_detailed_history(g_ptr);
+
+            // Expanded by another worker process?
+            if (SHARED_SEEN != NULL && (previous_somatic_genome = claim_shared_genome(hash_genome_string(bc_ptr->unique_genome_string->str), depth, dup_depth, restrictions, genome_hist)) != NULL) {
+                if (bc_ptr->is_target) { print_child_with_pattern(parent_ptr, e_ptr->rg, e_ptr->hist_idx, bc_ptr->cn_string->str, bc_ptr->rg_string->str, previous_somatic_genome); }
+                remember_seen_genome(bc_ptr->unique_genome_string->str, g_strdup(previous_somatic_genome), depth, dup_depth, restrictions);
+                g_free(genome_hist);
+                is_new = 0;
+            }
+            else {
+                if (bc_ptr->is_target) { print_genome_with_pattern(g_ptr, bc_ptr->cn_string->str, bc_ptr->rg_string->str, bc_ptr->unique_genome_string->str); }
+                remember_seen_genome(bc_ptr->unique_genome_string->str, genome_hist, depth, dup_depth, restrictions);
             }
         }
     }
+    if (REDUCE_COMMUTING) {
+        update_sleep_set(bc_ptr, is_new, is_new && bc_ptr->can_reach_target);
+    }
+    if (count_progress_visit(progress, depth, is_new)) {
+        report_progress(progress, g_hash_table_size(seen_somatic_genomes), (seen_budget == NULL ? -1 : seen_budget->n_bytes));
+    }
 
-    delete_genome(g_ptr);
+    g_string_free(bc_ptr->unique_genome_string, 1);
+    g_string_free(bc_ptr->cn_string, 1);
+    g_string_free(bc_ptr->rg_string, 1);
+    g_free(bc_ptr->claim_hist);
+
+    if (is_new && bc_ptr->can_reach_target) {
+        bridge(g_ptr);
+    }
+    else if (g_ptr != NULL) {
+        delete_genome(g_ptr);
+    }
 
     return;
 }
+/*
+    With REDUCE_COMMUTING, a block of events can only put the later children
+    of its genome to sleep (see set_sleep_set()) if its own children are
+    explored in full: expanded, or seen before with an expansion that was not
+    reduced. The sleep set of a child about to be expanded loses the blocks
+    of the earlier children that were not, and whether the expansion is
+    still reduced is remembered in reduced_genomes.
+*/
+void update_sleep_set(struct batch_child *bc_ptr, int is_new, int is_expanded) {
+    struct batch *b_ptr = bc_ptr->b_ptr;
+    struct rg_event *e_ptr = bc_ptr->e_ptr;
+    char *key = bc_ptr->unique_genome_string->str;
+    struct seen_genome *sg_ptr;
+    int rg, is_reduced = 0;
+
+    if (is_expanded) {
+        for (rg=0; rg<N_RG_TYPES; rg++) {
+            bc_ptr->g_ptr->sleep_set[rg] &= ~b_ptr->unexplored_chrs[rg];
+            is_reduced |= (bc_ptr->g_ptr->sleep_set[rg] != 0);
+        }
+        sg_ptr = (struct seen_genome*)g_hash_table_lookup(seen_somatic_genomes, key);
+        if (is_reduced) {
+            g_hash_table_replace(reduced_genomes, g_strdup(key), NULL);
+        }
+        else if (sg_ptr == NULL || sg_ptr->n_points == 1) {  // Earlier expansions still on the front may have been reduced
+            g_hash_table_remove(reduced_genomes, key);
+        }
+    }
+    else if (is_new || g_hash_table_contains(reduced_genomes, key)) {
+        if (rg_type_commutes(e_ptr->rg) && e_ptr->c1_idx >= 0 && e_ptr->c1_idx < 64) {
+            b_ptr->unexplored_chrs[e_ptr->rg] |= (guint64)1 << e_ptr->c1_idx;
+        }
+    }
+    return;
+}
+/*
+    End functions for processing the children of a genome in batches
+*/
 
 
 /*
-    Little helper function
+    Functions for the table of seen genomes, see struct seen_budget
 */
-char *get_detailed_history(struct genome *g_ptr) {
-    char *bfr = malloc(100 * sizeof(char));  // Just allow 100 characters should be plenty
-    char bfr2[100];
-    if (bfr == NULL) {
-        fprintf(stderr, "Failed to malloc bfb in get_detailed_history(). Exiting. \n");
+struct seen_budget* create_seen_budget(long max_bytes) {
+    struct seen_budget *sb_ptr = malloc(sizeof(struct seen_budget));
+    if (sb_ptr == NULL) {
+        fprintf(stderr, "\nCreation of seen genome budget failed. Exiting.\n");
+        exit(1);
+    }
+    sb_ptr->max_bytes = max_bytes;
+    sb_ptr->n_bytes = 0;
+    sb_ptr->n_evicted = 0;
+
+    // A 32nd of the budget, about 10 bits per entry of typical size
+    sb_ptr->n_filter_blocks = max_bytes / 32 / (SEEN_FILTER_BLOCK_WORDS * sizeof(guint64));
+    if (sb_ptr->n_filter_blocks < 1) {
+        sb_ptr->n_filter_blocks = 1;
+    }
+    sb_ptr->filter = calloc(sb_ptr->n_filter_blocks * SEEN_FILTER_BLOCK_WORDS, sizeof(guint64));
+    if (sb_ptr->filter == NULL) {
+        fprintf(stderr, "\nCreation of seen genome filter failed. Exiting.\n");
         exit(1);
     }
-    *bfr = '\0';
+    sb_ptr->max_bytes -= sb_ptr->n_filter_blocks * SEEN_FILTER_BLOCK_WORDS * sizeof(guint64);
+
+    return(sb_ptr);
+}
+
+void delete_seen_budget(struct seen_budget *sb_ptr) {
+    free(sb_ptr->filter);
+    free(sb_ptr);
+    return;
+}
+
+// 64-bit FNV-1a
+guint64 hash_genome_string(char *genome_string) {
+    guint64 hash = 14695981039346656037ULL;
+    while (*genome_string != '\0') {
+        hash = (hash ^ (unsigned char)*(genome_string++)) * 1099511628211ULL;
+    }
+    return(hash);
+}
+
+/*
+    All the bits of a key are in one block, so a lookup reads a single cache
+    line. The block is chosen by the high bits of the hash and the bits within
+    it by 9-bit slices of the remixed hash.
+*/
+void add_to_seen_filter(guint64 hash) {
+    guint64 *block = seen_budget->filter + ((hash >> 32) % seen_budget->n_filter_blocks) * SEEN_FILTER_BLOCK_WORDS;
+    guint64 bits = hash * 0x9E3779B97F4A7C15ULL;
+    int i, bit;
+    for (i=0; i<SEEN_FILTER_N_HASHES; i++) {
+        bit = (bits >> (9*i)) & 511;
+        *(block + bit/64) |= 1ULL << (bit%64);
+    }
+    return;
+}
+
+int is_in_seen_filter(guint64 hash) {
+    guint64 *block = seen_budget->filter + ((hash >> 32) % seen_budget->n_filter_blocks) * SEEN_FILTER_BLOCK_WORDS;
+    guint64 bits = hash * 0x9E3779B97F4A7C15ULL;
+    int i, bit;
+    for (i=0; i<SEEN_FILTER_N_HASHES; i++) {
+        bit = (bits >> (9*i)) & 511;
+        if ((*(block + bit/64) & (1ULL << (bit%64))) == 0) {
+            return(0);
+        }
+    }
+    return(1);
+}
+
+void rebuild_seen_filter() {
+    GHashTableIter iter;
+    gpointer key, value;
+
+    memset(seen_budget->filter, 0, seen_budget->n_filter_blocks * SEEN_FILTER_BLOCK_WORDS * sizeof(guint64));
+    g_hash_table_iter_init(&iter, seen_somatic_genomes);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        add_to_seen_filter(hash_genome_string((char*)key));
+    }
+    return;
+}
 
+void delete_seen_genome(struct seen_genome *sg_ptr) {
     int i;
-    for (i=0; i<g_ptr->depth; i++) {
-        sprintf(
-            bfr2,
-            "%s%d%s",
-            rg_type_to_txt(*(g_ptr->history+i)),
-            *(g_ptr->history_idx+i),
-            (i == g_ptr->depth - 1 ? " " : "-")
-        );
-        strncat(bfr, bfr2, strlen(bfr2));
+    for (i=0; i<sg_ptr->n_points; i++) {
+        free((sg_ptr->points+i)->genome_hist);
     }
+    free(sg_ptr->points);
+    free(sg_ptr);
+    return;
+}
 
-    return(bfr);
+// Estimated bytes of the points of an entry
+long get_seen_genome_size(struct seen_genome *sg_ptr) {
+    long n_bytes = 0;
+    int i;
+    for (i=0; i<sg_ptr->n_points; i++) {
+        n_bytes += strlen((sg_ptr->points+i)->genome_hist) + 1 + sizeof(struct seen_point);
+    }
+    return(n_bytes);
 }
 
-int get_dup_depth_from_genome_history_string(char *genome_hist) {
-    int depth = 0;
-    char bfr[4];
-    char c;
-    int i = 0, j = 0;
-    while (*(genome_hist+i) != '\0') {
-        c = *(genome_hist+i);
-        if (isdigit(c)) {
-            i++;
-            continue;
+/*
+    Returns the detailed history of an expansion of the genome with at most
+    depth events and dup_depth duplicative events, and restrictions among the
+    given ones, or NULL if there is none (or the genome was evicted).
+*/
+char* lookup_seen_genome(char *genome_string, int depth, int dup_depth, guint64 restrictions) {
+    struct seen_genome *sg_ptr;
+    struct seen_point *sp_ptr;
+    int i;
+
+    if (seen_budget != NULL && !is_in_seen_filter(hash_genome_string(genome_string))) {
+        return(NULL);
+    }
+    sg_ptr = (struct seen_genome*)g_hash_table_lookup(seen_somatic_genomes, genome_string);
+    if (sg_ptr == NULL) {
+        return(NULL);
+    }
+    for (i=0; i<sg_ptr->n_points && (sg_ptr->points+i)->depth <= depth; i++) {
+        sp_ptr = sg_ptr->points+i;
+        if (sp_ptr->dup_depth <= dup_depth && (sp_ptr->restrictions & ~restrictions) == 0) {
+            return(sp_ptr->genome_hist);
+        }
+    }
+    return(NULL);
+}
+
+/*
+    Adds the expansion of the genome with the detailed history genome_hist,
+    which the table takes over, to its Pareto front. The expansion must not
+    be dominated by the front. The points it dominates are dropped.
+*/
+void remember_seen_genome(char *genome_string, char *genome_hist, int depth, int dup_depth, guint64 restrictions) {
+    struct seen_genome *sg_ptr = (struct seen_genome*)g_hash_table_lookup(seen_somatic_genomes, genome_string);
+    struct seen_point *sp_ptr;
+    int i, n_kept = 0, new_idx;
+
+    if (sg_ptr == NULL) {
+        sg_ptr = malloc(sizeof(struct seen_genome));
+        if (sg_ptr == NULL) {
+            fprintf(stderr, "\nCreation of seen genome failed. Exiting.\n");
+            exit(1);
+        }
+        sg_ptr->n_points = 0;
+        sg_ptr->points = NULL;
+        g_hash_table_replace(seen_somatic_genomes, g_strdup(genome_string), sg_ptr);
+        if (seen_budget != NULL) {
+            seen_budget->n_bytes += strlen(genome_string) + 1 + SEEN_ENTRY_OVERHEAD;
+            add_to_seen_filter(hash_genome_string(genome_string));
         }
-        else if (c == '-') {
-            bfr[j] = '\0';
-            if      (strcmp(bfr, "td")  == 0) { depth++; }
-            else if (strcmp(bfr, "id")  == 0) { depth++; }
-            else if (strcmp(bfr, "fb")  == 0) { depth++; }
-            else if (strcmp(bfr, "wcg") == 0) { depth++; }
-            else if (strcmp(bfr, "wgd") == 0) { depth++; }
-            j = 0;
+    }
+    if (seen_budget != NULL) {
+        seen_budget->n_bytes -= get_seen_genome_size(sg_ptr);
+    }
+
+    sg_ptr->points = realloc(sg_ptr->points, (sg_ptr->n_points + 1) * sizeof(struct seen_point));
+    if (sg_ptr->points == NULL) {
+        fprintf(stderr, "\nGrowing seen genome front failed. Exiting.\n");
+        exit(1);
+    }
+    for (i=0; i<sg_ptr->n_points; i++) {
+        sp_ptr = sg_ptr->points+i;
+        if (depth <= sp_ptr->depth && dup_depth <= sp_ptr->dup_depth && (restrictions & ~sp_ptr->restrictions) == 0) {
+            free(sp_ptr->genome_hist);
         }
         else {
-            bfr[j++] = c;
+            *(sg_ptr->points + n_kept++) = *sp_ptr;
+        }
+    }
+    new_idx = 0;
+    while (new_idx < n_kept && (sg_ptr->points+new_idx)->depth < depth) {
+        new_idx++;
+    }
+    memmove(sg_ptr->points + new_idx + 1, sg_ptr->points + new_idx, (n_kept - new_idx) * sizeof(struct seen_point));
+    sp_ptr = sg_ptr->points + new_idx;
+    sp_ptr->depth = depth;
+    sp_ptr->dup_depth = dup_depth;
+    sp_ptr->restrictions = restrictions;
+    sp_ptr->genome_hist = genome_hist;
+    sg_ptr->n_points = n_kept + 1;
+
+    if (seen_budget != NULL) {
+        seen_budget->n_bytes += get_seen_genome_size(sg_ptr);
+        if (seen_budget->n_bytes > seen_budget->max_bytes) {
+            evict_seen_genomes();
+        }
+    }
+    return;
+}
+
+/*
+    Evicts the genomes whose shallowest expansion had the most events, then
+    the most duplicative events, until the entries take at most three
+    quarters of the budget.
+*/
+void evict_seen_genomes() {
+    long target_bytes = seen_budget->max_bytes / 4 * 3;
+    GHashTableIter iter;
+    gpointer key, value;
+    struct seen_genome *sg_ptr;
+    int depth, dup_depth;
+
+    if (seen_budget->n_evicted == 0) {
+        fprintf(stderr, "Seen genomes reached their budget, evicting the deepest ones...\n");
+    }
+    for (depth=MAX_DEPTH_NONDUP; depth>=0 && seen_budget->n_bytes > target_bytes; depth--) {
+        for (dup_depth=MAX_DEPTH_DUP; dup_depth>=0 && seen_budget->n_bytes > target_bytes; dup_depth--) {
+            g_hash_table_iter_init(&iter, seen_somatic_genomes);
+            while (seen_budget->n_bytes > target_bytes && g_hash_table_iter_next(&iter, &key, &value)) {
+                sg_ptr = (struct seen_genome*)value;
+                if (sg_ptr->points->depth == depth && sg_ptr->points->dup_depth == dup_depth) {
+                    seen_budget->n_bytes -= strlen((char*)key) + 1 + SEEN_ENTRY_OVERHEAD + get_seen_genome_size(sg_ptr);
+                    seen_budget->n_evicted++;
+                    g_hash_table_iter_remove(&iter);
+                }
+            }
         }
+    }
+    rebuild_seen_filter();
+
+    return;
+}
 
-        i++;
+// Empties the table, keeping the budget
+void forget_seen_genomes() {
+    g_hash_table_remove_all(seen_somatic_genomes);
+    if (reduced_genomes != NULL) {
+        g_hash_table_remove_all(reduced_genomes);
     }
+    if (seen_budget != NULL) {
+        seen_budget->n_bytes = 0;
+        memset(seen_budget->filter, 0, seen_budget->n_filter_blocks * SEEN_FILTER_BLOCK_WORDS * sizeof(guint64));
+    }
+    return;
+}
+/*
+    End functions for the table of seen genomes
+*/
+
 
-    return(depth);
+/*
+    Functions for work units, see struct work_stack
+*/
+// Frees a child that is not handled here
+void discard_batch_child(struct batch_child *bc_ptr) {
+    g_string_free(bc_ptr->unique_genome_string, 1);
+    g_string_free(bc_ptr->cn_string, 1);
+    g_string_free(bc_ptr->rg_string, 1);
+    g_free(bc_ptr->claim_hist);
+    if (bc_ptr->g_ptr != NULL) {
+        delete_genome(bc_ptr->g_ptr);
+    }
+    return;
 }
 
-int get_overall_depth_from_genome_history_string(char *genome_hist) {
-    int depth = 1;
-    char c;
-    int i = 0;
-    while (*(genome_hist+i) != '\0') {
-        c = *(genome_hist+i);
-        if (c == '-') {
-            depth++;
+/*
+    Runs the units handed out by the coordinator on WORKER_LINK until it has
+    no more. A unit is "UNIT <first_child> <last_child> <depth> <claims>"
+    followed by the depth events of the path, each as
+    <rg>,<hist_idx>,<c1_idx>,<c2_idx>,<block_hist_idx>. With a partitioned
+    table of seen genomes, claims has a 'G' or an 'S' for each child, whether
+    the worker giving the children away had been granted it, otherwise it is
+    "-".
+*/
+void run_work_units() {
+    struct rg_event *path;
+    char *message, *c, *claims;
+    int first_child, last_child, depth, n_chars, k;
+    int rg, hist_idx, c1_idx, c2_idx, block_hist_idx;
+
+    WORK_STACK = malloc(sizeof(struct work_stack));
+    if (WORK_STACK == NULL) {
+        fprintf(stderr, "\nCreation of work stack failed. Exiting.\n");
+        exit(1);
+    }
+    WORK_STACK->batches = calloc(MAX_DEPTH_NONDUP + 1, sizeof(struct batch*));
+    WORK_STACK->peer_pfds = malloc((N_WORKERS + 1) * sizeof(struct pollfd));
+    if (WORK_STACK->batches == NULL || WORK_STACK->peer_pfds == NULL) {
+        fprintf(stderr, "\nCreation of work stack batches failed. Exiting.\n");
+        exit(1);
+    }
+
+    while (1) {
+        send_worker_message(WORKER_LINK, "IDLE");
+        message = wait_coordinator_message();
+        while (strcmp(message, "DONATE") == 0) {  // Asked before the coordinator knew this worker was idle
+            send_worker_message(WORKER_LINK, "NONE");
+            g_free(message);
+            message = wait_coordinator_message();
+        }
+        if (strcmp(message, "DONE") == 0) {
+            g_free(message);
+            break;
+        }
+
+        if (sscanf(message, "UNIT %d %d %d %n", &first_child, &last_child, &depth, &n_chars) != 3 || depth < 0 || depth >= MAX_DEPTH_NONDUP) {
+            fprintf(stderr, "\nMalformed work unit '%s'. Exiting.\n", message);
+            exit(1);
+        }
+        c = message + n_chars;
+        n_chars = strcspn(c, " ");
+        claims = (n_chars == 1 && *c == '-' ? NULL : g_strndup(c, n_chars));
+        if (n_chars == 0 || (claims != NULL && n_chars != last_child - first_child)) {
+            fprintf(stderr, "\nMalformed work unit '%s'. Exiting.\n", message);
+            exit(1);
+        }
+        c += n_chars;
+        path = malloc((depth + 1) * sizeof(struct rg_event));
+        if (path == NULL) {
+            fprintf(stderr, "\nCreation of work path failed. Exiting.\n");
+            exit(1);
+        }
+        for (k=0; k<depth; k++) {
+            if (sscanf(c, " %d,%d,%d,%d,%d%n", &rg, &hist_idx, &c1_idx, &c2_idx, &block_hist_idx, &n_chars) != 5 || rg < 0 || rg >= N_RG_TYPES) {
+                fprintf(stderr, "\nMalformed work unit '%s'. Exiting.\n", message);
+                exit(1);
+            }
+            (path+k)->rg = rg;
+            (path+k)->hist_idx = hist_idx;
+            (path+k)->c1_idx = c1_idx;
+            (path+k)->c2_idx = c2_idx;
+            (path+k)->block_hist_idx = block_hist_idx;
+            (path+k)->twin_idx = -1;
+            (path+k)->g_ptr = NULL;
+            c += n_chars;
         }
-        i++;
+        g_free(message);
+
+        WORK_STACK->base_path = path;
+        WORK_STACK->base_depth = depth;
+        WORK_STACK->base_claims = claims;
+        bridge_children(replay_work_path(path, depth), first_child, last_child);
+        free(path);
+        g_free(claims);
     }
 
-    return(depth);
+    free(WORK_STACK->batches);
+    free(WORK_STACK->peer_pfds);
+    free(WORK_STACK);
+    WORK_STACK = NULL;
+    return;
 }
 
-void handle_next_step(struct genome *g_ptr) {
-    char *previous_somatic_genome;
-    char unique_genome_string[2000];
-    int prev_depth, prev_dup_depth;
+// Builds the genome at the end of path from the WT genome
+struct genome* replay_work_path(struct rg_event *path, int depth) {
+    struct genome *g_ptr = create_genome(N_CHRS, IS_DIPLOID);
+    struct genome *child_ptr;
+    GString *genome_string = g_string_new(NULL);
+    int k;
+
+    for (k=0; k<depth; k++) {
+        get_unique_genome_string(g_ptr, genome_string);  // As rendered before being expanded
+        child_ptr = materialize_event(g_ptr, path+k);
+        delete_genome(g_ptr);
+        g_ptr = child_ptr;
+    }
+    get_unique_genome_string(g_ptr, genome_string);
+    g_string_free(genome_string, 1);
 
-    simplify_genome(g_ptr);
-    get_unique_genome_string(g_ptr, unique_genome_string);  // Get the unique genome string of *g_ptr and assign to genome_string_ptr
+    return(g_ptr);
+}
+
+// Answers a request of the coordinator, if any
+void check_work_request() {
+    char *message;
+
+    if (--WORKER_LINK->n_until_check > 0) {
+        return;
+    }
+    WORKER_LINK->n_until_check = WORK_REQUEST_INTERVAL;
+    if (PEER_LINKS != NULL) {
+        serve_peers(NULL, 0);
+    }
+    if (!has_worker_message(WORKER_LINK)) {
+        return;
+    }
+    message = wait_worker_message(WORKER_LINK);
+    if (strcmp(message, "DONATE") != 0) {
+        fprintf(stderr, "\nUnexpected message '%s' from the coordinator. Exiting.\n", message);
+        exit(1);
+    }
+    g_free(message);
+    donate_work();
+
+    return;
+}
 
-    if (g_hash_table_contains(seen_somatic_genomes, unique_genome_string)) {
-        previous_somatic_genome = (char*)g_hash_table_lookup(seen_somatic_genomes, unique_genome_string);
-        prev_depth = get_overall_depth_from_genome_history_string(previous_somatic_genome);
-        prev_dup_depth = get_dup_depth_from_genome_history_string(previous_somatic_genome);
+/*
+    Gives the later half of the children left in the shallowest batch that
+    has some, at least one, to the coordinator as a unit, or tells it that
+    there are none.
+*/
+void donate_work() {
+    struct batch *b_ptr = NULL;
+    struct batch *path_b_ptr;
+    struct rg_event *e_ptr;
+    int depth, k, first_child;
+
+    for (depth=WORK_STACK->base_depth; depth<MAX_DEPTH_NONDUP && *(WORK_STACK->batches+depth) != NULL; depth++) {
+        if ((*(WORK_STACK->batches+depth))->next_child < (*(WORK_STACK->batches+depth))->end_child) {
+            b_ptr = *(WORK_STACK->batches+depth);
+            break;
+        }
+    }
+    if (b_ptr == NULL) {
+        send_worker_message(WORKER_LINK, "NONE");
+        return;
+    }
 
-        // Previous genome with the same configuration as the current one was reached with fewer events?
-        if (prev_depth <= g_ptr->depth && prev_dup_depth <= g_ptr->dup_depth) {
-            print_genome(g_ptr, previous_somatic_genome);
-            delete_genome(g_ptr);  // Need to delete here since not passing to bridge().
+    first_child = b_ptr->end_child - (b_ptr->end_child - b_ptr->next_child + 1) / 2;
+    GString *unit = g_string_new(NULL);
+    g_string_printf(unit, "UNIT %d %d %d ", first_child, b_ptr->end_child, depth);
+    for (k=first_child; k<b_ptr->end_child; k++) {
+        if (PEER_LINKS == NULL) {
+            g_string_append_c(unit, '-');
+            break;
+        }
+        g_string_append_c(unit, ((b_ptr->children+k)->claim_state == CLAIM_GRANTED ? 'G' : 'S'));
+    }
+    for (k=0; k<depth; k++) {
+        if (k < WORK_STACK->base_depth) {
+            e_ptr = WORK_STACK->base_path+k;
         }
         else {
-            print_genome(g_ptr, unique_genome_string);
-            g_hash_table_replace(seen_somatic_genomes, g_strdup(unique_genome_string), get_detailed_history(g_ptr));  // No need to free this since need to keep in memory
-            bridge(g_ptr);
+            path_b_ptr = *(WORK_STACK->batches+k);
+            e_ptr = (path_b_ptr->children + path_b_ptr->next_child - 1)->e_ptr;  // Child being expanded
         }
+        g_string_append_printf(unit, " %d,%d,%d,%d,%d", e_ptr->rg, e_ptr->hist_idx, e_ptr->c1_idx, e_ptr->c2_idx, e_ptr->block_hist_idx);
     }
-    else {
-        print_genome(g_ptr, unique_genome_string);
-        g_hash_table_insert(seen_somatic_genomes, g_strdup(unique_genome_string), get_detailed_history(g_ptr));  // No need to free this since need to keep in memory
-        bridge(g_ptr);
+    send_worker_message(WORKER_LINK, unit->str);
+    g_string_free(unit, 1);
+
+    for (k=first_child; k<b_ptr->end_child; k++) {
+        discard_batch_child(b_ptr->children+k);
+    }
+    b_ptr->end_child = first_child;
+
+    return;
+}
+
+// Next message of the coordinator, answering the other workers in the meantime
+char* wait_coordinator_message() {
+    char *message;
+
+    if (PEER_LINKS == NULL) {
+        return(wait_worker_message(WORKER_LINK));
+    }
+    while ((message = next_worker_message(WORKER_LINK)) == NULL) {
+        if (serve_peers(WORKER_LINK, -1) && !receive_worker_bytes(WORKER_LINK)) {
+            fprintf(stderr, "\nWorker link closed unexpectedly. Exiting.\n");
+            exit(1);
+        }
     }
+    return(message);
 }
+/*
+    End functions for work units
+*/
 
-void handle_next_step_after_fold_back(struct genome *g_ptr) {
-    char *previous_somatic_genome;
-    char unique_genome_string[2000];
-    int prev_depth, prev_dup_depth;
 
-    simplify_genome(g_ptr);
-    get_unique_genome_string(g_ptr, unique_genome_string);  // Get the unique genome string of *g_ptr and assign to genome_string_ptr
+/*
+    Functions for the table of seen genomes partitioned between workers, see
+    run_workers()
+*/
+int get_seen_owner(char *genome_string) {
+    return(hash_genome_string(genome_string) % N_WORKERS);
+}
 
-    if (g_hash_table_contains(seen_somatic_genomes, unique_genome_string)) {
-        previous_somatic_genome = (char*)g_hash_table_lookup(seen_somatic_genomes, unique_genome_string);
-        prev_depth = get_overall_depth_from_genome_history_string(previous_somatic_genome);
-        prev_dup_depth = get_dup_depth_from_genome_history_string(previous_somatic_genome);
+/*
+    In the owner of the genome, claims its expansion with the detailed
+    history genome_hist, as claim_shared_genome() does in the shared set:
+    returns NULL if it is to be expanded by the claimant, and remembers it,
+    otherwise the history of the earlier expansion, in seen_somatic_genomes.
+*/
+char* claim_seen_genome(char *genome_string, char *genome_hist, int depth, int dup_depth, guint64 restrictions) {
+    char *previous_somatic_genome = lookup_seen_genome(genome_string, depth, dup_depth, restrictions);
+    if (previous_somatic_genome == NULL) {
+        remember_seen_genome(genome_string, g_strdup(genome_hist), depth, dup_depth, restrictions);
+    }
+    return(previous_somatic_genome);
+}
 
-        if (prev_depth <= g_ptr->depth && prev_dup_depth <= g_ptr->dup_depth) {
-            print_genome(g_ptr, previous_somatic_genome);
+/*
+    Claims the children next_child to end_child - 1 of a batch from the
+    owners of their genomes, in one message per owner, and waits for the
+    answers, serving the claims of the other workers in the meantime. The
+    subtrees of their siblings are deeper, so claiming the children before
+    expanding any of them does not change the answers, but the children are
+    already seen in those subtrees. The children granted to a worker that
+    gave them away, marked 'G' in granted if any, are not claimed again,
+    since other workers may already have been told to refer to them.
+*/
+void claim_batch_children(struct batch *b_ptr, char *granted) {
+    struct genome *parent_ptr = b_ptr->g_ptr;
+    struct batch_child *bc_ptr;
+    struct worker_link *wl_ptr;
+    GString *message = g_string_new(NULL);
+    char *genome_hist, *previous_somatic_genome;
+    int depth = parent_ptr->depth + 1;
+    int dup_depth, owner, i, n_pending = 0;
+    guint64 restrictions;
+
+    for (i=b_ptr->next_child; i<b_ptr->end_child; i++) {
+        bc_ptr = b_ptr->children+i;
+        if (granted != NULL && *(granted + i - b_ptr->next_child) == 'G') {
+            bc_ptr->claim_state = CLAIM_GRANTED;
+            continue;
+        }
+        dup_depth = parent_ptr->dup_depth + rg_type_is_dup(bc_ptr->e_ptr->rg);
+        restrictions = get_child_restrictions(parent_ptr, bc_ptr->e_ptr->rg);
+        genome_hist = get_child_detailed_history(parent_ptr, bc_ptr->e_ptr);
+        owner = get_seen_owner(bc_ptr->unique_genome_string->str);
+        if (owner == WORKER_IDX) {
+            previous_somatic_genome = claim_seen_genome(bc_ptr->unique_genome_string->str, genome_hist, depth, dup_depth, restrictions);
+            bc_ptr->claim_state = (previous_somatic_genome == NULL ? CLAIM_GRANTED : CLAIM_SEEN);
+            bc_ptr->claim_hist = (previous_somatic_genome == NULL ? NULL : g_strdup(previous_somatic_genome));
         }
         else {
-            print_genome(g_ptr, unique_genome_string);
-            g_hash_table_replace(seen_somatic_genomes, g_strdup(unique_genome_string), get_detailed_history(g_ptr));  // No need to free this since need to keep in memory
-            if (g_ptr->depth < MAX_DEPTH_NONDUP) {
-                enum_tel_break(g_ptr);
-                if (g_ptr->dup_depth < MAX_DEPTH_DUP) {
-                    enum_fbs(g_ptr);
-                }
-            }
+            wl_ptr = *(PEER_LINKS+owner);
+            g_string_printf(message, "CLAIM %d %d %lx %s %s", depth, dup_depth, (unsigned long)restrictions, bc_ptr->unique_genome_string->str, genome_hist);
+            queue_worker_message(wl_ptr, message->str);
+            g_queue_push_tail(wl_ptr->claims, bc_ptr);
+            bc_ptr->claim_state = CLAIM_PENDING;
+            n_pending++;
         }
+        g_free(genome_hist);
     }
-    else {
-        print_genome(g_ptr, unique_genome_string);
-        g_hash_table_insert(seen_somatic_genomes, g_strdup(unique_genome_string), get_detailed_history(g_ptr));  // No need to free this since need to keep in memory
-        if (g_ptr->depth < MAX_DEPTH_NONDUP) {
-            enum_tel_break(g_ptr);
-            if (g_ptr->dup_depth < MAX_DEPTH_DUP) {
-                enum_fbs(g_ptr);
+    g_string_free(message, 1);
+
+    while (n_pending > 0) {
+        serve_peers(NULL, -1);
+        n_pending = 0;
+        for (i=0; i<N_WORKERS; i++) {
+            n_pending += (*(PEER_LINKS+i) != NULL && !g_queue_is_empty((*(PEER_LINKS+i))->claims));
+        }
+    }
+
+    return;
+}
+
+/*
+    Sends what is queued for the other workers, and handles what they sent,
+    waiting up to timeout milliseconds for something to happen (-1 for no
+    limit) on their links or on wake_ptr, if not NULL. Returns whether
+    wake_ptr has something to read.
+*/
+int serve_peers(struct worker_link *wake_ptr, int timeout) {
+    struct pollfd *pfds = WORK_STACK->peer_pfds;
+    struct worker_link *wl_ptr;
+    int i;
+
+    for (i=0; i<N_WORKERS; i++) {
+        wl_ptr = *(PEER_LINKS+i);
+        (pfds+i)->fd = -1;  // Ignored by poll()
+        (pfds+i)->revents = 0;
+        if (wl_ptr != NULL) {
+            flush_worker_messages(wl_ptr);
+            (pfds+i)->fd = wl_ptr->fd;
+            (pfds+i)->events = POLLIN | (wl_ptr->out->len > 0 ? POLLOUT : 0);
+        }
+    }
+    (pfds+N_WORKERS)->fd = (wake_ptr == NULL ? -1 : wake_ptr->fd);
+    (pfds+N_WORKERS)->events = POLLIN;
+    (pfds+N_WORKERS)->revents = 0;
+    if (poll(pfds, (unsigned int)N_WORKERS + 1, timeout) < 0 && errno != EINTR) {
+        fprintf(stderr, "\nWaiting for the other workers failed. Exiting.\n");
+        exit(1);
+    }
+
+    for (i=0; i<N_WORKERS; i++) {
+        wl_ptr = *(PEER_LINKS+i);
+        if (wl_ptr == NULL || ((pfds+i)->revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+            continue;
+        }
+        if (!receive_worker_bytes(wl_ptr)) {  // Done with the enumeration, unless it had claims to answer
+            if (!g_queue_is_empty(wl_ptr->claims)) {
+                fprintf(stderr, "\nWorker %d stopped before the end. Exiting.\n", i);
+                exit(1);
             }
+            delete_worker_link(wl_ptr);
+            *(PEER_LINKS+i) = NULL;
+            continue;
         }
+        handle_peer_messages(wl_ptr);
+        flush_worker_messages(wl_ptr);
     }
 
-    delete_genome(g_ptr);
+    return(((pfds+N_WORKERS)->revents & (POLLIN | POLLHUP | POLLERR)) != 0);
+}
+
+/*
+    Answers the claims received from another worker, "CLAIM <depth>
+    <dup_depth> <restrictions in hex> <genome_string> <detailed_history>",
+    with "GRANTED" or "SEEN <detailed_history>", and records its answers to
+    the claims of this worker, which come in the order of the claims.
+*/
+void handle_peer_messages(struct worker_link *wl_ptr) {
+    struct batch_child *bc_ptr;
+    char *message, *genome_hist, *previous_somatic_genome, *answer;
+    int depth, dup_depth, n_chars;
+    unsigned long restrictions;
+
+    while ((message = next_worker_message(wl_ptr)) != NULL) {
+        if (strncmp(message, "CLAIM ", 6) == 0) {
+            if (sscanf(message, "CLAIM %d %d %lx %n", &depth, &dup_depth, &restrictions, &n_chars) != 3 || (genome_hist = strchr(message + n_chars, ' ')) == NULL) {
+                fprintf(stderr, "\nMalformed claim '%s'. Exiting.\n", message);
+                exit(1);
+            }
+            *(genome_hist++) = '\0';
+            previous_somatic_genome = claim_seen_genome(message + n_chars, genome_hist, depth, dup_depth, restrictions);
+            if (previous_somatic_genome == NULL) {
+                queue_worker_message(wl_ptr, "GRANTED");
+            }
+            else {
+                answer = g_strdup_printf("SEEN %s", previous_somatic_genome);
+                queue_worker_message(wl_ptr, answer);
+                g_free(answer);
+            }
+        }
+        else if ((strcmp(message, "GRANTED") == 0 || strncmp(message, "SEEN ", 5) == 0) && !g_queue_is_empty(wl_ptr->claims)) {
+            bc_ptr = (struct batch_child*)g_queue_pop_head(wl_ptr->claims);
+            if (*message == 'G') {
+                bc_ptr->claim_state = CLAIM_GRANTED;
+            }
+            else {
+                bc_ptr->claim_state = CLAIM_SEEN;
+                bc_ptr->claim_hist = g_strdup(message + 5);
+            }
+        }
+        else {
+            fprintf(stderr, "\nUnexpected message '%s' from another worker. Exiting.\n", message);
+            exit(1);
+        }
+        g_free(message);
+    }
+    return;
 }
+/*
+    End functions for the table of seen genomes partitioned between workers
+*/
 /*
     End helper functions
 */
@@ -212,7 +1961,7 @@ void enum_dels(struct genome *g_ptr) {
     /* Declare reusable variables */
     int b1, b2;
     struct genome *new_g_ptr;
-    int *b1_seg_indexes, *b2_seg_indexes, b1_seg_indexes_ln, b2_seg_indexes_ln;
+    struct breakpoint *c_bps, *bp1, *bp2;
     int c_idx;
 
     /*
@@ -223,64 +1972,48 @@ void enum_dels(struct genome *g_ptr) {
     */
 
     for (c_idx = 0; c_idx < g_ptr->n_chrs; c_idx++) {
+        if (is_twin_block(g_ptr, DEL, c_idx, -1, &hist_idx)) {
+            continue;
+        }
+        c_bps = get_chr_breakpoints(g_ptr, c_idx);
         for (b1 = 0; b1 < (*(g_ptr->root_chr+c_idx))->n_segs; b1++) {
+            bp1 = c_bps + b1;
             /* First case: both breakpoints at exactly same segment
                In this case the affected segment is broken into three pieces. */
             b2 = b1;
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, DEL, hist_idx++);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, DEL, hist_idx++);
+
+                /*
+                    Splice affected segment into three.
+                    Then delete the centre segment.
+                    Then splice the remaining similar segments.
+                */
+                splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), b1+1, b1+1);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
 
-            b1_seg_indexes_ln = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "\nFailed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
+                handle_next_step(new_g_ptr);
             }
-            memcpy(b1_seg_indexes, (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-
-            /*
-                Splice affected segment into three.
-                Then delete the centre segment.
-                Then splice the remaining similar segments.
-            */
-            splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), b1+1, b1+1);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-            free(b1_seg_indexes);
-
-            handle_next_step(new_g_ptr);
 
 
             /* Next, when the two breakpoints occur at two physically different DNA segments */
             int two_segments_look_identical;
             int delete_from, delete_to;
             for (b2 = b1+1; b2 < (*(g_ptr->root_chr+c_idx))->n_segs; b2++) {
+                bp2 = c_bps + b2;
                 /* Do the two affected segments have the same seg_indexes? */
-                two_segments_look_identical = int_array_cmp(
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->times_divided,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->seg_indexes
-                );
+                two_segments_look_identical = (bp1->seg_class == bp2->seg_class);
                 if (two_segments_look_identical) {
                     /* If the two segments have the same indexes,
                        there are two ways the two breakpoints can occur
                        in the segment. */
 
-                    b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-                    b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-                    if (b1_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
                     /* Option 1: looking at plus strand, s1 < s2 at the segment.
                        Segment in question is broken into following:
                           b1  b2
@@ -288,24 +2021,26 @@ void enum_dels(struct genome *g_ptr) {
                        === === ===>
                     */
 
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, DEL, hist_idx++);
-
-                    /*
-                        Splice the two affected segments.
-                        Then deleted everything in between.
-                        Then splice the remaining similar segments.
-                    */
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
-                    delete_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 1 : b1 + 2;  /* After splicing, segment at b1 becomes
-                                                                                                               three segments. */
-                    delete_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 1 : 0);  /* 2 + b2 comes from the fact that segment at
-                                                                                                               b1 has now been split from one to 3 segments. */
-                    delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), delete_from, delete_to);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 3);
-
-                    handle_next_step(new_g_ptr);
+                    if (!skip_events(&hist_idx, 1)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, DEL, hist_idx++);
+
+                        /*
+                            Splice the two affected segments.
+                            Then deleted everything in between.
+                            Then splice the remaining similar segments.
+                        */
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
+                        delete_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 1 : b1 + 2;  /* After splicing, segment at b1 becomes
+                                                                                                                   three segments. */
+                        delete_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 1 : 0);  /* 2 + b2 comes from the fact that segment at
+                                                                                                                   b1 has now been split from one to 3 segments. */
+                        delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), delete_from, delete_to);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 3);
+
+                        handle_next_step(new_g_ptr);
+                    }
 
                     
                     /* Option 2: looking at plus strand, s1 > s2 at the segment.
@@ -315,61 +2050,42 @@ void enum_dels(struct genome *g_ptr) {
                        === === ===>
                     */
 
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, DEL, hist_idx++);
-
-                    /* Same story as above. */
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
-                    delete_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 2 : b1 + 1;  /* After splicing, segment at b1 becomes
-                                                                                                               three segments. */
-                    delete_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 0 : 1);  /* 2 + b2 comes from the fact that segment at
-                                                                                                               b1 has now been split from one to 3 segments. */
-                    delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), delete_from, delete_to);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 3);
-
-                    handle_next_step(new_g_ptr);
-
-                    free(b1_seg_indexes);
+                    if (!skip_events(&hist_idx, 1)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, DEL, hist_idx++);
+
+                        /* Same story as above. */
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
+                        delete_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 2 : b1 + 1;  /* After splicing, segment at b1 becomes
+                                                                                                                   three segments. */
+                        delete_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 0 : 1);  /* 2 + b2 comes from the fact that segment at
+                                                                                                                   b1 has now been split from one to 3 segments. */
+                        delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), delete_from, delete_to);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 3);
+
+                        handle_next_step(new_g_ptr);
+                    }
                 }
                 else {
-                    /* If the two broken segments have different indexes,
-                       simply break them and splice intervening segments out. */
-
-                    /* But first, let's store the identities of the affected segments first */
-                    b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-                    b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-                    if (b1_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-                    b2_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->times_divided;
-                    b2_seg_indexes = malloc(b2_seg_indexes_ln * sizeof(int));
-                    if (b2_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b2_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b2_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->seg_indexes, b2_seg_indexes_ln * sizeof(int));
-
-                    
-                    /* Finally, let's break segments */
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, DEL, hist_idx++);
-
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+1, 2);
-                    delete_from = b1 + 1;
-                    delete_to = 1 + b2;
-                    delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), delete_from, delete_to);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 2);
-                    splice_all_segs(new_g_ptr, b2_seg_indexes, b2_seg_indexes_ln, 2);
-
-                    handle_next_step(new_g_ptr);
+                    /* If the two broken segments have different indexes,
+                       simply break them and splice intervening segments out. */
 
-                    free(b1_seg_indexes);
-                    free(b2_seg_indexes);
+                    /* Finally, let's break segments */
+                    if (!skip_events(&hist_idx, 1)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, DEL, hist_idx++);
+
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+1, 2);
+                        delete_from = b1 + 1;
+                        delete_to = 1 + b2;
+                        delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), delete_from, delete_to);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 2);
+                        splice_breakpoint_copies(new_g_ptr, bp2, 2);
+
+                        handle_next_step(new_g_ptr);
+                    }
                 }
             }
         }  // for b1
@@ -387,7 +2103,7 @@ void enum_tds(struct genome *g_ptr) {
     int b1, b2;
     struct genome *new_g_ptr;
     struct chromosome *segs_to_be_dup;
-    int *b1_seg_indexes, *b2_seg_indexes, b1_seg_indexes_ln, b2_seg_indexes_ln;
+    struct breakpoint *c_bps, *bp1, *bp2;
     int c_idx;
 
     /*
@@ -398,65 +2114,50 @@ void enum_tds(struct genome *g_ptr) {
     */
 
     for (c_idx = 0; c_idx < g_ptr->n_chrs; c_idx++) {
+        if (is_twin_block(g_ptr, TD, c_idx, -1, &hist_idx)) {
+            continue;
+        }
+        c_bps = get_chr_breakpoints(g_ptr, c_idx);
         for (b1 = 0; b1 < (*(g_ptr->root_chr+c_idx))->n_segs; b1++) {
+            bp1 = c_bps + b1;
             /* First case: both breakpoints at exactly same segment
                In this case the affected segment is broken into three pieces. */
             b2 = b1;
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, TD, hist_idx++);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, TD, hist_idx++);
+
+                /*
+                    Splice affected segment into three.
+                    Then yank the centre segment and insert it after the yanked position.
+                    Then splice the remaining similar segments.
+                */
+                splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), b1+1, b1+1);
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, b1+2);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
+                delete_chromosome(segs_to_be_dup);
 
-            b1_seg_indexes_ln = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "\nFailed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
+                handle_next_step(new_g_ptr);
             }
-            memcpy(b1_seg_indexes, (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-            /*
-                Splice affected segment into three.
-                Then yank the centre segment and insert it after the yanked position.
-                Then splice the remaining similar segments.
-            */
-            splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-            segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), b1+1, b1+1);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, b1+2);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-            delete_chromosome(segs_to_be_dup);
-            free(b1_seg_indexes);
-
-            handle_next_step(new_g_ptr);
 
 
             // Next, when the two breakpoints occur at two physically different DNA segments
             int two_segments_look_identical;
             int yank_from, yank_to;
             for (b2 = b1+1; b2 < (*(g_ptr->root_chr+c_idx))->n_segs; b2++) {
+                bp2 = c_bps + b2;
                 /* Do the two affected segments have the same seg_indexes? */
-                two_segments_look_identical = int_array_cmp(
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->times_divided,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->seg_indexes
-                );
+                two_segments_look_identical = (bp1->seg_class == bp2->seg_class);
                 if (two_segments_look_identical) {
                     /* If the two segments have the same indexes,
                        there are two ways the two breakpoints can occur
                        in the segment. */
 
-                    b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-                    b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-                    if (b1_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
                     /* Option 1: looking at plus strand, s1 < s2 at the segment.
                        Segment in question is broken into following:
                           b1  b2
@@ -464,26 +2165,28 @@ void enum_tds(struct genome *g_ptr) {
                        === === ===>
                     */
 
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, TD, hist_idx++);
-
-                    /*
-                        Splice the two affected segments.
-                        Then deleted everything in between.
-                        Then splice the remaining similar segments.
-                    */
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
-                    yank_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 1 : b1 + 2;  /* After splicing, segment at b1 becomes
-                                                                                                               three segments. */
-                    yank_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 1 : 0);  /* 2 + b2 comes from the fact that segment at
-                                                                                                               b1 has now been split from one to 3 segments. */
-                    segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
-                    insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 3);
-                    delete_chromosome(segs_to_be_dup);
-
-                    handle_next_step(new_g_ptr);
+                    if (!skip_events(&hist_idx, 1)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, TD, hist_idx++);
+
+                        /*
+                            Splice the two affected segments.
+                            Then deleted everything in between.
+                            Then splice the remaining similar segments.
+                        */
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
+                        yank_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 1 : b1 + 2;  /* After splicing, segment at b1 becomes
+                                                                                                                   three segments. */
+                        yank_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 1 : 0);  /* 2 + b2 comes from the fact that segment at
+                                                                                                                   b1 has now been split from one to 3 segments. */
+                        segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
+                        insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 3);
+                        delete_chromosome(segs_to_be_dup);
+
+                        handle_next_step(new_g_ptr);
+                    }
 
                     
                     /* Option 2: looking at plus strand, s1 > s2 at the segment.
@@ -493,65 +2196,46 @@ void enum_tds(struct genome *g_ptr) {
                        === === ===>
                     */
 
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, TD, hist_idx++);
-
-                    /* Same story as above. */
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
-                    yank_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 2 : b1 + 1;  /* After splicing, segment at b1 becomes
-                                                                                                               three segments. */
-                    yank_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 0 : 1);  /* 2 + b2 comes from the fact that segment at
-                                                                                                               b1 has now been split from one to 3 segments. */
-                    segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
-                    insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 3);
-                    delete_chromosome(segs_to_be_dup);
-
-                    handle_next_step(new_g_ptr);
-
-                    free(b1_seg_indexes);
+                    if (!skip_events(&hist_idx, 1)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, TD, hist_idx++);
+
+                        /* Same story as above. */
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
+                        yank_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 2 : b1 + 1;  /* After splicing, segment at b1 becomes
+                                                                                                                   three segments. */
+                        yank_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 0 : 1);  /* 2 + b2 comes from the fact that segment at
+                                                                                                                   b1 has now been split from one to 3 segments. */
+                        segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
+                        insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 3);
+                        delete_chromosome(segs_to_be_dup);
+
+                        handle_next_step(new_g_ptr);
+                    }
                 }
                 else {
                     /* If the two broken segments have different indexes,
                        simply break them and splice intervening segments out. */
 
-                    /* But first, let's store the identities of the affected segments first */
-                    b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-                    b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-                    if (b1_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-                    b2_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->times_divided;
-                    b2_seg_indexes = malloc(b2_seg_indexes_ln * sizeof(int));
-                    if (b2_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b2_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b2_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->seg_indexes, b2_seg_indexes_ln * sizeof(int));
-
-                    
                     /* Finally, let's break segments */
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, TD, hist_idx++);
-
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+1, 2);
-                    yank_from = b1 + 1;
-                    yank_to = 1 + b2;
-                    segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
-                    insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 2);
-                    splice_all_segs(new_g_ptr, b2_seg_indexes, b2_seg_indexes_ln, 2);
-                    delete_chromosome(segs_to_be_dup);
-
-                    handle_next_step(new_g_ptr);
-
-                    free(b1_seg_indexes);
-                    free(b2_seg_indexes);
+                    if (!skip_events(&hist_idx, 1)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, TD, hist_idx++);
+
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+1, 2);
+                        yank_from = b1 + 1;
+                        yank_to = 1 + b2;
+                        segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
+                        insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 2);
+                        splice_breakpoint_copies(new_g_ptr, bp2, 2);
+                        delete_chromosome(segs_to_be_dup);
+
+                        handle_next_step(new_g_ptr);
+                    }
                 }
             }
         }  // for each b1
@@ -567,7 +2251,7 @@ void enum_invs(struct genome *g_ptr) {
     int hist_idx = 0;
     int b1, b2;
     struct genome *new_g_ptr;
-    int *b1_seg_indexes, *b2_seg_indexes, b1_seg_indexes_ln, b2_seg_indexes_ln;
+    struct breakpoint *c_bps, *bp1, *bp2;
     int c_idx;
 
     /*
@@ -578,63 +2262,48 @@ void enum_invs(struct genome *g_ptr) {
     */
 
     for (c_idx = 0; c_idx < g_ptr->n_chrs; c_idx++) {
+        if (is_twin_block(g_ptr, INV, c_idx, -1, &hist_idx)) {
+            continue;
+        }
+        c_bps = get_chr_breakpoints(g_ptr, c_idx);
         for (b1 = 0; b1 < (*(g_ptr->root_chr+c_idx))->n_segs; b1++) {
+            bp1 = c_bps + b1;
             /* First case: both breakpoints at exactly same segment
                In this case the affected segment is broken into three pieces. */
             b2 = b1;
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, INV, hist_idx++);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, INV, hist_idx++);
+
+                /*
+                    Splice affected segment into three.
+                    Then yank the centre segment and insert it after the yanked position.
+                    Then splice the remaining similar segments.
+                */
+                splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                invert_segs_in_chr(*(new_g_ptr->root_chr+c_idx), b1+1, b1+1);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
 
-            b1_seg_indexes_ln = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "\nFailed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
+                handle_next_step(new_g_ptr);
             }
-            memcpy(b1_seg_indexes, (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-            /*
-                Splice affected segment into three.
-                Then yank the centre segment and insert it after the yanked position.
-                Then splice the remaining similar segments.
-            */
-            splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-            invert_segs_in_chr(*(new_g_ptr->root_chr+c_idx), b1+1, b1+1);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-            free(b1_seg_indexes);
-
-            handle_next_step(new_g_ptr);
 
 
             // Next, when the two breakpoints occur at two physically different DNA segments
             int two_segments_look_identical;
             int inv_from, inv_to;
             for (b2 = b1+1; b2 < (*(g_ptr->root_chr+c_idx))->n_segs; b2++) {
+                bp2 = c_bps + b2;
                 /* Do the two affected segments have the same seg_indexes? */
-                two_segments_look_identical = int_array_cmp(
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->times_divided,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->seg_indexes
-                );
+                two_segments_look_identical = (bp1->seg_class == bp2->seg_class);
                 if (two_segments_look_identical) {
                     /* If the two segments have the same indexes,
                        there are two ways the two breakpoints can occur
                        in the segment. */
 
-                    b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-                    b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-                    if (b1_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
                     /* Option 1: looking at plus strand, s1 < s2 at the segment.
                        Segment in question is broken into following:
                           b1  b2
@@ -642,24 +2311,26 @@ void enum_invs(struct genome *g_ptr) {
                        === === ===>
                     */
 
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, INV, hist_idx++);
-
-                    /*
-                        Splice the two affected segments.
-                        Then deleted everything in between.
-                        Then splice the remaining similar segments.
-                    */
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
-                    inv_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 1 : b1 + 2;  /* After splicing, segment at b1 becomes
-                                                                                                               three segments. */
-                    inv_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 1 : 0);  /* 2 + b2 comes from the fact that segment at
-                                                                                                               b1 has now been split from one to 3 segments. */
-                    invert_segs_in_chr(*(new_g_ptr->root_chr+c_idx), inv_from, inv_to);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 3);
-
-                    handle_next_step(new_g_ptr);
+                    if (!skip_events(&hist_idx, 1)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, INV, hist_idx++);
+
+                        /*
+                            Splice the two affected segments.
+                            Then deleted everything in between.
+                            Then splice the remaining similar segments.
+                        */
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
+                        inv_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 1 : b1 + 2;  /* After splicing, segment at b1 becomes
+                                                                                                                   three segments. */
+                        inv_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 1 : 0);  /* 2 + b2 comes from the fact that segment at
+                                                                                                                   b1 has now been split from one to 3 segments. */
+                        invert_segs_in_chr(*(new_g_ptr->root_chr+c_idx), inv_from, inv_to);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 3);
+
+                        handle_next_step(new_g_ptr);
+                    }
 
                     
                     /* Option 2: looking at plus strand, s1 > s2 at the segment.
@@ -669,61 +2340,42 @@ void enum_invs(struct genome *g_ptr) {
                        === === ===>
                     */
 
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, INV, hist_idx++);
-
-                    /* Same story as above. */
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
-                    inv_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 2 : b1 + 1;  /* After splicing, segment at b1 becomes
-                                                                                                               three segments. */
-                    inv_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 0 : 1);  /* 2 + b2 comes from the fact that segment at
-                                                                                                               b1 has now been split from one to 3 segments. */
-                    invert_segs_in_chr(*(new_g_ptr->root_chr+c_idx), inv_from, inv_to);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 3);
-
-                    handle_next_step(new_g_ptr);
-
-                    free(b1_seg_indexes);
+                    if (!skip_events(&hist_idx, 1)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, INV, hist_idx++);
+
+                        /* Same story as above. */
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
+                        inv_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 2 : b1 + 1;  /* After splicing, segment at b1 becomes
+                                                                                                                   three segments. */
+                        inv_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 0 : 1);  /* 2 + b2 comes from the fact that segment at
+                                                                                                                   b1 has now been split from one to 3 segments. */
+                        invert_segs_in_chr(*(new_g_ptr->root_chr+c_idx), inv_from, inv_to);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 3);
+
+                        handle_next_step(new_g_ptr);
+                    }
                 }
                 else {
                     /* If the two broken segments have different indexes,
                        simply break them and splice intervening segments out. */
 
-                    /* But first, let's store the identities of the affected segments first */
-                    b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-                    b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-                    if (b1_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-                    b2_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->times_divided;
-                    b2_seg_indexes = malloc(b2_seg_indexes_ln * sizeof(int));
-                    if (b2_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b2_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b2_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->seg_indexes, b2_seg_indexes_ln * sizeof(int));
-
-                    
                     /* Finally, let's break segments */
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, INV, hist_idx++);
-
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+1, 2);
-                    inv_from = b1 + 1;
-                    inv_to = 1 + b2;
-                    invert_segs_in_chr(*(new_g_ptr->root_chr+c_idx), inv_from, inv_to);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 2);
-                    splice_all_segs(new_g_ptr, b2_seg_indexes, b2_seg_indexes_ln, 2);
-
-                    handle_next_step(new_g_ptr);
-
-                    free(b1_seg_indexes);
-                    free(b2_seg_indexes);
+                    if (!skip_events(&hist_idx, 1)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, INV, hist_idx++);
+
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+1, 2);
+                        inv_from = b1 + 1;
+                        inv_to = 1 + b2;
+                        invert_segs_in_chr(*(new_g_ptr->root_chr+c_idx), inv_from, inv_to);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 2);
+                        splice_breakpoint_copies(new_g_ptr, bp2, 2);
+
+                        handle_next_step(new_g_ptr);
+                    }
                 }
             }
         }  // for each b1
@@ -741,7 +2393,7 @@ void enum_inv_dups(struct genome *g_ptr) {
     int b1, b2;
     struct genome *new_g_ptr, *new_g_ptr2;
     struct chromosome *segs_to_be_dup;
-    int *b1_seg_indexes, *b2_seg_indexes, b1_seg_indexes_ln, b2_seg_indexes_ln;
+    struct breakpoint *c_bps, *bp1, *bp2;
     int c_idx;
 
     /*
@@ -752,80 +2404,64 @@ void enum_inv_dups(struct genome *g_ptr) {
     */
 
     for (c_idx = 0; c_idx < g_ptr->n_chrs; c_idx++) {
+        if (is_twin_block(g_ptr, INV_DUP, c_idx, -1, &hist_idx)) {
+            continue;
+        }
+        c_bps = get_chr_breakpoints(g_ptr, c_idx);
         for (b1 = 0; b1 < (*(g_ptr->root_chr+c_idx))->n_segs; b1++) {
+            bp1 = c_bps + b1;
             /* First case: both breakpoints at exactly same segment
                In this case the affected segment is broken into three pieces. */
             b2 = b1;
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, INV_DUP, hist_idx++);
-            new_g_ptr2 = copy_genome(g_ptr);
-            make_history(new_g_ptr2, INV_DUP, hist_idx++);
-
-            b1_seg_indexes_ln = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "\nFailed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
-            }
-            memcpy(b1_seg_indexes, (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
+            if (!skip_events(&hist_idx, 2)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, INV_DUP, hist_idx++);
+                new_g_ptr2 = copy_genome(g_ptr);
+                make_history(new_g_ptr2, INV_DUP, hist_idx++);
+
+                /*
+                    Splice affected segment into three.
+                    Then yank the centre segment and insert it after the yanked position.
+                    Then splice the remaining similar segments.
+                */
+                splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), b1+1, b1+1);
+                invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs-1);
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, b1+2);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
 
-            /*
-                Splice affected segment into three.
-                Then yank the centre segment and insert it after the yanked position.
-                Then splice the remaining similar segments.
-            */
-            splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-            segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), b1+1, b1+1);
-            invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs-1);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, b1+2);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            handle_next_step(new_g_ptr);
-
-            splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b1, 3);
-            insert_segs_into_chr(*(new_g_ptr2->root_chr+c_idx), segs_to_be_dup, b1+1);
-            splice_all_segs(
-                new_g_ptr2,         /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            handle_next_step(new_g_ptr2);
+                handle_next_step(new_g_ptr);
+
+                splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b1, 3);
+                insert_segs_into_chr(*(new_g_ptr2->root_chr+c_idx), segs_to_be_dup, b1+1);
+                splice_breakpoint_copies(
+                    new_g_ptr2,  /* Genome where the segments are to be split */
+                    bp1,         /* Breakpoint in the segment to be split */
+                    3            /* Split the segments into three */
+                );
+
+                handle_next_step(new_g_ptr2);
+            }
 
             delete_chromosome(segs_to_be_dup);
-            free(b1_seg_indexes);
 
 
             // Next, when the two breakpoints occur at two physically different DNA segments
             int two_segments_look_identical;
             int yank_from, yank_to;
             for (b2 = b1+1; b2 < (*(g_ptr->root_chr+c_idx))->n_segs; b2++) {
+                bp2 = c_bps + b2;
                 /* Do the two affected segments have the same seg_indexes? */
-                two_segments_look_identical = int_array_cmp(
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->times_divided,
-                    (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->seg_indexes
-                );
+                two_segments_look_identical = (bp1->seg_class == bp2->seg_class);
                 if (two_segments_look_identical) {
                     /* If the two segments have the same indexes,
                        there are two ways the two breakpoints can occur
                        in the segment. */
 
-                    b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-                    b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-                    if (b1_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
                     /* Option 1: looking at plus strand, s1 < s2 at the segment.
                        Segment in question is broken into following:
                           b1  b2
@@ -833,35 +2469,37 @@ void enum_inv_dups(struct genome *g_ptr) {
                        === === ===>
                     */
 
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, INV_DUP, hist_idx++);
-                    new_g_ptr2 = copy_genome(g_ptr);
-                    make_history(new_g_ptr2, INV_DUP, hist_idx++);
-
-                    /*
-                        Splice the two affected segments.
-                        Then deleted everything in between.
-                        Then splice the remaining similar segments.
-                    */
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
-                    yank_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 1 : b1 + 2;  /* After splicing, segment at b1 becomes
-                                                                                                               three segments. */
-                    yank_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 1 : 0);  /* 2 + b2 comes from the fact that segment at
-                                                                                                               b1 has now been split from one to 3 segments. */
-                    segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
-                    invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs-1);
-                    insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 3);
-
-                    handle_next_step(new_g_ptr);
-
-                    splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b2+2, 3);
-                    insert_segs_into_chr(*(new_g_ptr2->root_chr+c_idx), segs_to_be_dup, yank_from);
-                    splice_all_segs(new_g_ptr2, b1_seg_indexes, b1_seg_indexes_ln, 3);
-
-                    handle_next_step(new_g_ptr2);
+                    if (!skip_events(&hist_idx, 2)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, INV_DUP, hist_idx++);
+                        new_g_ptr2 = copy_genome(g_ptr);
+                        make_history(new_g_ptr2, INV_DUP, hist_idx++);
+
+                        /*
+                            Splice the two affected segments.
+                            Then deleted everything in between.
+                            Then splice the remaining similar segments.
+                        */
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
+                        yank_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 1 : b1 + 2;  /* After splicing, segment at b1 becomes
+                                                                                                                   three segments. */
+                        yank_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 1 : 0);  /* 2 + b2 comes from the fact that segment at
+                                                                                                                   b1 has now been split from one to 3 segments. */
+                        segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
+                        invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs-1);
+                        insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 3);
+
+                        handle_next_step(new_g_ptr);
+
+                        splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b2+2, 3);
+                        insert_segs_into_chr(*(new_g_ptr2->root_chr+c_idx), segs_to_be_dup, yank_from);
+                        splice_breakpoint_copies(new_g_ptr2, bp1, 3);
+
+                        handle_next_step(new_g_ptr2);
+                    }
 
                     delete_chromosome(segs_to_be_dup);
                     
@@ -873,86 +2511,69 @@ void enum_inv_dups(struct genome *g_ptr) {
                        === === ===>
                     */
 
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, INV_DUP, hist_idx++);
-                    new_g_ptr2 = copy_genome(g_ptr);
-                    make_history(new_g_ptr2, INV_DUP, hist_idx++);
-
-                    /* Same story as above. */
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
-                    yank_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 2 : b1 + 1;  /* After splicing, segment at b1 becomes
-                                                                                                               three segments. */
-                    yank_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 0 : 1);  /* 2 + b2 comes from the fact that segment at
-                                                                                                               b1 has now been split from one to 3 segments. */
-                    segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
-                    invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs-1);
-                    insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 3);
-
-                    handle_next_step(new_g_ptr);
-
-                    splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b1, 3);
-                    splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b2+2, 3);
-                    insert_segs_into_chr(*(new_g_ptr2->root_chr+c_idx), segs_to_be_dup, yank_from);
-                    splice_all_segs(new_g_ptr2, b1_seg_indexes, b1_seg_indexes_ln, 3);
-
-                    handle_next_step(new_g_ptr2);
+                    if (!skip_events(&hist_idx, 2)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, INV_DUP, hist_idx++);
+                        new_g_ptr2 = copy_genome(g_ptr);
+                        make_history(new_g_ptr2, INV_DUP, hist_idx++);
+
+                        /* Same story as above. */
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+2, 3);
+                        yank_from = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->is_plus ? b1 + 2 : b1 + 1;  /* After splicing, segment at b1 becomes
+                                                                                                                   three segments. */
+                        yank_to = 2 + b2 + ( (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b2+2))->is_plus ? 0 : 1);  /* 2 + b2 comes from the fact that segment at
+                                                                                                                   b1 has now been split from one to 3 segments. */
+                        segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
+                        invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs-1);
+                        insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 3);
+
+                        handle_next_step(new_g_ptr);
+
+                        splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b1, 3);
+                        splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b2+2, 3);
+                        insert_segs_into_chr(*(new_g_ptr2->root_chr+c_idx), segs_to_be_dup, yank_from);
+                        splice_breakpoint_copies(new_g_ptr2, bp1, 3);
+
+                        handle_next_step(new_g_ptr2);
+                    }
 
                     delete_chromosome(segs_to_be_dup);
-                    free(b1_seg_indexes);
                 }
                 else {
                     /* If the two broken segments have different indexes,
                        simply break them and splice intervening segments out. */
 
-                    /* But first, let's store the identities of the affected segments first */
-                    b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-                    b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-                    if (b1_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-                    b2_seg_indexes_ln = (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->times_divided;
-                    b2_seg_indexes = malloc(b2_seg_indexes_ln * sizeof(int));
-                    if (b2_seg_indexes == NULL) {
-                        fprintf(stderr, "Failed malloc for b2_seg_indexes. Exiting\n");
-                        exit(1);
-                    }
-                    memcpy(b2_seg_indexes, (*((*(g_ptr->root_chr+c_idx))->root_seg+b2))->seg_indexes, b2_seg_indexes_ln * sizeof(int));
-
-                    
                     /* Finally, let's break segments */
-                    new_g_ptr = copy_genome(g_ptr);
-                    make_history(new_g_ptr, INV_DUP, hist_idx++);
-                    new_g_ptr2 = copy_genome(g_ptr);
-                    make_history(new_g_ptr2, INV_DUP, hist_idx++);
-
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
-                    splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+1, 2);
-                    yank_from = b1 + 1;
-                    yank_to = 1 + b2;
-                    segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
-                    invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs-1);
-                    insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
-                    splice_all_segs(new_g_ptr, b1_seg_indexes, b1_seg_indexes_ln, 2);
-                    splice_all_segs(new_g_ptr, b2_seg_indexes, b2_seg_indexes_ln, 2);
-
-                    handle_next_step(new_g_ptr);
-
-                    splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b1, 2);
-                    splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b2+1, 2);
-                    insert_segs_into_chr(*(new_g_ptr2->root_chr+c_idx), segs_to_be_dup, yank_from);
-                    splice_all_segs(new_g_ptr2, b1_seg_indexes, b1_seg_indexes_ln, 2);
-                    splice_all_segs(new_g_ptr2, b2_seg_indexes, b2_seg_indexes_ln, 2);
-
-                    handle_next_step(new_g_ptr2);
+                    if (!skip_events(&hist_idx, 2)) {
+                        new_g_ptr = copy_genome(g_ptr);
+                        make_history(new_g_ptr, INV_DUP, hist_idx++);
+                        new_g_ptr2 = copy_genome(g_ptr);
+                        make_history(new_g_ptr2, INV_DUP, hist_idx++);
+
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
+                        splice_one_seg(*(new_g_ptr->root_chr+c_idx), b2+1, 2);
+                        yank_from = b1 + 1;
+                        yank_to = 1 + b2;
+                        segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), yank_from, yank_to);
+                        invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs-1);
+                        insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, yank_to + 1);
+                        splice_breakpoint_copies(new_g_ptr, bp1, 2);
+                        splice_breakpoint_copies(new_g_ptr, bp2, 2);
+
+                        handle_next_step(new_g_ptr);
+
+                        splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b1, 2);
+                        splice_one_seg(*(new_g_ptr2->root_chr+c_idx), b2+1, 2);
+                        insert_segs_into_chr(*(new_g_ptr2->root_chr+c_idx), segs_to_be_dup, yank_from);
+                        splice_breakpoint_copies(new_g_ptr2, bp1, 2);
+                        splice_breakpoint_copies(new_g_ptr2, bp2, 2);
+
+                        handle_next_step(new_g_ptr2);
+                    }
 
                     delete_chromosome(segs_to_be_dup);
-                    free(b1_seg_indexes);
-                    free(b2_seg_indexes);
                 }
             }
         }  // for each b1
@@ -965,6 +2586,72 @@ void enum_inv_dups(struct genome *g_ptr) {
 //
 // BFB related enumerators
 //
+/*
+    A telomeric break within segment b1 keeps one arm of the chromosome, and a
+    fold-back also adds the inverted copy of the arm next to it, so the
+    resulting chromosome is given by the segments of the arm alone.
+    get_bfb_chr() builds it in closed form from those segments, with the
+    copies of segment b1 already split in two as splice_all_segs() splits
+    them, instead of splicing, deleting, yanking, inverting and inserting
+    segments of a copy of the whole chromosome. The chromosome doubles with
+    every BFB cycle, so this spares most of the copying in deep BFB histories.
+*/
+struct chromosome* get_bfb_chr(struct chromosome *c_ptr, struct breakpoint *c_bps, int b1, int is_left, int is_fold_back) {
+    struct seg *s_ptr, **arm, **inverted_arm;
+    int from = (is_left ? b1 : 0);
+    int to = (is_left ? c_ptr->n_segs - 1 : b1);
+    int n_arm_segs = -1;  // One of the pieces of segment b1 is lost
+    int s_idx, piece, i;
+
+    for (s_idx=from; s_idx<=to; s_idx++) {
+        n_arm_segs += ((c_bps+s_idx)->seg_class == (c_bps+b1)->seg_class ? 2 : 1);
+    }
+
+    struct chromosome *new_c_ptr = malloc(sizeof(struct chromosome));
+    if (new_c_ptr == NULL) {
+        fprintf(stderr, "\nCreation of chromosome node failed. Exiting.\n");
+        exit(1);
+    }
+    new_c_ptr->n_segs = (is_fold_back ? 2 * n_arm_segs : n_arm_segs);
+    new_c_ptr->root_seg = malloc(new_c_ptr->n_segs * sizeof(struct seg*));
+    if (new_c_ptr->root_seg == NULL) {
+        fprintf(stderr, "\nCreation of root seg node failed. Exiting.\n");
+        exit(1);
+    }
+    new_c_ptr->info = NULL;
+    new_c_ptr->used_bps = NULL;
+    new_c_ptr->n_used_bps = -1;
+    new_c_ptr->used_bps_changed = 0;
+
+    // The arm, which follows its inverted copy after a fold-back of the left telomere
+    arm = new_c_ptr->root_seg + (is_left && is_fold_back ? n_arm_segs : 0);
+    i = 0;
+    for (s_idx=from; s_idx<=to; s_idx++) {
+        s_ptr = *(c_ptr->root_seg+s_idx);
+        if ((c_bps+s_idx)->seg_class != (c_bps+b1)->seg_class) {
+            *(arm+i++) = copy_seg(s_ptr);
+            continue;
+        }
+        for (piece=0; piece<2; piece++) {
+            if (s_idx == b1 && piece == (is_left ? 0 : 1)) {
+                continue;  // Lost with the other arm
+            }
+            *(arm+i++) = copy_seg_piece(s_ptr, piece, 2);
+        }
+    }
+
+    if (is_fold_back) {
+        inverted_arm = new_c_ptr->root_seg + (is_left ? 0 : n_arm_segs);
+        for (i=0; i<n_arm_segs; i++) {
+            s_ptr = copy_seg(*(arm+i));
+            s_ptr->is_plus = (s_ptr->is_plus == 1 ? 0 : 1);
+            *(inverted_arm+n_arm_segs-1-i) = s_ptr;
+        }
+    }
+
+    return(new_c_ptr);
+}
+
 void enum_tel_break(struct genome *g_ptr) {  // Telomeric break without fold-back rearrangement
     // _validate_genome(g_ptr, "enum_dels()");
     int hist_idx = 0;
@@ -972,52 +2659,44 @@ void enum_tel_break(struct genome *g_ptr) {  // Telomeric break without fold-bac
     /* Declare reusable variables */
     int b1;
     struct genome *new_g_ptr;
-    int *b1_seg_indexes, b1_seg_indexes_ln;
+    struct breakpoint *c_bps, *bp1;
     int c_idx;
 
     for (c_idx = 0; c_idx < g_ptr->n_chrs; c_idx++) {
+        if (is_twin_block(g_ptr, TEL_BREAK, c_idx, -1, &hist_idx)) {
+            continue;
+        }
+        c_bps = get_chr_breakpoints(g_ptr, c_idx);
         for (b1 = 0; b1 < (*(g_ptr->root_chr+c_idx))->n_segs; b1++) {
+            bp1 = c_bps + b1;
+
             //
             // Left telomere, no fusion, but neotelomerization
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, TEL_BREAK, hist_idx++);
-
-            // Below has to be done only once
-            b1_seg_indexes_ln = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "\nFailed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
-            }
-            memcpy(b1_seg_indexes, (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-            splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), 0, b1);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome_with_chr(g_ptr, c_idx, get_bfb_chr(*(g_ptr->root_chr+c_idx), c_bps, b1, 1, 0));
+                make_history(new_g_ptr, TEL_BREAK, hist_idx++);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
 
-            handle_next_step(new_g_ptr);
+                handle_next_step(new_g_ptr);
+            }
 
             //
             // Right telomere, no fusion, but neotelomerization
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, TEL_BREAK, hist_idx++);
-            splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), b1+1, (*(new_g_ptr->root_chr+c_idx))->n_segs - 1);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
-
-            handle_next_step(new_g_ptr);
-
-            free(b1_seg_indexes);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome_with_chr(g_ptr, c_idx, get_bfb_chr(*(g_ptr->root_chr+c_idx), c_bps, b1, 0, 0));
+                make_history(new_g_ptr, TEL_BREAK, hist_idx++);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
+
+                handle_next_step(new_g_ptr);
+            }
         }  // for each b1
     }  // for each c_idx
 }
@@ -1029,63 +2708,44 @@ void enum_fbs(struct genome *g_ptr) {  // Fold-back rearrangement
     /* Declare reusable variables */
     int b1;
     struct genome *new_g_ptr;
-    struct chromosome *segs_to_be_dup;
-    int *b1_seg_indexes, b1_seg_indexes_ln;
+    struct breakpoint *c_bps, *bp1;
     int c_idx;
 
     for (c_idx = 0; c_idx < g_ptr->n_chrs; c_idx++) {
+        if (is_twin_block(g_ptr, FOLD_BACK, c_idx, -1, &hist_idx)) {
+            continue;
+        }
+        c_bps = get_chr_breakpoints(g_ptr, c_idx);
         for (b1 = 0; b1 < (*(g_ptr->root_chr+c_idx))->n_segs; b1++) {
+            bp1 = c_bps + b1;
+
             //
             // Left telomere, telomeric fusion
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, FOLD_BACK, hist_idx++);
-
-            // Below has to be done only once
-            b1_seg_indexes_ln = (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "\nFailed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
-            }
-            memcpy(b1_seg_indexes, (*((*(new_g_ptr->root_chr+c_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-            splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), 0, b1);
-            segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), 0, (*(new_g_ptr->root_chr+c_idx))->n_segs - 1);
-            invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs - 1);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, 0);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
-
-            handle_next_step_after_fold_back(new_g_ptr);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome_with_chr(g_ptr, c_idx, get_bfb_chr(*(g_ptr->root_chr+c_idx), c_bps, b1, 1, 1));
+                make_history(new_g_ptr, FOLD_BACK, hist_idx++);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
 
-            delete_chromosome(segs_to_be_dup);
+                handle_next_step_after_fold_back(new_g_ptr);
+            }
 
             //
             // Right telomere, telomeric fusion
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, FOLD_BACK, hist_idx++);
-            splice_one_seg(*(new_g_ptr->root_chr+c_idx), b1, 2);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), b1+1, (*(new_g_ptr->root_chr+c_idx))->n_segs - 1);
-            segs_to_be_dup = yank_segments(*(new_g_ptr->root_chr+c_idx), 0, (*(new_g_ptr->root_chr+c_idx))->n_segs - 1);
-            invert_segs_in_chr(segs_to_be_dup, 0, segs_to_be_dup->n_segs - 1);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), segs_to_be_dup, (*(new_g_ptr->root_chr+c_idx))->n_segs);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
-
-            handle_next_step_after_fold_back(new_g_ptr);
-
-            delete_chromosome(segs_to_be_dup);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome_with_chr(g_ptr, c_idx, get_bfb_chr(*(g_ptr->root_chr+c_idx), c_bps, b1, 0, 1));
+                make_history(new_g_ptr, FOLD_BACK, hist_idx++);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
 
-            free(b1_seg_indexes);
+                handle_next_step_after_fold_back(new_g_ptr);
+            }
         }  // for each b1
     }  // for each c_idx
 }
@@ -1102,33 +2762,26 @@ void enum_bal_transloc(struct genome* g_ptr) {
     /* Declare reusable variables */
     int b1, b2;
     struct genome *new_g_ptr;
-    int *b1_seg_indexes, *b2_seg_indexes, b1_seg_indexes_ln, b2_seg_indexes_ln;
+    struct breakpoint *c1_bps, *c2_bps, *bp1, *bp2;
     int c1_idx, c2_idx, two_segments_look_identical;
     struct chromosome *seg_holder1, *seg_holder2;
     
     // Go through all chromosomes and all segments
     for (c1_idx=0; c1_idx<g_ptr->n_chrs; c1_idx++) {
     for (c2_idx=c1_idx+1; c2_idx<g_ptr->n_chrs; c2_idx++) {
+        if (is_twin_block(g_ptr, BAL_TRANSLOC, c1_idx, c2_idx, &hist_idx)) {
+            continue;
+        }
+        c1_bps = get_chr_breakpoints(g_ptr, c1_idx);
+        c2_bps = get_chr_breakpoints(g_ptr, c2_idx);
     for (b1=0; b1 < (*(g_ptr->root_chr+c1_idx))->n_segs; b1++) {
     for (b2=0; b2 < (*(g_ptr->root_chr+c2_idx))->n_segs; b2++) {
-        two_segments_look_identical = int_array_cmp(
-            (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->times_divided,
-            (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->seg_indexes,
-            (*((*(g_ptr->root_chr+c2_idx))->root_seg+b2))->times_divided,
-            (*((*(g_ptr->root_chr+c2_idx))->root_seg+b2))->seg_indexes
-        );
+        bp1 = c1_bps + b1;
+        bp2 = c2_bps + b2;
+        two_segments_look_identical = (bp1->seg_class == bp2->seg_class);
 
         // Are the two affected segments the same segment?
         if (two_segments_look_identical) {
-            b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
-            }
-            memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-
             /* Option 1: looking at plus strand, b1 < b2 at the segment.
                Segment in question is broken into following:
                   b1  b2
@@ -1137,97 +2790,99 @@ void enum_bal_transloc(struct genome* g_ptr) {
             */
 
             // Case 1A, two +- rearrangements
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
-
-            // Swap the q-telomeric pieces
-            seg_holder1 = yank_segments(  // Get the q-telomeric pieces
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
-            );
-            seg_holder2 = yank_segments(
-                *(new_g_ptr->root_chr+c2_idx),
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1),
-                (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1
-            );
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
-            delete_segs_from_chr(  // Remove the translocated piece from between
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1),
-                (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            handle_next_step(new_g_ptr);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
+
+                // Swap the q-telomeric pieces
+                seg_holder1 = yank_segments(  // Get the q-telomeric pieces
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
+                );
+                seg_holder2 = yank_segments(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1),
+                    (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1
+                );
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
+                delete_segs_from_chr(  // Remove the translocated piece from between
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1),
+                    (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
+
+                handle_next_step(new_g_ptr);
+
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
             
 
             // Case 1B: a ++ and a -- rearrangement
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
-
-            // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
-            seg_holder1 = yank_segments(
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
-            );
-            invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
-            seg_holder2 = yank_segments(
-                *(new_g_ptr->root_chr+c2_idx),
-                0,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2)
-            );
-            invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
-            insert_segs_into_chr(
-                *(new_g_ptr->root_chr+c1_idx),
-                seg_holder2,
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs
-            );
-            insert_segs_into_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                seg_holder1,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1)
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                0,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2)
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            handle_next_step(new_g_ptr);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
+
+                // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
+                seg_holder1 = yank_segments(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
+                );
+                invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
+                seg_holder2 = yank_segments(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    0,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2)
+                );
+                invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
+                insert_segs_into_chr(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    seg_holder2,
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs
+                );
+                insert_segs_into_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    seg_holder1,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1)
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    0,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2)
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
+
+                handle_next_step(new_g_ptr);
+
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
 
 
             /* Option 2: looking at plus strand, b1 > b2 at the segment.
@@ -1238,189 +2893,169 @@ void enum_bal_transloc(struct genome* g_ptr) {
             */
 
             // Case 2A, two +- rearrangements
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
-
-            // Swap the q-telomeric pieces
-            seg_holder1 = yank_segments(  // Get the q-telomeric pieces
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
-            );
-            seg_holder2 = yank_segments(
-                *(new_g_ptr->root_chr+c2_idx),
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2),
-                (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1
-            );
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
-            delete_segs_from_chr(  // Remove the translocated piece from between
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2),
-                (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            handle_next_step(new_g_ptr);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
+
+                // Swap the q-telomeric pieces
+                seg_holder1 = yank_segments(  // Get the q-telomeric pieces
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
+                );
+                seg_holder2 = yank_segments(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2),
+                    (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1
+                );
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
+                delete_segs_from_chr(  // Remove the translocated piece from between
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2),
+                    (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
+
+                handle_next_step(new_g_ptr);
+
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
             
 
             // Case 2B: a ++ and a -- rearrangement
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
-
-            // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
-            seg_holder1 = yank_segments(
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
-            );
-            invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
-            seg_holder2 = yank_segments(
-                *(new_g_ptr->root_chr+c2_idx),
-                0,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2 : b2+1)
-            );
-            invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
-            insert_segs_into_chr(
-                *(new_g_ptr->root_chr+c1_idx),
-                seg_holder2,
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs
-            );
-            insert_segs_into_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                seg_holder1,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2)
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                0,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2 : b2+1)
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            handle_next_step(new_g_ptr);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
-
-
-            free(b1_seg_indexes);
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
+
+                // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
+                seg_holder1 = yank_segments(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
+                );
+                invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
+                seg_holder2 = yank_segments(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    0,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2 : b2+1)
+                );
+                invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
+                insert_segs_into_chr(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    seg_holder2,
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs
+                );
+                insert_segs_into_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    seg_holder1,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2)
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    0,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2 : b2+1)
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
+
+                handle_next_step(new_g_ptr);
+
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
         }
         else {
             // We are here because the two affected segments are not the same
 
-            b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
-            }
-            memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-            b2_seg_indexes_ln = (*((*(g_ptr->root_chr+c2_idx))->root_seg+b2))->times_divided;
-            b2_seg_indexes = malloc(b2_seg_indexes_ln * sizeof(int));
-            if (b2_seg_indexes == NULL) {
-                fprintf(stderr, "Failed malloc for b2_seg_indexes. Exiting\n");
-                exit(1);
-            }
-            memcpy(b2_seg_indexes, (*((*(g_ptr->root_chr+c2_idx))->root_seg+b2))->seg_indexes, b2_seg_indexes_ln * sizeof(int));
+            // First case, two +- rearrangements
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 2);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 2);
+
+                // Swap the q-telomeric pieces
+                seg_holder1 = yank_segments(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1);  // Get the q-telomeric pieces
+                seg_holder2 = yank_segments(*(new_g_ptr->root_chr+c2_idx), b2+1, (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1);
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs);  // Remove the translocated piece from between
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c2_idx), b2+1, (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp2,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
 
+                handle_next_step(new_g_ptr);
 
-            // First case, two +- rearrangements
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 2);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 2);
-
-            // Swap the q-telomeric pieces
-            seg_holder1 = yank_segments(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1);  // Get the q-telomeric pieces
-            seg_holder2 = yank_segments(*(new_g_ptr->root_chr+c2_idx), b2+1, (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs);  // Remove the translocated piece from between
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c2_idx), b2+1, (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b2_seg_indexes,     /* The index of the segment to be split */
-                b2_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
-
-            handle_next_step(new_g_ptr);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
 
 
             // Second case: a ++ and a -- rearrangement
-            new_g_ptr = copy_genome(g_ptr);
-            make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 2);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 2);
-
-            // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
-            seg_holder1 = yank_segments(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1);  // Get the q-telomeric pieces
-            invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
-            seg_holder2 = yank_segments(*(new_g_ptr->root_chr+c2_idx), 0, b2);
-            invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, b2+1);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c2_idx), 0, b2);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b2_seg_indexes,     /* The index of the segment to be split */
-                b2_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
+            if (!skip_events(&hist_idx, 1)) {
+                new_g_ptr = copy_genome(g_ptr);
+                make_history(new_g_ptr, BAL_TRANSLOC, hist_idx++);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 2);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 2);
+
+                // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
+                seg_holder1 = yank_segments(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1);  // Get the q-telomeric pieces
+                invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
+                seg_holder2 = yank_segments(*(new_g_ptr->root_chr+c2_idx), 0, b2);
+                invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, b2+1);
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs);
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c2_idx), 0, b2);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp2,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
 
-            handle_next_step(new_g_ptr);
+                handle_next_step(new_g_ptr);
 
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
 
 
-            free(b1_seg_indexes);
-            free(b2_seg_indexes);
         }
     }
     }
@@ -1436,33 +3071,26 @@ void enum_unbal_transloc(struct genome* g_ptr) {
     /* Declare reusable variables */
     int b1, b2;
     struct genome *new_g_ptr, *new_g_ptr2;
-    int *b1_seg_indexes, *b2_seg_indexes, b1_seg_indexes_ln, b2_seg_indexes_ln;
+    struct breakpoint *c1_bps, *c2_bps, *bp1, *bp2;
     int c1_idx, c2_idx, two_segments_look_identical;
     struct chromosome *seg_holder1, *seg_holder2;
     
     // Go through all chromosomes and all segments
     for (c1_idx=0; c1_idx<g_ptr->n_chrs; c1_idx++) {
     for (c2_idx=c1_idx+1; c2_idx<g_ptr->n_chrs; c2_idx++) {
+        if (is_twin_block(g_ptr, UNBAL_TRANSLOC, c1_idx, c2_idx, &hist_idx)) {
+            continue;
+        }
+        c1_bps = get_chr_breakpoints(g_ptr, c1_idx);
+        c2_bps = get_chr_breakpoints(g_ptr, c2_idx);
     for (b1=0; b1 < (*(g_ptr->root_chr+c1_idx))->n_segs; b1++) {
     for (b2=0; b2 < (*(g_ptr->root_chr+c2_idx))->n_segs; b2++) {
-        two_segments_look_identical = int_array_cmp(
-            (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->times_divided,
-            (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->seg_indexes,
-            (*((*(g_ptr->root_chr+c2_idx))->root_seg+b2))->times_divided,
-            (*((*(g_ptr->root_chr+c2_idx))->root_seg+b2))->seg_indexes
-        );
+        bp1 = c1_bps + b1;
+        bp2 = c2_bps + b2;
+        two_segments_look_identical = (bp1->seg_class == bp2->seg_class);
 
         // Are the two affected segments the same segment?
         if (two_segments_look_identical) {
-            b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
-            }
-            memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-
             /* Option 1: looking at plus strand, b1 < b2 at the segment.
                Segment in question is broken into following:
                   b1  b2
@@ -1471,108 +3099,110 @@ void enum_unbal_transloc(struct genome* g_ptr) {
             */
 
             // Case 1A, two +- rearrangements
-            new_g_ptr = copy_genome(g_ptr);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
-
-            // Swap the q-telomeric pieces
-            seg_holder1 = yank_segments(  // Get the q-telomeric pieces
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
-            );
-            seg_holder2 = yank_segments(
-                *(new_g_ptr->root_chr+c2_idx),
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1),
-                (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1
-            );
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
-            delete_segs_from_chr(  // Remove the translocated piece from between
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1),
-                (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            // Either c1_idx or c2_idx gets lost
-            new_g_ptr2 = copy_genome(new_g_ptr);
-            make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
-            make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
-            lose_chromosome_in_genome(new_g_ptr, c1_idx);
-            lose_chromosome_in_genome(new_g_ptr2, c2_idx);
-            handle_next_step(new_g_ptr);
-            handle_next_step(new_g_ptr2);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+            if (!skip_events(&hist_idx, 2)) {
+                new_g_ptr = copy_genome(g_ptr);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
+
+                // Swap the q-telomeric pieces
+                seg_holder1 = yank_segments(  // Get the q-telomeric pieces
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
+                );
+                seg_holder2 = yank_segments(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1),
+                    (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1
+                );
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
+                delete_segs_from_chr(  // Remove the translocated piece from between
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1),
+                    (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
+
+                // Either c1_idx or c2_idx gets lost
+                new_g_ptr2 = copy_genome(new_g_ptr);
+                make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
+                make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
+                lose_chromosome_in_genome(new_g_ptr, c1_idx);
+                lose_chromosome_in_genome(new_g_ptr2, c2_idx);
+                handle_next_step(new_g_ptr);
+                handle_next_step(new_g_ptr2);
+
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
             
 
             // Case 1B: a ++ and a -- rearrangement
-            new_g_ptr = copy_genome(g_ptr);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
-
-            // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
-            seg_holder1 = yank_segments(
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
-            );
-            invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
-            seg_holder2 = yank_segments(
-                *(new_g_ptr->root_chr+c2_idx),
-                0,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2)
-            );
-            invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
-            insert_segs_into_chr(
-                *(new_g_ptr->root_chr+c1_idx),
-                seg_holder2,
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs
-            );
-            insert_segs_into_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                seg_holder1,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1)
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                0,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2)
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            new_g_ptr2 = copy_genome(new_g_ptr);
-            make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
-            make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
-            lose_chromosome_in_genome(new_g_ptr, c1_idx);
-            lose_chromosome_in_genome(new_g_ptr2, c2_idx);
-            handle_next_step(new_g_ptr);
-            handle_next_step(new_g_ptr2);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+            if (!skip_events(&hist_idx, 2)) {
+                new_g_ptr = copy_genome(g_ptr);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
+
+                // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
+                seg_holder1 = yank_segments(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
+                );
+                invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
+                seg_holder2 = yank_segments(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    0,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2)
+                );
+                invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
+                insert_segs_into_chr(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    seg_holder2,
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs
+                );
+                insert_segs_into_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    seg_holder1,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+2 : b2+1)
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+1 : b1+2),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    0,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2)
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
+
+                new_g_ptr2 = copy_genome(new_g_ptr);
+                make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
+                make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
+                lose_chromosome_in_genome(new_g_ptr, c1_idx);
+                lose_chromosome_in_genome(new_g_ptr2, c2_idx);
+                handle_next_step(new_g_ptr);
+                handle_next_step(new_g_ptr2);
+
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
 
 
             /* Option 2: looking at plus strand, b1 > b2 at the segment.
@@ -1583,209 +3213,189 @@ void enum_unbal_transloc(struct genome* g_ptr) {
             */
 
             // Case 2A, two +- rearrangements
-            new_g_ptr = copy_genome(g_ptr);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
-
-            // Swap the q-telomeric pieces
-            seg_holder1 = yank_segments(  // Get the q-telomeric pieces
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
-            );
-            seg_holder2 = yank_segments(
-                *(new_g_ptr->root_chr+c2_idx),
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2),
-                (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1
-            );
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
-            delete_segs_from_chr(  // Remove the translocated piece from between
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2),
-                (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            new_g_ptr2 = copy_genome(new_g_ptr);
-            make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
-            make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
-            lose_chromosome_in_genome(new_g_ptr, c1_idx);
-            lose_chromosome_in_genome(new_g_ptr2, c2_idx);
-            handle_next_step(new_g_ptr);
-            handle_next_step(new_g_ptr2);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+            if (!skip_events(&hist_idx, 2)) {
+                new_g_ptr = copy_genome(g_ptr);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
+
+                // Swap the q-telomeric pieces
+                seg_holder1 = yank_segments(  // Get the q-telomeric pieces
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
+                );
+                seg_holder2 = yank_segments(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2),
+                    (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1
+                );
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
+                delete_segs_from_chr(  // Remove the translocated piece from between
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2),
+                    (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
+
+                new_g_ptr2 = copy_genome(new_g_ptr);
+                make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
+                make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
+                lose_chromosome_in_genome(new_g_ptr, c1_idx);
+                lose_chromosome_in_genome(new_g_ptr2, c2_idx);
+                handle_next_step(new_g_ptr);
+                handle_next_step(new_g_ptr2);
+
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
             
 
             // Case 2B: a ++ and a -- rearrangement
-            new_g_ptr = copy_genome(g_ptr);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
-
-            // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
-            seg_holder1 = yank_segments(
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
-            );
-            invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
-            seg_holder2 = yank_segments(
-                *(new_g_ptr->root_chr+c2_idx),
-                0,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2 : b2+1)
-            );
-            invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
-            insert_segs_into_chr(
-                *(new_g_ptr->root_chr+c1_idx),
-                seg_holder2,
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs
-            );
-            insert_segs_into_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                seg_holder1,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2)
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c1_idx),
-                ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
-                (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
-            );
-            delete_segs_from_chr(
-                *(new_g_ptr->root_chr+c2_idx),
-                0,
-                ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2 : b2+1)
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                3                   /* Split the segments into three */
-            );
-
-            new_g_ptr2 = copy_genome(new_g_ptr);
-            make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
-            make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
-            lose_chromosome_in_genome(new_g_ptr, c1_idx);
-            lose_chromosome_in_genome(new_g_ptr2, c2_idx);
-            handle_next_step(new_g_ptr);
-            handle_next_step(new_g_ptr2);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
-
-
-            free(b1_seg_indexes);
+            if (!skip_events(&hist_idx, 2)) {
+                new_g_ptr = copy_genome(g_ptr);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 3);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 3);
+
+                // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
+                seg_holder1 = yank_segments(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1
+                );
+                invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
+                seg_holder2 = yank_segments(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    0,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2 : b2+1)
+                );
+                invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
+                insert_segs_into_chr(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    seg_holder2,
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs
+                );
+                insert_segs_into_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    seg_holder1,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2+1 : b2+2)
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c1_idx),
+                    ( (*((*(new_g_ptr->root_chr+c1_idx))->root_seg+b1))->is_plus ? b1+2 : b1+1),
+                    (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs
+                );
+                delete_segs_from_chr(
+                    *(new_g_ptr->root_chr+c2_idx),
+                    0,
+                    ( (*((*(new_g_ptr->root_chr+c2_idx))->root_seg+b2))->is_plus ? b2 : b2+1)
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    3           /* Split the segments into three */
+                );
+
+                new_g_ptr2 = copy_genome(new_g_ptr);
+                make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
+                make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
+                lose_chromosome_in_genome(new_g_ptr, c1_idx);
+                lose_chromosome_in_genome(new_g_ptr2, c2_idx);
+                handle_next_step(new_g_ptr);
+                handle_next_step(new_g_ptr2);
+
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
         }
         else {
             // We are here because the two affected segments are not the same
 
-            b1_seg_indexes_ln = (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->times_divided;
-            b1_seg_indexes = malloc(b1_seg_indexes_ln * sizeof(int));
-            if (b1_seg_indexes == NULL) {
-                fprintf(stderr, "Failed malloc for b1_seg_indexes. Exiting\n");
-                exit(1);
-            }
-            memcpy(b1_seg_indexes, (*((*(g_ptr->root_chr+c1_idx))->root_seg+b1))->seg_indexes, b1_seg_indexes_ln * sizeof(int));
-
-            b2_seg_indexes_ln = (*((*(g_ptr->root_chr+c2_idx))->root_seg+b2))->times_divided;
-            b2_seg_indexes = malloc(b2_seg_indexes_ln * sizeof(int));
-            if (b2_seg_indexes == NULL) {
-                fprintf(stderr, "Failed malloc for b2_seg_indexes. Exiting\n");
-                exit(1);
-            }
-            memcpy(b2_seg_indexes, (*((*(g_ptr->root_chr+c2_idx))->root_seg+b2))->seg_indexes, b2_seg_indexes_ln * sizeof(int));
+            // First case, two +- rearrangements
+            if (!skip_events(&hist_idx, 2)) {
+                new_g_ptr = copy_genome(g_ptr);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 2);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 2);
+
+                // Swap the q-telomeric pieces
+                seg_holder1 = yank_segments(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1);  // Get the q-telomeric pieces
+                seg_holder2 = yank_segments(*(new_g_ptr->root_chr+c2_idx), b2+1, (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1);
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs);  // Remove the translocated piece from between
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c2_idx), b2+1, (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp2,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
 
+                new_g_ptr2 = copy_genome(new_g_ptr);
+                make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
+                make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
+                lose_chromosome_in_genome(new_g_ptr, c1_idx);
+                lose_chromosome_in_genome(new_g_ptr2, c2_idx);
+                handle_next_step(new_g_ptr);
+                handle_next_step(new_g_ptr2);
 
-            // First case, two +- rearrangements
-            new_g_ptr = copy_genome(g_ptr);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 2);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 2);
-
-            // Swap the q-telomeric pieces
-            seg_holder1 = yank_segments(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1);  // Get the q-telomeric pieces
-            seg_holder2 = yank_segments(*(new_g_ptr->root_chr+c2_idx), b2+1, (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);  // Insert the pieces to the ends of the chromosomes
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, (*(new_g_ptr->root_chr+c2_idx))->n_segs);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs);  // Remove the translocated piece from between
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c2_idx), b2+1, (*(new_g_ptr->root_chr+c2_idx))->n_segs - 1 - seg_holder1->n_segs);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b2_seg_indexes,     /* The index of the segment to be split */
-                b2_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
-
-            new_g_ptr2 = copy_genome(new_g_ptr);
-            make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
-            make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
-            lose_chromosome_in_genome(new_g_ptr, c1_idx);
-            lose_chromosome_in_genome(new_g_ptr2, c2_idx);
-            handle_next_step(new_g_ptr);
-            handle_next_step(new_g_ptr2);
-
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
 
 
             // Second case: a ++ and a -- rearrangement
-            new_g_ptr = copy_genome(g_ptr);
-            splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 2);
-            splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 2);
-
-            // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
-            seg_holder1 = yank_segments(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1);  // Get the q-telomeric pieces
-            invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
-            seg_holder2 = yank_segments(*(new_g_ptr->root_chr+c2_idx), 0, b2);
-            invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);
-            insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, b2+1);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs);
-            delete_segs_from_chr(*(new_g_ptr->root_chr+c2_idx), 0, b2);
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b1_seg_indexes,     /* The index of the segment to be split */
-                b1_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
-            splice_all_segs(
-                new_g_ptr,          /* Genome where the segments are to be split */
-                b2_seg_indexes,     /* The index of the segment to be split */
-                b2_seg_indexes_ln,  /* How many times this segment has been split */
-                2                   /* Split the segments into three */
-            );
+            if (!skip_events(&hist_idx, 2)) {
+                new_g_ptr = copy_genome(g_ptr);
+                splice_one_seg(*(new_g_ptr->root_chr+c1_idx), b1, 2);
+                splice_one_seg(*(new_g_ptr->root_chr+c2_idx), b2, 2);
+
+                // c1_idx gets the p-telomeric pieces, c2_idx gets the q-telomeric pieces
+                seg_holder1 = yank_segments(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1);  // Get the q-telomeric pieces
+                invert_segs_in_chr(seg_holder1, 0, seg_holder1->n_segs-1);
+                seg_holder2 = yank_segments(*(new_g_ptr->root_chr+c2_idx), 0, b2);
+                invert_segs_in_chr(seg_holder2, 0, seg_holder2->n_segs-1);
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, (*(new_g_ptr->root_chr+c1_idx))->n_segs);
+                insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, b2+1);
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c1_idx), b1+1, (*(new_g_ptr->root_chr+c1_idx))->n_segs - 1 - seg_holder2->n_segs);
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c2_idx), 0, b2);
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp1,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
+                splice_breakpoint_copies(
+                    new_g_ptr,  /* Genome where the segments are to be split */
+                    bp2,        /* Breakpoint in the segment to be split */
+                    2           /* Split the segments in two */
+                );
 
-            new_g_ptr2 = copy_genome(new_g_ptr);
-            make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
-            make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
-            lose_chromosome_in_genome(new_g_ptr, c1_idx);
-            lose_chromosome_in_genome(new_g_ptr2, c2_idx);
-            handle_next_step(new_g_ptr);
-            handle_next_step(new_g_ptr2);
+                new_g_ptr2 = copy_genome(new_g_ptr);
+                make_history(new_g_ptr, UNBAL_TRANSLOC, hist_idx++);
+                make_history(new_g_ptr2, UNBAL_TRANSLOC, hist_idx++);
+                lose_chromosome_in_genome(new_g_ptr, c1_idx);
+                lose_chromosome_in_genome(new_g_ptr2, c2_idx);
+                handle_next_step(new_g_ptr);
+                handle_next_step(new_g_ptr2);
 
-            delete_chromosome(seg_holder1);
-            delete_chromosome(seg_holder2);
+                delete_chromosome(seg_holder1);
+                delete_chromosome(seg_holder2);
+            }
 
 
-            free(b1_seg_indexes);
-            free(b2_seg_indexes);
         }
     }
     }
@@ -1803,6 +3413,9 @@ void enum_wc_dup(struct genome* g_ptr) {
     int c_idx;
 
     for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        if (is_twin_block(g_ptr, WC_DUP, c_idx, -1, &hist_idx)) {
+            continue;
+        }
         new_g_ptr = copy_genome(g_ptr);
         make_history(new_g_ptr, WC_DUP, hist_idx++);
         new_g_ptr->n_chrs += 1;
@@ -1846,23 +3459,15 @@ void enum_wc_del(struct genome* g_ptr) {
 
     /* Declare reusable variables */
     struct genome *new_g_ptr;
-    int c_idx, i;
+    int c_idx;
 
     for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        if (is_twin_block(g_ptr, WC_DEL, c_idx, -1, &hist_idx)) {
+            continue;
+        }
         new_g_ptr = copy_genome(g_ptr);
         make_history(new_g_ptr, WC_DEL, hist_idx++);
-        delete_chromosome(*(new_g_ptr->root_chr + c_idx));
-
-        for (i=c_idx; i<=new_g_ptr->n_chrs-2; i++) {
-            *(new_g_ptr->root_chr+i) = *(new_g_ptr->root_chr+i+1);
-        }
-
-        new_g_ptr->n_chrs -= 1;
-        new_g_ptr->root_chr = realloc(new_g_ptr->root_chr, new_g_ptr->n_chrs * (sizeof(struct chromosome*)));
-        if (new_g_ptr->root_chr == NULL) {
-            fprintf(stderr, "\nrealloc of new_g_ptr->root_chr failed. Exiting.\n");
-            exit(1);
-        }
+        lose_chromosome_in_genome(new_g_ptr, c_idx);
         handle_next_step(new_g_ptr);
     }
 
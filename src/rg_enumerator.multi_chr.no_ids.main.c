@@ -1,29 +1,247 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <glib/glib.h>
-#include "rg_enumerator_classes.c"
-#include "rg_enumerator.multi_chr.no_ids.c"
-
-int N_CHRS, IS_DIPLOID, MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
-GHashTable *seen_somatic_genomes;
+#include "rg_enumerator_lib.c"
 
 int main(int argc, char *argv[]) {
     if (argc < 5) {
         fprintf(stderr, "Need input parameters n_chrs, diploid, max_dup_depth, max_overall_depth. Exiting.\n");
-        fprintf(stderr, "Usage: /nfs/users/nfs_y/yl3/programs/rg_library_c/rg_enumerator.multi_chr <n_chrs> <diploid> <max_dup_depth> <max_overall_depth>\n");
+        fprintf(stderr, "Usage: /nfs/users/nfs_y/yl3/programs/rg_library_c/rg_enumerator.multi_chr <n_chrs> <diploid> <max_dup_depth> <max_overall_depth> [--target <cn_pattern> <rg_pattern> | --mitm <genome_string> | --sample <n_samples> [--seed <seed>] [--rates <rates>]] [--threads <n>] [--max-seen-memory <MB>] [--progress <seconds>] [--metrics-file <path>] [--output text|binary|count|null] [--types <rg_types>] [--max-events <rg_type>=<n>,...] [--reduce-commuting] [--processes <n> --output-prefix <path> [--shared-memory <MB>]]\n");
         exit(1);
     }
-    
+
     sscanf(argv[1], "%d", &N_CHRS);
     sscanf(argv[2], "%d", &IS_DIPLOID);
     sscanf(argv[3], "%d", &MAX_DEPTH_DUP);
     sscanf(argv[4], "%d", &MAX_DEPTH_NONDUP);
+
+    int i, n_threads = 1;
+    char *mitm_genome_string = NULL;
+    long n_samples = 0;
+    guint32 seed = 0;
+    char *rates_string = NULL;
+    long max_seen_memory = 0;
+    double progress_interval = 0;
+    char *metrics_path = NULL;
+    char *output_format = "text";
+    char *types_string = NULL;
+    char *max_events_string = NULL;
+    int reduce_commuting = 0;
+    int n_processes = 1;
+    char *output_prefix = NULL;
+    long shared_memory = 1024;
+    for (i=5; i<argc; i++) {
+        if (strcmp(argv[i], "--target") == 0 && i+2 < argc) {
+            TARGET = create_target_pattern(argv[i+1], argv[i+2]);
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--mitm") == 0 && i+1 < argc) {
+            mitm_genome_string = argv[i+1];
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--sample") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%ld", &n_samples) != 1 || n_samples < 1) {
+                fprintf(stderr, "Number of samples must be a positive integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%u", &seed) != 1) {
+                fprintf(stderr, "Seed must be a non-negative integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--rates") == 0 && i+1 < argc) {
+            rates_string = argv[i+1];
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--max-seen-memory") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%ld", &max_seen_memory) != 1 || max_seen_memory < 1) {
+                fprintf(stderr, "Memory budget of seen genomes must be a positive number of MB. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--progress") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%lf", &progress_interval) != 1 || progress_interval <= 0) {
+                fprintf(stderr, "Progress interval must be a positive number of seconds. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--metrics-file") == 0 && i+1 < argc) {
+            metrics_path = argv[i+1];
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--types") == 0 && i+1 < argc) {
+            types_string = argv[i+1];
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--max-events") == 0 && i+1 < argc) {
+            max_events_string = argv[i+1];
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--reduce-commuting") == 0) {
+            reduce_commuting = 1;
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i+1 < argc) {
+            output_format = argv[i+1];
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--processes") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%d", &n_processes) != 1 || n_processes < 1) {
+                fprintf(stderr, "Number of processes must be a positive integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--output-prefix") == 0 && i+1 < argc) {
+            output_prefix = argv[i+1];
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--shared-memory") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%ld", &shared_memory) != 1 || shared_memory < 0) {
+                fprintf(stderr, "Shared memory must be a non-negative number of MB. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i+1 < argc) {
+            if (sscanf(argv[i+1], "%d", &n_threads) != 1 || n_threads < 1) {
+                fprintf(stderr, "Number of threads must be a positive integer. Exiting.\n");
+                exit(1);
+            }
+            i += 1;
+        }
+        else {
+            fprintf(stderr, "Unknown or incomplete option %s. Exiting.\n", argv[i]);
+            exit(1);
+        }
+    }
+
     fprintf(stderr, "Using %d chromosomes (%s)...\n", N_CHRS, (IS_DIPLOID == 0 ? "haploid" : "diploid"));
     fprintf(stderr, "Enumerating down to maximum of %d duplicative and %d overall rearrangements...\n", MAX_DEPTH_DUP, MAX_DEPTH_NONDUP);
-    seen_somatic_genomes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
-    struct genome *g_ptr = create_genome(N_CHRS, IS_DIPLOID);
-    bridge(g_ptr);
+
+    struct rg_engine *e_ptr = create_engine(N_CHRS, IS_DIPLOID, MAX_DEPTH_DUP, MAX_DEPTH_NONDUP);
+    e_ptr->max_seen_memory = max_seen_memory;
+    e_ptr->progress_interval = progress_interval;
+    e_ptr->metrics_path = metrics_path;
+    if (types_string != NULL) {
+        set_enabled_rg_types(e_ptr, types_string);
+    }
+    if (max_events_string != NULL) {
+        set_max_events(e_ptr, max_events_string);
+    }
+    if (n_threads > 1 && n_samples == 0) {
+        fprintf(stderr, "Canonicalising derivative genomes on %d threads...\n", n_threads);
+        e_ptr->n_threads = n_threads;
+    }
+    if (strcmp(output_format, "binary") == 0) {
+        e_ptr->sink = create_binary_sink(stdout);
+    }
+    else if (strcmp(output_format, "count") == 0) {
+        e_ptr->sink = create_count_sink(MAX_DEPTH_NONDUP);
+    }
+    else if (strcmp(output_format, "null") == 0) {
+        e_ptr->sink = create_null_sink();
+    }
+    else if (strcmp(output_format, "text") != 0) {
+        fprintf(stderr, "Output must be one of text, binary, count or null. Exiting.\n");
+        exit(1);
+    }
+    struct genome *g_ptr;
+
+    if ((TARGET != NULL) + (mitm_genome_string != NULL) + (n_samples > 0) > 1) {
+        fprintf(stderr, "Options --target, --mitm and --sample cannot be used together. Exiting.\n");
+        exit(1);
+    }
+    if (reduce_commuting && (mitm_genome_string != NULL || n_samples > 0)) {
+        fprintf(stderr, "Option --reduce-commuting cannot be used with --mitm or --sample. Exiting.\n");
+        exit(1);
+    }
+    e_ptr->reduce_commuting = reduce_commuting;
+    if (mitm_genome_string != NULL) {
+        for (i=0; i<N_RG_TYPES; i++) {
+            if (e_ptr->max_events[i] > 0 || (i == INV_DUP && e_ptr->max_events[i] != 0)) {
+                fprintf(stderr, "Option --mitm only supports disabling rearrangement types, not limiting them or enabling id. Exiting.\n");
+                exit(1);
+            }
+        }
+    }
+    if (n_processes > 1 || output_prefix != NULL) {  // A single worker with --output-prefix alone
+        if (output_prefix == NULL || (strcmp(output_format, "text") != 0 && strcmp(output_format, "binary") != 0)) {
+            fprintf(stderr, "Option --processes needs --output-prefix, and text or binary output. Exiting.\n");
+            exit(1);
+        }
+        if (TARGET != NULL || mitm_genome_string != NULL || n_samples > 0 || reduce_commuting || progress_interval > 0 || metrics_path != NULL) {
+            fprintf(stderr, "Option --processes cannot be used with --target, --mitm, --sample, --reduce-commuting, --progress or --metrics-file. Exiting.\n");
+            exit(1);
+        }
+        if (e_ptr->sink != NULL) {
+            delete_sink(e_ptr->sink);
+            e_ptr->sink = NULL;
+        }
+        if (shared_memory > 0) {
+            fprintf(stderr, "Enumerating on %d processes sharing %ld MB, writing to %s.<worker>...\n", n_processes, shared_memory, output_prefix);
+        }
+        else {
+            fprintf(stderr, "Enumerating on %d processes partitioning the seen genomes, writing to %s.<worker>...\n", n_processes, output_prefix);
+        }
+        fprintf(stderr, "Visited %ld derivative genomes.\n", run_workers(e_ptr, n_processes, shared_memory, output_prefix, strcmp(output_format, "binary") == 0));
+        delete_engine(e_ptr);
+        return(0);
+    }
+    start_engine(e_ptr);
+
+    if (n_samples > 0) {
+        fprintf(stderr, "Sampling %ld histories with seed %u on %d thread(s)...\n", n_samples, seed, n_threads);
+        run_sampler(n_samples, seed, rates_string, n_threads);
+    }
+    else if (mitm_genome_string != NULL) {
+        fprintf(stderr, "Found %d histories producing the target genome.\n", mitm_search(mitm_genome_string));
+    }
+    else if (TARGET == NULL) {
+        g_ptr = create_genome(N_CHRS, IS_DIPLOID);
+        bridge(g_ptr);
+    }
+    else {
+        // Iterative deepening, so that only the minimal histories of the target are reported
+        int max_overall_depth = MAX_DEPTH_NONDUP;
+        for (MAX_DEPTH_NONDUP=1; MAX_DEPTH_NONDUP<=max_overall_depth; MAX_DEPTH_NONDUP++) {
+            fprintf(stderr, "Searching for target pattern '%s %s' at depth %d...\n", TARGET->cn_string, TARGET->rg_string, MAX_DEPTH_NONDUP);
+            forget_seen_genomes();
+            g_ptr = create_genome(N_CHRS, IS_DIPLOID);
+            bridge(g_ptr);
+            if (TARGET_N_FOUND > 0) {
+                break;
+            }
+        }
+        fprintf(stderr, "Found %d histories producing the target pattern.\n", TARGET_N_FOUND);
+        delete_target_pattern(TARGET);
+    }
+
+    if (n_samples > 0) {
+        finish_progress(progress, -1, -1);
+    }
+    else {
+        finish_progress(progress, g_hash_table_size(seen_somatic_genomes), (seen_budget == NULL ? -1 : seen_budget->n_bytes));
+    }
+
+    if (seen_budget != NULL && seen_budget->n_evicted > 0) {
+        fprintf(stderr, "Evicted %ld seen genomes to stay within %ld MB, their subtrees were explored again.\n", seen_budget->n_evicted, max_seen_memory);
+    }
+    stop_engine(e_ptr);
+    if (e_ptr->sink != NULL) {
+        if (strcmp(output_format, "count") == 0) {
+            struct genome_counts *counts = (struct genome_counts*)e_ptr->sink->data;
+            fprintf(stderr, "Visited %ld derivative genomes, %ld of them seen before, by depth", counts->n_visited, counts->n_seen);
+            for (i=1; i<=counts->max_depth; i++) {
+                fprintf(stderr, " %d:%ld", i, *(counts->n_by_depth+i));
+            }
+            fprintf(stderr, ".\n");
+        }
+        delete_sink(e_ptr->sink);
+    }
+    delete_engine(e_ptr);
 
     return(0);
 }
@@ -1,5 +1,6 @@
 /* defines the basic classes and functions needed for enumerating
    rearrangements. */
+#include "rg_enumerator.h"
 
 /*
     A chromosome is coded as a list of segments.
@@ -21,19 +22,35 @@ struct seg {
 struct chromosome {
     struct seg **root_seg;  /* A dynamic array of segment structs */
     int n_segs;
+    struct chromosome_info *info;  /* Interned data of the chromosome, NULL if not computed since the chromosome last changed */
+    int *used_bps;  /* IDs of the breakpoints of its genome that the chromosome ends at or joins unnaturally, see simplify_genome() */
+    int n_used_bps;  /* -1 if the chromosome is not counted in the bp_uses of its genome */
+    int used_bps_changed;  /* Whether the segments changed since used_bps was counted */
 };
-enum rg_type {
-    DEL,
-    TD,
-    INV_DUP,
-    INV,
-    TEL_BREAK,
-    FOLD_BACK,
-    BAL_TRANSLOC,
-    UNBAL_TRANSLOC,
-    WC_DUP,
-    WC_DEL,
-    WG_DUP
+
+/*
+    Chromosomes are interned in chromosome_store, keyed by their content. Data
+    derived from the content alone is computed once per distinct chromosome
+    and shared by all copies of it, so genome-level functions only need to
+    compute it for chromosomes changed by the latest event. Functions that
+    change a chromosome release c_ptr->info, see release_chromosome_info().
+    An entry counts the chromosomes pointing to it, and is freed with the
+    entry of its other orientation once neither has any, so the store only
+    holds the chromosomes of the genomes alive. Interning is guarded by
+    chromosome_store_lock, since genomes of a batch can be canonicalised on
+    several threads.
+*/
+struct chromosome_info {
+    char *key;        /* Content of the chromosome, also the key in chromosome_store */
+    int id;           /* Distinct chromosomes have distinct IDs, which are not reused */
+    int reverse_id;   /* ID of the same chromosome read in the other orientation */
+    struct chromosome_info *reverse;  /* Entry of the other orientation, itself for a palindromic chromosome */
+    int n_refs;       /* Chromosomes whose info is this entry */
+    GArray *seg_cns;  /* Copy number contribution, struct seg_cn for each distinct segment */
+};
+struct seg_cn {
+    char *seg_idx_string;
+    int cn[2];  /* Paternal and maternal copy number */
 };
 char* rg_type_to_txt(enum rg_type rg) {
     switch(rg) {
@@ -50,6 +67,26 @@ char* rg_type_to_txt(enum rg_type rg) {
         case WG_DUP : return("wgd");
     }
 }
+// Inverse of rg_type_to_txt(), -1 if txt is not the name of a type
+int txt_to_rg_type(char *txt) {
+    int rg;
+    for (rg=0; rg<N_RG_TYPES; rg++) {
+        if (strcmp(rg_type_to_txt(rg), txt) == 0) {
+            return(rg);
+        }
+    }
+    return(-1);
+}
+int rg_type_is_dup(enum rg_type rg) {
+    switch(rg) {
+        case TD        : return(1);
+        case INV_DUP   : return(1);
+        case FOLD_BACK : return(1);
+        case WC_DUP    : return(1);
+        case WG_DUP    : return(1);
+        default        : return(0);
+    }
+}
 struct genome {
     struct chromosome **root_chr;  /* A dynamic array of chromosome structs */
     int n_chrs;
@@ -60,37 +97,71 @@ struct genome {
     int depth;  /* how many events have happened in this genome so far? */
     int dup_depth;  /* Number of duplicative events happened in this genome so far? */
     int wgd_depth;
+    int *canonical_chr_ids;  /* Interned IDs of the chromosomes as read in the last unique genome string of this genome or its parent */
+    int n_canonical_chrs;
+    int *canonical_wt_chr_reversed;  /* Whether each WT chromosome was read reversed in that unique genome string */
+    int n_canonical_wt_chrs;
+    guint64 sleep_set[N_RG_TYPES];  /* Chromosomes whose events of each type are not enumerated, see is_sleeping_block() */
+    int *bp_ids;  /* ID of the breakpoint after each of genome_segs, NULL until simplify_genome() counts the breakpoint uses */
+    int *bp_uses;  /* Number of chromosome ends and unnatural joins at each breakpoint ID */
+    int n_bp_ids;
 };
 
 extern int MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
-
-#define MAX_TIMES_DIVIDED 256
+extern struct genome_sink *SINK;  /* Receives the genomes of the print functions */
+extern GHashTable *chromosome_store;
+extern GMutex chromosome_store_lock;
+extern int chromosome_store_next_id;
 
 /*
     Function prototypes
 */
 struct seg* create_seg(int name, int is_maternal);
 struct seg* copy_seg(struct seg* s_ptr);
+struct seg* copy_seg_piece(struct seg* s_ptr, int piece, int split_into);
 void delete_seg(struct seg* s_ptr);
 struct chromosome* create_chromosome(int name, int is_maternal);
 struct chromosome* copy_chromosome(struct chromosome* c_ptr);
 void delete_chromosome(struct chromosome* c_ptr);
+void get_chromosome_key(struct chromosome *c_ptr, int reversed, GString *key);
+int is_palindromic_chromosome(struct chromosome *c_ptr);
+struct chromosome_info* create_chromosome_info(struct chromosome *c_ptr, char *key);
+struct chromosome_info* get_chromosome_info(struct chromosome *c_ptr);
+void release_chromosome_info(struct chromosome *c_ptr);
+void delete_chromosome_info(struct chromosome_info *info);
+void clear_chromosome_store();
 struct genome* create_genome(int n_chrs, int paired);
 struct genome* copy_genome(struct genome* g_ptr);
+struct genome* copy_genome_with_chr(struct genome* g_ptr, int c_idx, struct chromosome *c_ptr);
+struct genome* copy_genome_part(struct genome* g_ptr, int c1_idx, int c2_idx);
 void delete_genome(struct genome* g_ptr);
 void lose_chromosome_in_genome(struct genome* g_ptr, int c_idx);
+void count_used_bps(struct genome *g_ptr, struct chromosome *c_ptr, int sign);
+void forget_bp_uses(struct genome *g_ptr);
+void get_used_bps(struct genome *g_ptr, struct chromosome *c_ptr);
 
+int int_array_cmp(int len1, int *val1, int len2, int *val2);
 void splice_one_seg(struct chromosome *c_ptr, int seg_idx, int split_into);
 void splice_all_segs(struct genome *g_ptr, int *seg_indexes, int times_divided, int split_into);
+void splice_genome_segs(struct genome *g_ptr, int *seg_indexes, int times_divided, int split_into);
 void delete_segs_from_chr(struct chromosome *c_ptr, int from, int to);
+int seg_indexes_cmp(int len1, int *val1, int len2, int *val2);
+int find_genome_seg_idx(struct genome *g_ptr, struct seg *s_ptr);
 void _validate_genome(struct genome *g_ptr, char *source);
 void _validate_chromosome(struct chromosome *c_ptr, char *source);
 void _validate_seg(struct seg *s_ptr, char *source);
 
-void int_arr_to_string(int* int_arr, int arr_size, char *dest);
+void int_arr_to_string(int* int_arr, int arr_size, GString *dest);
+void get_rg_pattern(struct genome* g_ptr, GString *cn_string, GString *rg_string);
 void print_genome(struct genome* g_ptr, char *unique_genome_string);
-
-void get_unique_genome_string(struct genome *g_ptr, char *out_string_ptr);
+void print_genome_with_pattern(struct genome* g_ptr, char *cn_string, char *rg_string, char *unique_genome_string);
+void print_child_with_pattern(struct genome* g_ptr, enum rg_type rg, int idx, char *cn_string, char *rg_string, char *unique_genome_string);
+
+void get_unique_genome_string(struct genome *g_ptr, GString *out_string);
+int get_unique_genome_string_bounded(struct genome* g_ptr, char *upper_bound, GString *out_string);
+void get_genome_string_in_parent_order(struct genome *g_ptr, GString *out_string);
+int exceeds_upper_bound(GString *cur_string, char *upper_bound);
+struct genome* genome_from_unique_genome_string(char *genome_string);
 /*
     End function prototypes
 */
@@ -107,6 +178,11 @@ struct genome* create_genome(int n_chrs, int paired) {
         exit(1);
     }
     g_ptr->n_chrs = (paired ? 2 * n_chrs : n_chrs);
+    g_ptr->canonical_chr_ids = g_ptr->canonical_wt_chr_reversed = NULL;
+    g_ptr->n_canonical_chrs = g_ptr->n_canonical_wt_chrs = 0;
+    memset(g_ptr->sleep_set, 0, sizeof(g_ptr->sleep_set));
+    g_ptr->bp_ids = g_ptr->bp_uses = NULL;
+    g_ptr->n_bp_ids = 0;
     if (n_chrs == 0) {
         g_ptr->root_chr = NULL;
         return(g_ptr);
@@ -148,6 +224,16 @@ struct genome* create_genome(int n_chrs, int paired) {
 }
 
 struct genome* copy_genome(struct genome* g_ptr) {
+    return(copy_genome_with_chr(g_ptr, -1, NULL));
+}
+
+/*
+    Copies *g_ptr, but with *c_ptr, which is taken over, in place of chromosome
+    c_idx, which is not copied. Enumerators that build the changed chromosome
+    from scratch use this to spare copying the old one. Copies all the
+    chromosomes if c_idx is -1.
+*/
+struct genome* copy_genome_with_chr(struct genome* g_ptr, int c_idx, struct chromosome *c_ptr) {
     // _validate_genome(g_ptr, "copy_genome()");
     int i;
 
@@ -157,6 +243,7 @@ struct genome* copy_genome(struct genome* g_ptr) {
         exit(1);
     }
     new_g_ptr->n_chrs = g_ptr->n_chrs;
+    memcpy(new_g_ptr->sleep_set, g_ptr->sleep_set, sizeof(g_ptr->sleep_set));  // Until the event is known, see handle_next_step()
 
     // Copy rearrangement history over
     if (g_ptr->depth > 0) {
@@ -184,6 +271,21 @@ struct genome* copy_genome(struct genome* g_ptr) {
     new_g_ptr->dup_depth = g_ptr->dup_depth;
     new_g_ptr->wgd_depth = g_ptr->wgd_depth;
 
+    // Copy the canonical labeling, which children use to speed up their own
+    new_g_ptr->n_canonical_chrs = g_ptr->n_canonical_chrs;
+    new_g_ptr->n_canonical_wt_chrs = g_ptr->n_canonical_wt_chrs;
+    new_g_ptr->canonical_chr_ids = new_g_ptr->canonical_wt_chr_reversed = NULL;
+    if (g_ptr->canonical_chr_ids != NULL) {
+        new_g_ptr->canonical_chr_ids = malloc(g_ptr->n_canonical_chrs * sizeof(int));
+        new_g_ptr->canonical_wt_chr_reversed = malloc(g_ptr->n_canonical_wt_chrs * sizeof(int));
+        if (new_g_ptr->canonical_chr_ids == NULL || new_g_ptr->canonical_wt_chr_reversed == NULL) {
+            fprintf(stderr, "\nCreation of canonical labeling failed in copy_genome(). Exiting.\n");
+            exit(1);
+        }
+        memcpy(new_g_ptr->canonical_chr_ids, g_ptr->canonical_chr_ids, g_ptr->n_canonical_chrs * sizeof(int));
+        memcpy(new_g_ptr->canonical_wt_chr_reversed, g_ptr->canonical_wt_chr_reversed, g_ptr->n_canonical_wt_chrs * sizeof(int));
+    }
+
     /* Copy the genome_segs */
     new_g_ptr->n_genome_segs = g_ptr->n_genome_segs;
     new_g_ptr->genome_segs = malloc(new_g_ptr->n_genome_segs * sizeof(struct seg*));
@@ -195,6 +297,20 @@ struct genome* copy_genome(struct genome* g_ptr) {
         *(new_g_ptr->genome_segs+i) = copy_seg(*(g_ptr->genome_segs+i));
     }
 
+    // Copy the breakpoint uses, which spare simplify_genome() recounting the unchanged chromosomes
+    new_g_ptr->n_bp_ids = g_ptr->n_bp_ids;
+    new_g_ptr->bp_ids = new_g_ptr->bp_uses = NULL;
+    if (g_ptr->bp_ids != NULL) {
+        new_g_ptr->bp_ids = malloc(g_ptr->n_genome_segs * sizeof(int));
+        new_g_ptr->bp_uses = malloc(g_ptr->n_bp_ids * sizeof(int));
+        if (new_g_ptr->bp_ids == NULL || new_g_ptr->bp_uses == NULL) {
+            fprintf(stderr, "\nCreation of breakpoint uses failed in copy_genome(). Exiting.\n");
+            exit(1);
+        }
+        memcpy(new_g_ptr->bp_ids, g_ptr->bp_ids, g_ptr->n_genome_segs * sizeof(int));
+        memcpy(new_g_ptr->bp_uses, g_ptr->bp_uses, g_ptr->n_bp_ids * sizeof(int));
+    }
+
     new_g_ptr->root_chr = malloc(g_ptr->n_chrs*sizeof(struct chromosome*));
     if (new_g_ptr->root_chr == NULL) {
         fprintf(stderr, "\nCreation of root_chr node failed. Exiting.\n");
@@ -207,14 +323,53 @@ struct genome* copy_genome(struct genome* g_ptr) {
         return(new_g_ptr);
     }
     else {
+        struct chromosome *old_c_ptr, *new_c_ptr;
         for (i = 0; i < g_ptr->n_chrs; i++) {
-            *(new_g_ptr->root_chr+i) = copy_chromosome(*(g_ptr->root_chr+i));
+            old_c_ptr = *(g_ptr->root_chr+i);
+            if (i == c_idx) {
+                *(new_g_ptr->root_chr+i) = c_ptr;
+                count_used_bps(new_g_ptr, old_c_ptr, -1);
+                continue;
+            }
+            new_c_ptr = copy_chromosome(old_c_ptr);
+            *(new_g_ptr->root_chr+i) = new_c_ptr;
+            if (g_ptr->bp_ids != NULL && old_c_ptr->n_used_bps >= 0) {  // Still counted in the copied bp_uses
+                new_c_ptr->used_bps = malloc(old_c_ptr->n_used_bps * sizeof(int));
+                if (new_c_ptr->used_bps == NULL) {
+                    fprintf(stderr, "\nCreation of used_bps failed in copy_genome(). Exiting.\n");
+                    exit(1);
+                }
+                memcpy(new_c_ptr->used_bps, old_c_ptr->used_bps, old_c_ptr->n_used_bps * sizeof(int));
+                new_c_ptr->n_used_bps = old_c_ptr->n_used_bps;
+                new_c_ptr->used_bps_changed = old_c_ptr->used_bps_changed;
+            }
         }
     }
 
     return(new_g_ptr);
 }
 
+/*
+    Copies *g_ptr with only chromosome c1_idx, and c2_idx unless it is -1.
+    Segments and history are kept, the canonical labeling is not.
+*/
+struct genome* copy_genome_part(struct genome* g_ptr, int c1_idx, int c2_idx) {
+    struct chromosome *part_chrs[2];
+    struct genome part = *g_ptr;
+
+    part_chrs[0] = *(g_ptr->root_chr+c1_idx);
+    part_chrs[1] = (c2_idx < 0 ? NULL : *(g_ptr->root_chr+c2_idx));
+    part.root_chr = part_chrs;
+    part.n_chrs = (c2_idx < 0 ? 1 : 2);
+    part.canonical_chr_ids = part.canonical_wt_chr_reversed = NULL;
+    part.n_canonical_chrs = part.n_canonical_wt_chrs = 0;
+    part.bp_ids = part.bp_uses = NULL;  // The uses of the other chromosomes are not in the part
+    part.n_bp_ids = 0;
+    memset(part.sleep_set, 0, sizeof(part.sleep_set));  // Indexed like the chromosomes of *g_ptr
+
+    return(copy_genome(&part));
+}
+
 void delete_genome(struct genome* g_ptr) {
     // _validate_genome(g_ptr, "delete_genome()");
     int i;
@@ -228,6 +383,10 @@ void delete_genome(struct genome* g_ptr) {
     free(g_ptr->genome_segs);
     free(g_ptr->history);
     free(g_ptr->history_idx);
+    free(g_ptr->canonical_chr_ids);
+    free(g_ptr->canonical_wt_chr_reversed);
+    free(g_ptr->bp_ids);
+    free(g_ptr->bp_uses);
     free(g_ptr);
     return;
 }
@@ -236,6 +395,7 @@ void lose_chromosome_in_genome(struct genome* g_ptr, int c_idx) {
     // _validate_genome(g_ptr, "lose_chromosome_in_genome()");
     
     // Delete the chromosome and shift the pointers in g_ptr->root_chr
+    count_used_bps(g_ptr, *(g_ptr->root_chr+c_idx), -1);
     delete_chromosome(*(g_ptr->root_chr+c_idx));
     while (c_idx <= g_ptr->n_chrs - 2) {
         *(g_ptr->root_chr+c_idx) = *(g_ptr->root_chr+c_idx+1);
@@ -267,12 +427,9 @@ void make_history(struct genome *g_ptr, enum rg_type rg, int idx) {  /* Make his
     }
     *(g_ptr->history_idx+g_ptr->depth-1) = idx;
 
-    switch(rg) {
-        case TD        : g_ptr->dup_depth++; break;
-        case INV_DUP   : g_ptr->dup_depth++; break;
-        case FOLD_BACK : g_ptr->dup_depth++; break;
-        case WC_DUP    : g_ptr->dup_depth++; break;
-        case WG_DUP    : g_ptr->wgd_depth++; g_ptr->dup_depth++; break;
+    g_ptr->dup_depth += rg_type_is_dup(rg);
+    if (rg == WG_DUP) {
+        g_ptr->wgd_depth++;
     }
 
     return;
@@ -299,6 +456,10 @@ struct chromosome* create_chromosome(int name, int is_maternal) {
         exit(1);
     }
     *(c_ptr->root_seg+0) = create_seg(name, is_maternal);
+    c_ptr->info = NULL;
+    c_ptr->used_bps = NULL;
+    c_ptr->n_used_bps = -1;
+    c_ptr->used_bps_changed = 0;
 
     return(c_ptr);
 }
@@ -328,6 +489,13 @@ struct chromosome* copy_chromosome(struct chromosome* c_ptr) {
     for (i = 0; i < c_ptr->n_segs; i++) {
         *(new_c_ptr->root_seg + i) = copy_seg(*(c_ptr->root_seg + i));
     }
+    new_c_ptr->info = c_ptr->info;  // Interned data is shared
+    if (new_c_ptr->info != NULL) {
+        __atomic_add_fetch(&(new_c_ptr->info->n_refs), 1, __ATOMIC_RELAXED);
+    }
+    new_c_ptr->used_bps = NULL;  // A copy is a new chromosome to the breakpoint uses, see copy_genome_with_chr()
+    new_c_ptr->n_used_bps = -1;
+    new_c_ptr->used_bps_changed = 0;
 
     return(new_c_ptr);
 }
@@ -339,10 +507,196 @@ void delete_chromosome(struct chromosome* c_ptr) {
     for (i=0; i<c_ptr->n_segs; i++) {
         delete_seg(*(c_ptr->root_seg+i));
     }
+    release_chromosome_info(c_ptr);
     free(c_ptr->root_seg);
+    free(c_ptr->used_bps);
     free(c_ptr);
     return;
 }
+
+void get_chromosome_key(struct chromosome *c_ptr, int reversed, GString *key) {
+    GString *seg_idx_string = g_string_new(NULL);
+    struct seg *s_ptr;
+    int s_idx;
+
+    g_string_truncate(key, 0);
+    for (s_idx=0; s_idx<c_ptr->n_segs; s_idx++) {
+        s_ptr = *(c_ptr->root_seg + (reversed ? c_ptr->n_segs-1-s_idx : s_idx));
+        int_arr_to_string(s_ptr->seg_indexes, s_ptr->times_divided, seg_idx_string);
+        g_string_append_len(key, seg_idx_string->str, seg_idx_string->len);
+        g_string_append_c(key, ',');
+        g_string_append_c(key, '0' + s_ptr->is_maternal);
+        g_string_append_c(key, ',');
+        g_string_append_c(key, '0' + (reversed ? s_ptr->is_plus ^ 1 : s_ptr->is_plus));
+        g_string_append_c(key, ';');
+    }
+
+    g_string_free(seg_idx_string, 1);
+    return;
+}
+
+/*
+    Whether *c_ptr reads the same in both orientations, as the chromosomes
+    made by fold-backs do, so that its reverse key is its key.
+*/
+int is_palindromic_chromosome(struct chromosome *c_ptr) {
+    struct seg *s1_ptr, *s2_ptr;
+    int s_idx;
+
+    for (s_idx=0; s_idx<=(c_ptr->n_segs-1)/2; s_idx++) {
+        s1_ptr = *(c_ptr->root_seg+s_idx);
+        s2_ptr = *(c_ptr->root_seg+c_ptr->n_segs-1-s_idx);
+        if (s1_ptr->is_plus == s2_ptr->is_plus || s1_ptr->is_maternal != s2_ptr->is_maternal || !int_array_cmp(s1_ptr->times_divided, s1_ptr->seg_indexes, s2_ptr->times_divided, s2_ptr->seg_indexes)) {
+            return(0);
+        }
+    }
+    return(1);
+}
+
+struct chromosome_info* create_chromosome_info(struct chromosome *c_ptr, char *key) {
+    GString *seg_idx_string = g_string_new(NULL);
+    struct seg *s_ptr;
+    struct seg_cn new_seg_cn, *seg_cn_ptr;
+    int s_idx, i;
+
+    struct chromosome_info *info = malloc(sizeof(struct chromosome_info));
+    if (info == NULL) {
+        fprintf(stderr, "\nCreation of chromosome info failed. Exiting.\n");
+        exit(1);
+    }
+    info->key = g_strdup(key);
+    info->id = chromosome_store_next_id++;
+    info->reverse_id = info->id;
+    info->reverse = info;
+    info->n_refs = 0;
+
+    info->seg_cns = g_array_new(0, 0, sizeof(struct seg_cn));
+    for (s_idx=0; s_idx<c_ptr->n_segs; s_idx++) {
+        s_ptr = *(c_ptr->root_seg+s_idx);
+        int_arr_to_string(s_ptr->seg_indexes, s_ptr->times_divided, seg_idx_string);
+        for (i=0; i<info->seg_cns->len; i++) {
+            seg_cn_ptr = &g_array_index(info->seg_cns, struct seg_cn, i);
+            if (strcmp(seg_cn_ptr->seg_idx_string, seg_idx_string->str) == 0) {
+                break;
+            }
+        }
+        if (i == info->seg_cns->len) {
+            new_seg_cn.seg_idx_string = g_strdup(seg_idx_string->str);
+            new_seg_cn.cn[0] = new_seg_cn.cn[1] = 0;
+            g_array_append_val(info->seg_cns, new_seg_cn);
+            seg_cn_ptr = &g_array_index(info->seg_cns, struct seg_cn, i);
+        }
+        seg_cn_ptr->cn[s_ptr->is_maternal] += 1;
+    }
+    g_string_free(seg_idx_string, 1);
+
+    g_hash_table_insert(chromosome_store, info->key, info);
+    return(info);
+}
+
+/*
+    Returns the interned data of *c_ptr, which keeps a reference to it until
+    it changes or is deleted.
+*/
+struct chromosome_info* get_chromosome_info(struct chromosome *c_ptr) {
+    if (c_ptr->info != NULL) {
+        return(c_ptr->info);
+    }
+
+    struct chromosome_info *info, *reverse_info;
+    GString *key = g_string_new(NULL);
+    get_chromosome_key(c_ptr, 0, key);
+    g_mutex_lock(&chromosome_store_lock);
+    info = (struct chromosome_info*)g_hash_table_lookup(chromosome_store, key->str);
+    if (info == NULL) {
+        info = create_chromosome_info(c_ptr, key->str);
+
+        // Intern the other orientation as well, unless it is the same
+        if (!is_palindromic_chromosome(c_ptr)) {
+            get_chromosome_key(c_ptr, 1, key);
+            reverse_info = (struct chromosome_info*)g_hash_table_lookup(chromosome_store, key->str);
+            if (reverse_info == NULL) {
+                reverse_info = create_chromosome_info(c_ptr, key->str);
+            }
+            info->reverse_id = reverse_info->id;
+            reverse_info->reverse_id = info->id;
+            info->reverse = reverse_info;
+            reverse_info->reverse = info;
+        }
+    }
+    __atomic_add_fetch(&(info->n_refs), 1, __ATOMIC_RELAXED);
+    g_mutex_unlock(&chromosome_store_lock);
+    g_string_free(key, 1);
+
+    c_ptr->info = info;
+    return(info);
+}
+
+/*
+    Drops the reference of *c_ptr to its interned data, if any, as it is
+    about to change or be deleted. Only a count that can reach 0 needs
+    chromosome_store_lock: the entry cannot be freed while c_ptr holds it,
+    and other references are only taken from it, or under the lock.
+*/
+void release_chromosome_info(struct chromosome *c_ptr) {
+    struct chromosome_info *info = c_ptr->info;
+    int n_refs;
+
+    if (info == NULL) {
+        return;
+    }
+    c_ptr->info = NULL;
+    n_refs = __atomic_load_n(&(info->n_refs), __ATOMIC_RELAXED);
+    while (n_refs > 1) {
+        if (__atomic_compare_exchange_n(&(info->n_refs), &n_refs, n_refs - 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+
+    g_mutex_lock(&chromosome_store_lock);
+    if (__atomic_sub_fetch(&(info->n_refs), 1, __ATOMIC_RELAXED) == 0 && __atomic_load_n(&(info->reverse->n_refs), __ATOMIC_RELAXED) == 0) {
+        if (info->reverse != info) {
+            g_hash_table_remove(chromosome_store, info->reverse->key);
+            delete_chromosome_info(info->reverse);
+        }
+        g_hash_table_remove(chromosome_store, info->key);
+        delete_chromosome_info(info);
+    }
+    g_mutex_unlock(&chromosome_store_lock);
+
+    return;
+}
+
+void delete_chromosome_info(struct chromosome_info *info) {
+    int i;
+    for (i=0; i<info->seg_cns->len; i++) {
+        g_free(g_array_index(info->seg_cns, struct seg_cn, i).seg_idx_string);
+    }
+    g_array_free(info->seg_cns, 1);
+    g_free(info->key);
+    free(info);
+    return;
+}
+
+/*
+    Frees all the interned chromosome data, so that IDs start from 0 again.
+    Only allowed when no genome is left.
+*/
+void clear_chromosome_store() {
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_mutex_lock(&chromosome_store_lock);
+    g_hash_table_iter_init(&iter, chromosome_store);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        g_hash_table_iter_remove(&iter);
+        delete_chromosome_info((struct chromosome_info*)value);
+    }
+    chromosome_store_next_id = 0;
+    g_mutex_unlock(&chromosome_store_lock);
+
+    return;
+}
 /*
     End chromosome functions
 */
@@ -396,6 +750,32 @@ struct seg* copy_seg(struct seg* s_ptr) {
     return(new_s_ptr);
 }
 
+/*
+    Copy of the piece at position piece of *s_ptr, as splice_one_seg() makes it
+    when splitting *s_ptr into split_into pieces.
+*/
+struct seg* copy_seg_piece(struct seg* s_ptr, int piece, int split_into) {
+    struct seg *new_s_ptr = malloc(sizeof(struct seg));
+    if (new_s_ptr == NULL) {
+        fprintf(stderr, "\nCreation of seg node failed. Exiting.\n");
+        exit(1);
+    }
+
+    new_s_ptr->times_divided = s_ptr->times_divided + 1;
+    new_s_ptr->seg_indexes = malloc(new_s_ptr->times_divided * sizeof(int));
+    if (new_s_ptr->seg_indexes == NULL) {
+        fprintf(stderr, "\nCreation of seg indexes nodes failed. Exiting.\n");
+        exit(1);
+    }
+    memcpy(new_s_ptr->seg_indexes, s_ptr->seg_indexes, s_ptr->times_divided * sizeof(int));
+    *(new_s_ptr->seg_indexes + s_ptr->times_divided) = s_ptr->is_plus ? piece : split_into - 1 - piece;
+
+    new_s_ptr->is_plus = s_ptr->is_plus;
+    new_s_ptr->is_maternal = s_ptr->is_maternal;
+
+    return(new_s_ptr);
+}
+
 void delete_seg (struct seg* s_ptr) {
     char diagnostic_info[256] = "delete_seg()";
     // _validate_seg(s_ptr, diagnostic_info);
@@ -416,11 +796,16 @@ int int_array_cmp(int len1, int *val1, int len2, int *val2) {
     return(1);
 }
 
-/* Below function splices only one segment */
+/*
+    Below function splices only one segment. The pieces are joined naturally
+    and the breakpoints at the ends of the segment keep their IDs, see
+    splice_genome_segs(), so the breakpoints the chromosome uses do not change.
+*/
 void splice_one_seg(struct chromosome *c_ptr, int seg_idx, int split_into) {
     char diagnostic_info[256] = "splice_one_seg()";
     // _validate_chromosome(c_ptr, diagnostic_info);
 
+    release_chromosome_info(c_ptr);
     c_ptr->n_segs += split_into - 1;
     c_ptr->root_seg = realloc(c_ptr->root_seg, c_ptr->n_segs * sizeof(struct seg*));
     if (c_ptr->root_seg == NULL) {
@@ -461,7 +846,7 @@ void splice_all_segs(struct genome *g_ptr, int *seg_indexes, int times_divided,
     // _validate_genome(g_ptr, diagnostic_info);
 
     struct chromosome *cur_c_ptr;
-    struct seg *cur_s_ptr, *tmp_s_ptr;
+    struct seg *cur_s_ptr;
     int c_idx, s_idx;
     for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {  /* Loop through all chromosomes */
         cur_c_ptr = *(g_ptr->root_chr+c_idx);
@@ -480,17 +865,25 @@ void splice_all_segs(struct genome *g_ptr, int *seg_indexes, int times_divided,
         }
     }
 
+    splice_genome_segs(g_ptr, seg_indexes, times_divided, split_into);
+    return;
+}
+
+/* Splices only g_ptr->genome_segs, see splice_all_segs() */
+void splice_genome_segs(struct genome *g_ptr, int *seg_indexes, int times_divided, int split_into) {
+    char diagnostic_info[256];
+    struct seg *cur_s_ptr, *tmp_s_ptr;
+    int s_idx;
 
-    // Splice genome_segs
     g_ptr->n_genome_segs += split_into - 1;
     g_ptr->genome_segs = realloc(g_ptr->genome_segs, g_ptr->n_genome_segs * sizeof(struct seg*));
     if (g_ptr->genome_segs == NULL) {
-        fprintf(stderr, "\nFailed to realloc g_ptr->genome_segs in function splice_all_segs(). Exiting.\n");
+        fprintf(stderr, "\nFailed to realloc g_ptr->genome_segs in function splice_genome_segs(). Exiting.\n");
         exit(1);
     }
     for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
         cur_s_ptr = *(g_ptr->genome_segs+s_idx);
-        sprintf(diagnostic_info, "splice_all_segs(), genome_segs s_idx %d", s_idx);
+        sprintf(diagnostic_info, "splice_genome_segs(), genome_segs s_idx %d", s_idx);
         // _validate_seg(cur_s_ptr, diagnostic_info);
 
         /* This segment has to be spliced? */
@@ -508,12 +901,30 @@ void splice_all_segs(struct genome *g_ptr, int *seg_indexes, int times_divided,
                 tmp_s_ptr->times_divided += 1;
                 tmp_s_ptr->seg_indexes = realloc(tmp_s_ptr->seg_indexes, tmp_s_ptr->times_divided * sizeof(int));
                 if (tmp_s_ptr->seg_indexes == NULL) {
-                    fprintf(stderr, "Failed to realloc seg_indexes in function splice_all_segs(). Exiting.\n");
+                    fprintf(stderr, "Failed to realloc seg_indexes in function splice_genome_segs(). Exiting.\n");
                     exit(1);
                 }   
                 *(tmp_s_ptr->seg_indexes + tmp_s_ptr->times_divided - 1) = i;
             }   
 
+            // The breakpoint after the segment is now after its last piece, and the ones between the pieces are new
+            if (g_ptr->bp_ids != NULL) {
+                g_ptr->bp_ids = realloc(g_ptr->bp_ids, g_ptr->n_genome_segs * sizeof(int));
+                g_ptr->bp_uses = realloc(g_ptr->bp_uses, (g_ptr->n_bp_ids + split_into - 1) * sizeof(int));
+                if (g_ptr->bp_ids == NULL || g_ptr->bp_uses == NULL) {
+                    fprintf(stderr, "\nFailed to realloc breakpoint uses in function splice_genome_segs(). Exiting.\n");
+                    exit(1);
+                }
+                for (i=g_ptr->n_genome_segs-1; i>=s_idx+split_into-1; i--) {
+                    *(g_ptr->bp_ids+i) = *(g_ptr->bp_ids+i-split_into+1);
+                }
+                for (i=0; i<split_into-1; i++) {
+                    *(g_ptr->bp_ids+s_idx+i) = g_ptr->n_bp_ids;
+                    *(g_ptr->bp_uses+g_ptr->n_bp_ids) = 0;
+                    g_ptr->n_bp_ids++;
+                }
+            }
+
             break;
         }   
     }
@@ -531,6 +942,8 @@ void delete_segs_from_chr(struct chromosome *c_ptr, int from, int to) {
         return;
     }
 
+    release_chromosome_info(c_ptr);
+    c_ptr->used_bps_changed = 1;
     struct seg **segs_ptr = c_ptr->root_seg;
     int del_len = to - from + 1;
     int i;
@@ -562,6 +975,8 @@ struct chromosome* yank_segments(struct chromosome *c_ptr, int from, int to) {
 void insert_segs_into_chr(struct chromosome *c_ptr, struct chromosome *segs_to_insert, int insert_before) {
     // _validate_chromosome(c_ptr, "insert_segs_int_chr(), c_ptr");
     // _validate_chromosome(segs_to_insert, "insert_segs_int_chr(), segs_to_insert");
+    release_chromosome_info(c_ptr);
+    c_ptr->used_bps_changed = 1;
     c_ptr->n_segs += segs_to_insert->n_segs;
     c_ptr->root_seg = realloc(c_ptr->root_seg, c_ptr->n_segs * sizeof(struct seg*));
     if (c_ptr->root_seg == NULL) {
@@ -585,6 +1000,8 @@ void insert_segs_into_chr(struct chromosome *c_ptr, struct chromosome *segs_to_i
 
 void invert_segs_in_chr(struct chromosome *c_ptr, int from, int to) {
     // _validate_chromosome(c_ptr, "invert_segs_in_chr()");
+    release_chromosome_info(c_ptr);
+    c_ptr->used_bps_changed = 1;
     struct seg **segs = malloc((to - from + 1) * sizeof(struct seg*));
     if (segs == NULL) {
         fprintf(stderr, "\nFailed to malloc segs in invert_segs_in_chr(). Exiting.\n");
@@ -644,209 +1061,221 @@ void key_destroyed(gpointer data) {
     free(data);
 }
 
-void simplify_genome(struct genome *g_ptr) {
-    // Strategy:
-    // 1. Find out which segment breakpoints are not used anymore
-    // 2. Join segments at such breakpoints
-    // 3. Rename segments
-
-    int c_idx, s_idx, *s_idx_ptr;
-
-    // Get the indexes of each genome_segs member
-    char *string_to_be_stored;
-    char seg_idx_string[MAX_TIMES_DIVIDED];  // Acts as a temporary string holder for the function
-    GHashTable* idx_of_seg = g_hash_table_new_full(g_str_hash, g_str_equal, (GDestroyNotify)key_destroyed, g_free);
-    for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
-        int_arr_to_string(
-            (*(g_ptr->genome_segs+s_idx))->seg_indexes,
-            (*(g_ptr->genome_segs+s_idx))->times_divided,
-            seg_idx_string
-        );
+/*
+    Compares the segment indexes of two segments in the order of g_ptr->genome_segs,
+    which is always sorted by segment indexes.
+*/
+int seg_indexes_cmp(int len1, int *val1, int len2, int *val2) {
+    int i;
+    for (i=0; i<len1 && i<len2; i++) {
+        if (*(val1+i) != *(val2+i)) { return(*(val1+i) < *(val2+i) ? -1 : 1); }
+    }
+    return(len1 == len2 ? 0 : (len1 < len2 ? -1 : 1));
+}
 
-        // Initiate hash for segment indexes
-        string_to_be_stored = g_strdup(seg_idx_string);
-        s_idx_ptr = malloc(sizeof(int));
-        if (s_idx_ptr == NULL) {
-            fprintf(stderr, "\nFailed to malloc s_idx_ptr in simplify_genome(). Exiting.\n");
-            exit(1);
-        }
-        *s_idx_ptr = s_idx;
-        g_hash_table_insert(
-            idx_of_seg,
-            string_to_be_stored,
-            s_idx_ptr
+/* Index of *s_ptr in g_ptr->genome_segs by binary search */
+int find_genome_seg_idx(struct genome *g_ptr, struct seg *s_ptr) {
+    int low = 0, high = g_ptr->n_genome_segs - 1, mid, cmp;
+    while (low <= high) {
+        mid = (low + high) / 2;
+        cmp = seg_indexes_cmp(
+            s_ptr->times_divided, s_ptr->seg_indexes,
+            (*(g_ptr->genome_segs+mid))->times_divided, (*(g_ptr->genome_segs+mid))->seg_indexes
         );
+        if (cmp == 0) { return(mid); }
+        else if (cmp < 0) { high = mid - 1; }
+        else { low = mid + 1; }
     }
 
-    // Arrays for remembering which joins are not used, and which segments are completely deleted. 
-    int *has_only_natural_joins_with_next, *has_only_natural_joins_with_prev;
-    has_only_natural_joins_with_next = malloc(g_ptr->n_genome_segs * sizeof(int));
-    if (has_only_natural_joins_with_next == NULL) {
-        fprintf(stderr, "\nFailed to malloc has_only_natural_joins_with_next in simplify_genome(). Exiting.\n");
-        exit(1);
+    fprintf(stderr, "Segment not found in g_ptr->genome_segs in find_genome_seg_idx(). Exiting.\n");
+    exit(1);
+}
+
+/*
+    Adds sign times the uses of the breakpoints in c_ptr->used_bps to
+    g_ptr->bp_uses, if the chromosome is counted there.
+*/
+void count_used_bps(struct genome *g_ptr, struct chromosome *c_ptr, int sign) {
+    int i;
+    if (g_ptr->bp_ids == NULL || c_ptr->n_used_bps < 0) {
+        return;
     }
-    for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
-        *(has_only_natural_joins_with_next+s_idx) = 1;
+    for (i=0; i<c_ptr->n_used_bps; i++) {
+        *(g_ptr->bp_uses + *(c_ptr->used_bps+i)) += sign;
     }
-    has_only_natural_joins_with_prev = malloc(g_ptr->n_genome_segs * sizeof(int));
-    if (has_only_natural_joins_with_prev == NULL) {
-        fprintf(stderr, "\nFailed to malloc has_only_natural_joins_with_prev in simplify_genome(). Exiting.\n");
+}
+
+/* Drops the breakpoint uses of *g_ptr, for changes to g_ptr->genome_segs they do not follow */
+void forget_bp_uses(struct genome *g_ptr) {
+    free(g_ptr->bp_ids);
+    free(g_ptr->bp_uses);
+    g_ptr->bp_ids = g_ptr->bp_uses = NULL;
+    g_ptr->n_bp_ids = 0;
+}
+
+/*
+    Sets c_ptr->used_bps to the IDs of the breakpoints that the chromosome
+    ends at or joins unnaturally, with one entry per use.
+*/
+void get_used_bps(struct genome *g_ptr, struct chromosome *c_ptr) {
+    int s_idx, seg1_idx, seg2_idx, n_used_bps = 0;
+    struct seg *s1_ptr, *s2_ptr;
+
+    c_ptr->used_bps = realloc(c_ptr->used_bps, 2 * (c_ptr->n_segs + 1) * sizeof(int));  // Both ends and both sides of each join at most
+    if (c_ptr->used_bps == NULL) {
+        fprintf(stderr, "\nFailed to realloc c_ptr->used_bps in get_used_bps(). Exiting.\n");
         exit(1);
     }
-    for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
-        *(has_only_natural_joins_with_prev+s_idx) = 1;
+
+    // The breakpoint after (is_after) or before segment seg_idx of g_ptr->genome_segs in reference orientation
+    void add_used_bp(int seg_idx, int is_after) {
+        if (is_after) {
+            *(c_ptr->used_bps + n_used_bps++) = *(g_ptr->bp_ids+seg_idx);
+        }
+        else if (seg_idx > 0) {
+            *(c_ptr->used_bps + n_used_bps++) = *(g_ptr->bp_ids+seg_idx-1);
+        }
     }
 
     // First and last segment of each chromosome do not have respective natural joins
-    struct chromosome *c_ptr;
-    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
-        c_ptr = *(g_ptr->root_chr+c_idx);
+    s1_ptr = *(c_ptr->root_seg+0);
+    seg1_idx = find_genome_seg_idx(g_ptr, s1_ptr);
+    add_used_bp(seg1_idx, !s1_ptr->is_plus);
+    for (s_idx=0; s_idx<c_ptr->n_segs-1; s_idx++) {
+        s2_ptr = *(c_ptr->root_seg+s_idx+1);
+        seg2_idx = find_genome_seg_idx(g_ptr, s2_ptr);
+        if (!(
+            (
+                (seg1_idx + 1 == seg2_idx && s1_ptr->is_plus == 1 && s2_ptr->is_plus == 1) ||
+                (seg1_idx - 1 == seg2_idx && s1_ptr->is_plus == 0 && s2_ptr->is_plus == 0)
+            ) &&
+            s1_ptr->is_maternal == s2_ptr->is_maternal  // Both segments must be of the same parental origin
+        )) {
+            add_used_bp(seg1_idx, s1_ptr->is_plus);
+            add_used_bp(seg2_idx, !s2_ptr->is_plus);
+        }
+        s1_ptr = s2_ptr;
+        seg1_idx = seg2_idx;
+    }
+    add_used_bp(seg1_idx, s1_ptr->is_plus);
 
-        s_idx = 0;
-        int_arr_to_string((*(c_ptr->root_seg+s_idx))->seg_indexes, (*(c_ptr->root_seg+s_idx))->times_divided, seg_idx_string);
-        s_idx_ptr = (int*)g_hash_table_lookup(idx_of_seg, seg_idx_string);
+    c_ptr->n_used_bps = n_used_bps;
+    c_ptr->used_bps_changed = 0;
+}
 
-        if ( (*(c_ptr->root_seg+s_idx))->is_plus == 1 ) {
-            *(has_only_natural_joins_with_prev+*s_idx_ptr) = 0;
-            if (*s_idx_ptr > 0) {
-                *(has_only_natural_joins_with_next+*s_idx_ptr-1) = 0;
-            }
-        }
-        else {
-            *(has_only_natural_joins_with_next+*s_idx_ptr) = 0;
-            if (*s_idx_ptr < g_ptr->n_genome_segs-1) {
-                *(has_only_natural_joins_with_prev+*s_idx_ptr+1) = 0;
-            }
-        }
+void simplify_genome(struct genome *g_ptr) {
+    // Strategy:
+    // 1. Count the uses of the segment breakpoints
+    // 2. Join segments at unused breakpoints
+    //
+    // A breakpoint is used if a chromosome ends at it or joins it unnaturally.
+    // The counts in g_ptr->bp_uses are copied from the parent genome, so only
+    // the chromosomes changed or added by the last event are recounted, and
+    // the chromosomes are only rewritten if a count dropped to zero.
+    // Breakpoints keep their IDs through splices and joins, so the
+    // used_bps of the chromosomes stay valid.
 
-        s_idx = c_ptr->n_segs - 1;
-        int_arr_to_string((*(c_ptr->root_seg+s_idx))->seg_indexes, (*(c_ptr->root_seg+s_idx))->times_divided, seg_idx_string);
-        s_idx_ptr = (int*)g_hash_table_lookup(idx_of_seg, seg_idx_string);
+    int c_idx, s_idx, i;
+    struct chromosome *c_ptr;
 
-        if ( (*(c_ptr->root_seg+s_idx))->is_plus == 1 ) {
-            *(has_only_natural_joins_with_next+*s_idx_ptr) = 0;
-            if (*s_idx_ptr < g_ptr->n_genome_segs-1) {
-                *(has_only_natural_joins_with_prev+*s_idx_ptr+1) = 0;
-            }
+    if (g_ptr->bp_ids == NULL) {
+        g_ptr->n_bp_ids = g_ptr->n_genome_segs;
+        g_ptr->bp_ids = malloc(g_ptr->n_genome_segs * sizeof(int));
+        g_ptr->bp_uses = malloc(g_ptr->n_genome_segs * sizeof(int));
+        if (g_ptr->bp_ids == NULL || g_ptr->bp_uses == NULL) {
+            fprintf(stderr, "\nFailed to malloc breakpoint uses in simplify_genome(). Exiting.\n");
+            exit(1);
         }
-        else {
-            *(has_only_natural_joins_with_prev+*s_idx_ptr) = 0;
-            if (*s_idx_ptr > 0) {
-                *(has_only_natural_joins_with_next+*s_idx_ptr-1) = 0;
-            }
+        for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
+            *(g_ptr->bp_ids+s_idx) = s_idx;
+            *(g_ptr->bp_uses+s_idx) = 0;
+        }
+        for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+            (*(g_ptr->root_chr+c_idx))->n_used_bps = -1;
         }
     }
-    
 
-    // Find out which unnatural breakpoints are there in the dataset
-    int seg1_idx, seg2_idx;
     for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
         c_ptr = *(g_ptr->root_chr+c_idx);
-
-        for (s_idx=0; s_idx<c_ptr->n_segs-1; s_idx++) {
-            int_arr_to_string((*(c_ptr->root_seg+s_idx))->seg_indexes, (*(c_ptr->root_seg+s_idx))->times_divided, seg_idx_string);
-            s_idx_ptr = (int*)g_hash_table_lookup(idx_of_seg, seg_idx_string);
-            seg1_idx = *s_idx_ptr;
-            int_arr_to_string((*(c_ptr->root_seg+s_idx+1))->seg_indexes, (*(c_ptr->root_seg+s_idx+1))->times_divided, seg_idx_string);
-            s_idx_ptr = (int*)g_hash_table_lookup(idx_of_seg, seg_idx_string);
-            seg2_idx = *s_idx_ptr;
-
-            if (!(
-                (
-                    (seg1_idx + 1 == seg2_idx && (*(c_ptr->root_seg+s_idx))->is_plus == 1 && (*(c_ptr->root_seg+s_idx+1))->is_plus == 1) ||
-                    (seg1_idx - 1 == seg2_idx && (*(c_ptr->root_seg+s_idx))->is_plus == 0 && (*(c_ptr->root_seg+s_idx+1))->is_plus == 0)
-                ) &&
-                (*(c_ptr->root_seg+s_idx))->is_maternal == (*(c_ptr->root_seg+s_idx+1))->is_maternal  // Both segments must be of the same parental origin
-            )) {
-                if ((*(c_ptr->root_seg+s_idx))->is_plus == 1) {
-                    *(has_only_natural_joins_with_next+seg1_idx) = 0;
-                    if (seg1_idx < g_ptr->n_genome_segs - 1) {
-                        *(has_only_natural_joins_with_prev+seg1_idx+1) = 0;  // Added bugfix 2014-09-12
-                    }
-                }
-                else {
-                    *(has_only_natural_joins_with_prev+seg1_idx) = 0;
-                    if (seg1_idx > 0) {
-                        *(has_only_natural_joins_with_next+seg1_idx-1) = 0;  // Added bugfix 2014-09-12
-                    }
-                }
-                if ((*(c_ptr->root_seg+s_idx+1))->is_plus == 1) {
-                    *(has_only_natural_joins_with_prev+seg2_idx) = 0;
-                    if (seg2_idx > 0) {
-                        *(has_only_natural_joins_with_next+seg2_idx-1) = 0;  // Added bugfix 2014-09-12
-                    }
-                }
-                else {
-                    *(has_only_natural_joins_with_next+seg2_idx) = 0;
-                    if (seg2_idx < g_ptr->n_genome_segs - 1) {
-                        *(has_only_natural_joins_with_prev+seg2_idx+1) = 0;  // Added bugfix 2014-09-12
-                    }
-                }
-            }
+        if (c_ptr->n_used_bps >= 0 && !c_ptr->used_bps_changed) {
+            continue;
         }
+        count_used_bps(g_ptr, c_ptr, -1);
+        get_used_bps(g_ptr, c_ptr);
+        count_used_bps(g_ptr, c_ptr, 1);
     }
 
-    // Merge segments, first in g_ptr->n_genome_segs and then in each chromosome.
+    // Merge segments, first in each chromosome and then in g_ptr->genome_segs.
     // In each run of segments to be merged, only the first one is kept. 
+    int n_removed = 0;
+    for (s_idx=1; s_idx<g_ptr->n_genome_segs; s_idx++) {
+        n_removed += (
+            *(g_ptr->bp_uses + *(g_ptr->bp_ids+s_idx-1)) == 0 &&
+            *((*(g_ptr->genome_segs+s_idx-1))->seg_indexes) == *((*(g_ptr->genome_segs+s_idx))->seg_indexes)
+        );
+    }
+    if (n_removed == 0) {
+        return;
+    }
+
     int *index_to_be_removed = malloc(g_ptr->n_genome_segs * sizeof(int));
     if (index_to_be_removed == NULL) {
         fprintf(stderr, "\nFailed to malloc index_to_be_removed in simplify_genome(). Exiting.\n");
         exit(1);
     }
-    for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
-        *(index_to_be_removed+s_idx) = 0;
-    }
-    for (s_idx=g_ptr->n_genome_segs-2; s_idx>=0; s_idx--) {
-        if (
-            (*(has_only_natural_joins_with_next+s_idx)==1 && *(has_only_natural_joins_with_prev+s_idx+1)==1) &&
-            *((*(g_ptr->genome_segs+s_idx))->seg_indexes) == *((*(g_ptr->genome_segs+s_idx+1))->seg_indexes)
-        ) {
-            delete_seg(*(g_ptr->genome_segs+s_idx+1));
-            int i;
-            for (i=s_idx+1; i<g_ptr->n_genome_segs-1; i++) {
-                *(g_ptr->genome_segs+i) = *(g_ptr->genome_segs+i+1);
-            }
-            g_ptr->n_genome_segs--;
-            *(index_to_be_removed+s_idx+1) = 1;
-        }
-    }
-    g_ptr->genome_segs = realloc(g_ptr->genome_segs, g_ptr->n_genome_segs * sizeof(struct seg*));
-    if (g_ptr->genome_segs == NULL) {
-        fprintf(stderr, "Failed to realloc g_ptr->genome_segs in simplify_genome(). Exiting.\n");
-        exit(1);
+    *(index_to_be_removed+0) = 0;
+    for (s_idx=1; s_idx<g_ptr->n_genome_segs; s_idx++) {
+        *(index_to_be_removed+s_idx) = (
+            *(g_ptr->bp_uses + *(g_ptr->bp_ids+s_idx-1)) == 0 &&
+            *((*(g_ptr->genome_segs+s_idx-1))->seg_indexes) == *((*(g_ptr->genome_segs+s_idx))->seg_indexes)
+        );
     }
 
     for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
         c_ptr = *(g_ptr->root_chr+c_idx);
-    
-        for (s_idx=c_ptr->n_segs-1; s_idx>=0; s_idx--) {
-            int_arr_to_string((*(c_ptr->root_seg+s_idx))->seg_indexes, (*(c_ptr->root_seg+s_idx))->times_divided, seg_idx_string);
-            s_idx_ptr = (int*)g_hash_table_lookup(idx_of_seg, seg_idx_string);
-            if (!(*(index_to_be_removed+*s_idx_ptr))) {
-                continue;
-            }
 
-            delete_seg(*(c_ptr->root_seg+s_idx));
-            int i;
-            for (i=s_idx; i<c_ptr->n_segs-1; i++) {
-                *(c_ptr->root_seg+i) = *(c_ptr->root_seg+i+1);
+        i = 0;
+        for (s_idx=0; s_idx<c_ptr->n_segs; s_idx++) {
+            if (*(index_to_be_removed + find_genome_seg_idx(g_ptr, *(c_ptr->root_seg+s_idx)))) {
+                delete_seg(*(c_ptr->root_seg+s_idx));
+            }
+            else {
+                *(c_ptr->root_seg+i) = *(c_ptr->root_seg+s_idx);
+                i++;
             }
-
-            c_ptr->n_segs--;
         }
-
-        c_ptr->root_seg = realloc(c_ptr->root_seg, c_ptr->n_segs * sizeof(struct seg*));
-        if (c_ptr->root_seg == NULL) {
-            fprintf(stderr, "Failed to realloc c_ptr->root_seg in simplify_genome(). Exiting.\n");
-            exit(1);
+        if (i < c_ptr->n_segs) {
+            c_ptr->n_segs = i;
+            release_chromosome_info(c_ptr);  // The used breakpoints stay the same
+            c_ptr->root_seg = realloc(c_ptr->root_seg, c_ptr->n_segs * sizeof(struct seg*));
+            if (c_ptr->root_seg == NULL) {
+                fprintf(stderr, "Failed to realloc c_ptr->root_seg in simplify_genome(). Exiting.\n");
+                exit(1);
+            }
         }
     }
 
+    // A kept segment ends at the breakpoint after the last segment of its run
+    i = 0;
+    for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
+        if (*(index_to_be_removed+s_idx)) {
+            delete_seg(*(g_ptr->genome_segs+s_idx));
+            *(g_ptr->bp_ids+i-1) = *(g_ptr->bp_ids+s_idx);
+        }
+        else {
+            *(g_ptr->genome_segs+i) = *(g_ptr->genome_segs+s_idx);
+            *(g_ptr->bp_ids+i) = *(g_ptr->bp_ids+s_idx);
+            i++;
+        }
+    }
+    g_ptr->n_genome_segs = i;
+    g_ptr->genome_segs = realloc(g_ptr->genome_segs, g_ptr->n_genome_segs * sizeof(struct seg*));
+    g_ptr->bp_ids = realloc(g_ptr->bp_ids, g_ptr->n_genome_segs * sizeof(int));
+    if (g_ptr->genome_segs == NULL || g_ptr->bp_ids == NULL) {
+        fprintf(stderr, "Failed to realloc g_ptr->genome_segs in simplify_genome(). Exiting.\n");
+        exit(1);
+    }
 
-    // Free memory
-    g_hash_table_destroy(idx_of_seg);
-    free(has_only_natural_joins_with_prev);
-    free(has_only_natural_joins_with_next);
     free(index_to_be_removed);
 }
 /*
@@ -857,32 +1286,38 @@ void simplify_genome(struct genome *g_ptr) {
 /*
     Functions for printing genomes
 */
-void int_arr_to_string(int* int_arr, int arr_size, char *dest) {
-    if (arr_size > MAX_TIMES_DIVIDED) {
-        fprintf(stderr, "\nin int_arr_to_string() int arr_size > MAX_TIMES_DIVIDED. Exiting.\n");
-        exit(1);
+/*
+    Writes the segment indexes int_arr into *dest as a hash key. Each index is
+    written in base 26, least significant digit first, with 'a'-'z' for all
+    but the last digit and 'A'-'Z' for the last one. The encoding is prefix
+    free, so keys of different segments never collide whatever the number
+    of segments or the number of times they were divided.
+*/
+void int_arr_to_string(int* int_arr, int arr_size, GString *dest) {
+    int i, idx;
+    g_string_truncate(dest, 0);
+    for (i=0; i<arr_size; i++) {
+        idx = *(int_arr+i);
+        while (idx >= 26) {
+            g_string_append_c(dest, 'a' + idx % 26);
+            idx /= 26;
+        }
+        g_string_append_c(dest, 'A' + idx);
     }
 
-    // OBS: char *dest assumed to be lenth MAX_TIMES_DIVIDED
-
-    int i;
-    for (i=0; i<arr_size; i++) {
-        if (*(int_arr+i) > 61) {
-            fprintf(stderr, "Segment index >61 at *(int_arr+%d) in function int_arr_to_string(). Exiting.\n", i);
-            exit(1);
-        }
-        *(dest+i) = 65 + *(int_arr+i);
-    }
-    *(dest+arr_size) = '\0';
-
     return;
 }
 
-void print_genome(struct genome* g_ptr, char *unique_genome_string) {
-    // _validate_genome(g_ptr, "print_genome()");
+/*
+    Builds the rearrangement pattern string of a genome, i.e. the allelic copy
+    number portion (output column 3) into *cn_string and the rearrangement
+    portion (output column 4) into *rg_string. Both GStrings are overwritten.
+*/
+void get_rg_pattern(struct genome* g_ptr, GString *cn_string, GString *rg_string) {
+    // _validate_genome(g_ptr, "get_rg_pattern()");
 
     int c_idx, s_idx, *cn_ptr;
-    char seg_idx_string[MAX_TIMES_DIVIDED];  // Acts as a temporary string holder for the function
+    GString *seg_idx_string = g_string_new(NULL);  // Acts as a temporary string holder for the function
     char *string_to_be_stored;
     char diagnostic_info[256];
 
@@ -901,7 +1336,7 @@ void print_genome(struct genome* g_ptr, char *unique_genome_string) {
             (*(g_ptr->genome_segs+s_idx))->times_divided,
             seg_idx_string
         );
-        string_to_be_stored = g_strdup(seg_idx_string);
+        string_to_be_stored = g_strdup(seg_idx_string->str);
 
         // Initiate hash for CNs
         cn_ptr = malloc(2 * sizeof(int));
@@ -918,7 +1353,7 @@ void print_genome(struct genome* g_ptr, char *unique_genome_string) {
         );
 
         // Initiate hash for segment indexes
-        string_to_be_stored = g_strdup(seg_idx_string);
+        string_to_be_stored = g_strdup(seg_idx_string->str);
         cn_ptr = malloc(sizeof(int));  // Use cn_ptr because too lazy to create another pointer
         if (cn_ptr == NULL) {
             fprintf(stderr, "\nFailed to malloc cn_ptr in print_genome(). Exiting.\n");
@@ -934,6 +1369,8 @@ void print_genome(struct genome* g_ptr, char *unique_genome_string) {
 
     struct chromosome *c_ptr;
     struct seg *s_ptr;
+    struct chromosome_info *info;
+    struct seg_cn *seg_cn_ptr;
     int *seg_2_idx_ptr;
     int prev_seg_idx, prev_seg_is_plus;
     struct rg {
@@ -950,18 +1387,25 @@ void print_genome(struct genome* g_ptr, char *unique_genome_string) {
         sprintf(diagnostic_info, "print_genome(), c_idx = %d", c_idx);
         c_ptr = *(g_ptr->root_chr+c_idx);
         // _validate_chromosome(c_ptr, diagnostic_info); 
+
+        // Update copy number for segments from the interned contribution of the chromosome
+        info = get_chromosome_info(c_ptr);
+        for (s_idx=0; s_idx<info->seg_cns->len; s_idx++) {
+            seg_cn_ptr = &g_array_index(info->seg_cns, struct seg_cn, s_idx);
+            cn_ptr = (int*)g_hash_table_lookup(cn_of_seg, seg_cn_ptr->seg_idx_string);
+            *(cn_ptr+0) += seg_cn_ptr->cn[0];
+            *(cn_ptr+1) += seg_cn_ptr->cn[1];
+        }
+
         for (s_idx=0; s_idx<c_ptr->n_segs; s_idx++) {
-            // Update copy number for segment
             sprintf(diagnostic_info, "print_genome(), c_idx = %d, s_idx = %d", c_idx, s_idx);
             s_ptr = *(c_ptr->root_seg+s_idx);
             // _validate_seg(s_ptr, diagnostic_info);
 
             int_arr_to_string(s_ptr->seg_indexes, s_ptr->times_divided, seg_idx_string);
-            cn_ptr = (int*)g_hash_table_lookup(cn_of_seg, seg_idx_string);
-            *(cn_ptr + s_ptr->is_maternal) += 1;
 
             // Save the current transition (potential rearrangement) between segments
-            seg_2_idx_ptr = (int*)g_hash_table_lookup(idx_of_seg, seg_idx_string);
+            seg_2_idx_ptr = (int*)g_hash_table_lookup(idx_of_seg, seg_idx_string->str);
             if (s_idx != 0) {
                 cur_rg.seg1_idx = prev_seg_idx;
                 cur_rg.seg1_is_plus = prev_seg_is_plus;
@@ -987,37 +1431,19 @@ void print_genome(struct genome* g_ptr, char *unique_genome_string) {
         }
     }
 
-    // Print out current detailed history
+    // Copy numbers for each segment
     int i;
-    for (i=0; i<g_ptr->depth; i++) {
-        printf(
-            "%s%d%s",
-            rg_type_to_txt(*(g_ptr->history+i)),
-            *(g_ptr->history_idx+i),
-            (i == g_ptr->depth - 1 ? " " : "-")
-        );
-    }
-
-    // Print out current history
-    for (i=0; i<g_ptr->depth; i++) {
-        printf(
-            "%s%s",
-            rg_type_to_txt(*(g_ptr->history+i)),
-            (i == g_ptr->depth - 1 ? " " : "-")
-        );
-    }
-    
-    // Print out copy numbers for each segment
     char separator;
+    g_string_truncate(cn_string, 0);
     for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
         int_arr_to_string(
             (*(g_ptr->genome_segs+s_idx))->seg_indexes,
             (*(g_ptr->genome_segs+s_idx))->times_divided,
             seg_idx_string
         );
-        cn_ptr = (int*)g_hash_table_lookup(cn_of_seg, seg_idx_string);
+        cn_ptr = (int*)g_hash_table_lookup(cn_of_seg, seg_idx_string->str);
         if (s_idx == g_ptr->n_genome_segs - 1) {
-            separator = ' ';
+            separator = '\0';
         }
         else if (
             *((*(g_ptr->genome_segs+s_idx  ))->seg_indexes+0) ==
@@ -1028,15 +1454,18 @@ void print_genome(struct genome* g_ptr, char *unique_genome_string) {
         else {
             separator = ';';
         }
-        printf(
-            "%d,%d%c",
+        g_string_append_printf(
+            cn_string,
+            "%d,%d",
             *(cn_ptr+0),  // Paternal allele CN
-            *(cn_ptr+1),  // Maternal allele CN
-            separator
+            *(cn_ptr+1)   // Maternal allele CN
         );
+        if (separator != '\0') {
+            g_string_append_c(cn_string, separator);
+        }
     }
 
-    // Print out current rearrangements
+    // Current rearrangements
     gint rgs_sort_fun(gconstpointer a, gconstpointer b) {
         struct rg *a_rg = (struct rg*)a;
         struct rg *b_rg = (struct rg*)b;
@@ -1099,6 +1528,7 @@ void print_genome(struct genome* g_ptr, char *unique_genome_string) {
     g_array_sort(rgs, (GCompareFunc)rgs_sort_fun);
     struct rg prev_rg;
     prev_rg.seg1_idx = prev_rg.seg2_idx = prev_rg.seg1_is_plus = prev_rg.seg2_is_plus = -1;
+    g_string_truncate(rg_string, 0);
     for (i=0; i<rgs->len; i++) {
         cur_rg = g_array_index(rgs, struct rg, i);
         // if (!is_rg(&cur_rg) || rg_eq(&cur_rg, &prev_rg)) {
@@ -1108,19 +1538,12 @@ void print_genome(struct genome* g_ptr, char *unique_genome_string) {
         if (rg_eq(&prev_rg, &cur_rg)) {
             continue;
         }
-        if (prev_rg.seg1_idx != -1) { printf("/"); }
-        printf("%d%s,%d%s", cur_rg.seg1_idx, (cur_rg.seg1_is_plus ? "+" : "-"), cur_rg.seg2_idx, (cur_rg.seg2_is_plus ? "-" : "+"));
+        if (prev_rg.seg1_idx != -1) { g_string_append_c(rg_string, '/'); }
+        g_string_append_printf(rg_string, "%d%s,%d%s", cur_rg.seg1_idx, (cur_rg.seg1_is_plus ? "+" : "-"), cur_rg.seg2_idx, (cur_rg.seg2_is_plus ? "-" : "+"));
         prev_rg = cur_rg;
     }
 
-    // Print unique somatic genome string
-    // char out_genome_str[1000];
-    // get_unique_genome_string(g_ptr, out_genome_str);
-    // printf(" %s", out_genome_str);
-    printf(" %s", unique_genome_string);
-
-    printf("\n");
-
+    g_string_free(seg_idx_string, 1);
     g_hash_table_destroy(cn_of_seg);
     g_hash_table_destroy(idx_of_seg);
     if (rgs->len > 0) {
@@ -1132,6 +1555,49 @@ void print_genome(struct genome* g_ptr, char *unique_genome_string) {
     return;
 }
 
+void print_genome(struct genome* g_ptr, char *unique_genome_string) {
+    GString *cn_string = g_string_new(NULL);
+    GString *rg_string = g_string_new(NULL);
+    get_rg_pattern(g_ptr, cn_string, rg_string);
+    print_genome_with_pattern(g_ptr, cn_string->str, rg_string->str, unique_genome_string);
+    g_string_free(cn_string, 1);
+    g_string_free(rg_string, 1);
+
+    return;
+}
+
+/*
+    Same as print_genome(), but with the rearrangement pattern of *g_ptr
+    already rendered by get_rg_pattern(). The genome goes to SINK, which
+    writes the usual output line by default.
+*/
+void print_genome_with_pattern(struct genome* g_ptr, char *cn_string, char *rg_string, char *unique_genome_string) {
+    struct visited_genome v = {g_ptr->depth, g_ptr->dup_depth, g_ptr->history, g_ptr->history_idx, cn_string, rg_string, unique_genome_string, 0};
+    SINK->visit(SINK, &v);
+
+    return;
+}
+
+/*
+    Same as print_genome_with_pattern(), but for the child of *g_ptr produced
+    by the rearrangement rg with index idx, without building the child. The
+    child was seen before, so unique_genome_string is the detailed history of
+    the earlier visit.
+*/
+void print_child_with_pattern(struct genome* g_ptr, enum rg_type rg, int idx, char *cn_string, char *rg_string, char *unique_genome_string) {
+    enum rg_type history[g_ptr->depth + 1];
+    int history_idx[g_ptr->depth + 1];
+    memcpy(history, g_ptr->history, g_ptr->depth * sizeof(enum rg_type));
+    memcpy(history_idx, g_ptr->history_idx, g_ptr->depth * sizeof(int));
+    *(history+g_ptr->depth) = rg;
+    *(history_idx+g_ptr->depth) = idx;
+
+    struct visited_genome v = {g_ptr->depth + 1, g_ptr->dup_depth + rg_type_is_dup(rg), history, history_idx, cn_string, rg_string, unique_genome_string, 1};
+    SINK->visit(SINK, &v);
+
+    return;
+}
+
 void print_seg_full(struct seg *s_ptr) {
     printf("      times_divided: %d\n", s_ptr->times_divided);
     printf("      seg_indexes: ");
@@ -1218,12 +1684,17 @@ void print_genome_full(struct genome *g_ptr) {
 */
 
 struct genome_string_branch {
-    char cur_string[10000];
+    GString *cur_string;
     int n_somatic_chrs;
     int* somatic_chr_is_used;
-    GHashTable *map_of_encountered_segments;
+    int n_genome_segs;
+    struct map_seg_elements *seg_map;  /* Labels of the segments in genome_segs, same indexes, seg_id -1 if not encountered yet */
     int next_seg_id;
-    int wt_chr_lens[100];
+    int n_wt_chrs;
+    int* wt_chr_lens;  /* Lengths of the WT chromosomes used so far, n_wt_chrs_used of them */
+    int n_wt_chrs_used;
+    int *chr_order;  /* Somatic chromosomes used so far, one-based indexes, negative if read reversed */
+    int n_chrs_ordered;
 };
 
 struct map_seg_elements {
@@ -1232,25 +1703,6 @@ struct map_seg_elements {
     int maternal_is_paternal;
 };
 
-GHashTable* g_hash_table_copy(GHashTable* hash) {
-    GHashTable* new_hash = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
-    struct map_seg_elements *new_val;
-    char *new_key;
-    void iterator(gpointer key, gpointer val, gpointer h) {
-        new_key = g_strdup(key);
-        new_val = malloc(sizeof(struct map_seg_elements));
-        if (new_val == NULL) {
-            fprintf(stderr, "Failed to malloc new_val in g_hash_table_copy(). Exiting. \n");
-            exit(1);
-        }
-        *new_val = *((struct map_seg_elements*)val);
-        g_hash_table_insert(h, new_key, new_val);
-    }
-    g_hash_table_foreach(hash, (GHFunc)iterator, new_hash);
-
-    return(new_hash);
-}
-
 struct genome_string_branch* create_genome_string_branch(struct genome *g_ptr) {
     struct genome_string_branch *gsb_ptr = malloc(sizeof(struct genome_string_branch));
 
@@ -1268,14 +1720,32 @@ struct genome_string_branch* create_genome_string_branch(struct genome *g_ptr) {
     for (i=0; i<g_ptr->n_chrs; i++) {
         *(gsb_ptr->somatic_chr_is_used+i) = 0;
     }
-    gsb_ptr->map_of_encountered_segments = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
-    gsb_ptr->cur_string[0] = '\0';
+    gsb_ptr->n_genome_segs = g_ptr->n_genome_segs;
+    gsb_ptr->seg_map = malloc(gsb_ptr->n_genome_segs * sizeof(struct map_seg_elements));
+    if (gsb_ptr->seg_map == NULL) {
+        fprintf(stderr, "malloc of gsb_ptr->seg_map failed in create_genome_string_branch(). Exiting. \n");
+        exit(1);
+    }
+    for (i=0; i<gsb_ptr->n_genome_segs; i++) {
+        (gsb_ptr->seg_map+i)->seg_id = -1;
+    }
+    gsb_ptr->chr_order = malloc(gsb_ptr->n_somatic_chrs * sizeof(int));
+    if (gsb_ptr->chr_order == NULL) {
+        fprintf(stderr, "malloc of gsb_ptr->chr_order failed in create_genome_string_branch(). Exiting. \n");
+        exit(1);
+    }
+    gsb_ptr->n_chrs_ordered = 0;
+    gsb_ptr->cur_string = g_string_new(NULL);
     gsb_ptr->next_seg_id = 0;
 
-    // Initiate these values as well
-    for (i=0; i<100; i++) {
-        *(gsb_ptr->wt_chr_lens+i) = 0;
+    // Segment indexes are sorted, so the last segment belongs to the last WT chromosome
+    gsb_ptr->n_wt_chrs = *((*(g_ptr->genome_segs+g_ptr->n_genome_segs-1))->seg_indexes+0) + 1;
+    gsb_ptr->wt_chr_lens = malloc(gsb_ptr->n_wt_chrs * sizeof(int));
+    if (gsb_ptr->wt_chr_lens == NULL) {
+        fprintf(stderr, "malloc of gsb_ptr->wt_chr_lens failed in create_genome_string_branch(). Exiting. \n");
+        exit(1);
     }
+    gsb_ptr->n_wt_chrs_used = 0;
 
     return(gsb_ptr);
 }
@@ -1287,7 +1757,7 @@ struct genome_string_branch* copy_genome_string_branch(struct genome_string_bran
         exit(1);
     }
 
-    strcpy(new_gsb_ptr->cur_string, gsb_ptr->cur_string);
+    new_gsb_ptr->cur_string = g_string_new_len(gsb_ptr->cur_string->str, gsb_ptr->cur_string->len);
 
     new_gsb_ptr->n_somatic_chrs = gsb_ptr->n_somatic_chrs;
     new_gsb_ptr->somatic_chr_is_used = malloc(new_gsb_ptr->n_somatic_chrs * sizeof(int));
@@ -1295,201 +1765,132 @@ struct genome_string_branch* copy_genome_string_branch(struct genome_string_bran
         fprintf(stderr, "malloc of new_gsb_ptr->somatic_chr_is_used failed in copy_genome_string_branch(). Exiting. \n");
         exit(1);
     }
+    memcpy(new_gsb_ptr->somatic_chr_is_used, gsb_ptr->somatic_chr_is_used, new_gsb_ptr->n_somatic_chrs * sizeof(int));
 
-    // Below doesn't work. WHY???
-    // memcpy(new_gsb_ptr->somatic_chr_is_used, gsb_ptr->somatic_chr_is_used, sizeof(int) * new_gsb_ptr->n_somatic_chrs);
-    int i;
-    for (i=0; i<new_gsb_ptr->n_somatic_chrs; i++) {
-        *(new_gsb_ptr->somatic_chr_is_used+i) = *(gsb_ptr->somatic_chr_is_used+i);
+    new_gsb_ptr->n_genome_segs = gsb_ptr->n_genome_segs;
+    new_gsb_ptr->seg_map = malloc(new_gsb_ptr->n_genome_segs * sizeof(struct map_seg_elements));
+    if (new_gsb_ptr->seg_map == NULL) {
+        fprintf(stderr, "malloc of new_gsb_ptr->seg_map failed in copy_genome_string_branch(). Exiting. \n");
+        exit(1);
     }
+    memcpy(new_gsb_ptr->seg_map, gsb_ptr->seg_map, new_gsb_ptr->n_genome_segs * sizeof(struct map_seg_elements));
 
-    new_gsb_ptr->next_seg_id = gsb_ptr->next_seg_id;
-    memcpy(new_gsb_ptr->wt_chr_lens, gsb_ptr->wt_chr_lens, 100 * sizeof(int));
+    new_gsb_ptr->chr_order = malloc(new_gsb_ptr->n_somatic_chrs * sizeof(int));
+    if (new_gsb_ptr->chr_order == NULL) {
+        fprintf(stderr, "malloc of new_gsb_ptr->chr_order failed in copy_genome_string_branch(). Exiting. \n");
+        exit(1);
+    }
+    memcpy(new_gsb_ptr->chr_order, gsb_ptr->chr_order, gsb_ptr->n_chrs_ordered * sizeof(int));
+    new_gsb_ptr->n_chrs_ordered = gsb_ptr->n_chrs_ordered;
 
-    new_gsb_ptr->map_of_encountered_segments = g_hash_table_copy(gsb_ptr->map_of_encountered_segments);
+    new_gsb_ptr->next_seg_id = gsb_ptr->next_seg_id;
+    new_gsb_ptr->n_wt_chrs = gsb_ptr->n_wt_chrs;
+    new_gsb_ptr->wt_chr_lens = malloc(new_gsb_ptr->n_wt_chrs * sizeof(int));
+    if (new_gsb_ptr->wt_chr_lens == NULL) {
+        fprintf(stderr, "malloc of new_gsb_ptr->wt_chr_lens failed in copy_genome_string_branch(). Exiting. \n");
+        exit(1);
+    }
+    memcpy(new_gsb_ptr->wt_chr_lens, gsb_ptr->wt_chr_lens, gsb_ptr->n_wt_chrs_used * sizeof(int));
+    new_gsb_ptr->n_wt_chrs_used = gsb_ptr->n_wt_chrs_used;
 
     return(new_gsb_ptr);
 }
 
 void delete_genome_string_branch(struct genome_string_branch *gsb_ptr) {
+    g_string_free(gsb_ptr->cur_string, 1);
     free(gsb_ptr->somatic_chr_is_used);
-    g_hash_table_destroy(gsb_ptr->map_of_encountered_segments);
+    free(gsb_ptr->seg_map);
+    free(gsb_ptr->chr_order);
+    free(gsb_ptr->wt_chr_lens);
     free(gsb_ptr);
 
     return;
 }
 
-void iterate_segs_and_update_map(struct genome_string_branch *gsb_ptr, int s_idx, struct chromosome *c_ptr, GArray *nodes_array, struct genome *g_ptr) {
-    char seg_idx_string[MAX_TIMES_DIVIDED];  // Acts as a temporary string holder for the function
-    char new_string_to_be_cat[MAX_TIMES_DIVIDED];
-    int chr_name, maternal_is_paternal, cur_wt_chr_len, i;
-    struct genome_string_branch *new_gsb_ptr;
-    char *orig_key = NULL;
-    char **orig_key_ptr = &orig_key;
-    struct map_seg_elements *orig_val = NULL;
-    struct map_seg_elements **orig_val_ptr = &orig_val;
-    gboolean key_exists;
-    struct map_seg_elements *map_seg;
+/* Can no extension of cur_string be lexicographically at most upper_bound? */
+int exceeds_upper_bound(GString *cur_string, char *upper_bound) {
+    return(upper_bound != NULL && strncmp(cur_string->str, upper_bound, cur_string->len) > 0);
+}
 
-    int_arr_to_string((*(c_ptr->root_seg+s_idx))->seg_indexes, (*(c_ptr->root_seg+s_idx))->times_divided, seg_idx_string);
-    key_exists = g_hash_table_lookup_extended(gsb_ptr->map_of_encountered_segments, seg_idx_string, (gpointer*)orig_key_ptr, (gpointer*)orig_val_ptr);
-    map_seg = *orig_val_ptr;
-    if (key_exists) {
-        // Just calmly proceed to the next s_idx
-        sprintf(
-            new_string_to_be_cat,
-            "%d,%d,%d",
-            map_seg->seg_id,
-            (map_seg->maternal_is_paternal + (*(c_ptr->root_seg+s_idx))->is_maternal) % 2 == 1 ? 1 : 0,
-            (map_seg->reversed + (*(c_ptr->root_seg+s_idx))->is_plus) % 2 == 1 ? 0 : 1
-        );
-        strncat(gsb_ptr->cur_string, new_string_to_be_cat, strlen(new_string_to_be_cat));
+void iterate_segs_and_update_map(struct genome_string_branch *gsb_ptr, int s_idx, struct chromosome *c_ptr, GArray *nodes_array, struct genome *g_ptr, char *upper_bound) {
+    int chr_name, maternal_is_paternal, reversed, cur_wt_chr_len, first, last, i;
+    struct genome_string_branch *new_gsb_ptr;
+    struct seg *s_ptr = *(c_ptr->root_seg+s_idx);
+    int genome_seg_idx = find_genome_seg_idx(g_ptr, s_ptr);
+    struct map_seg_elements *map_seg = gsb_ptr->seg_map + genome_seg_idx;
 
-        // Was this last segment?
-        if (s_idx == c_ptr->n_segs - 1) {
-            strncat(gsb_ptr->cur_string, "}", 1);  // Close up somatic chromosome
-            g_array_append_val(nodes_array, gsb_ptr);  // This is the only place where new elements are added to nodes_array
-        }
-        else {
-            strncat(gsb_ptr->cur_string, ";", 1);  // Close up current segment
-            iterate_segs_and_update_map(gsb_ptr, s_idx+1, c_ptr, nodes_array, g_ptr);  // Pass the structure to handling the next segment
-        }
-    }
-    else {
+    if (map_seg->seg_id == -1) {
         // If the current segment has not been included as one of the included WT chromosomes
-        // yet, this has to be done first and creates two new WT chr branches
-        chr_name = *((*(c_ptr->root_seg+s_idx))->seg_indexes+0);
-        maternal_is_paternal = (*(c_ptr->root_seg+s_idx))->is_maternal;
-        
-        //
-        // In the first case, the WT chromosome is presented in its default orientation
-        new_gsb_ptr = copy_genome_string_branch(gsb_ptr);
-        cur_wt_chr_len = 0;
-
-        for (i=0; i<g_ptr->n_genome_segs; i++) {
-            if ( *((*(g_ptr->genome_segs+i))->seg_indexes+0) == chr_name ) {
-                int_arr_to_string((*(g_ptr->genome_segs+i))->seg_indexes, (*(g_ptr->genome_segs+i))->times_divided, seg_idx_string);
-                map_seg = malloc(sizeof(struct map_seg_elements));
-                if (map_seg == NULL) {
-                    fprintf(stderr, "Failed to malloc map_seg in iterate_segs_and_update_map(). Exiting.\n");
-                    exit(1);
-                }
+        // yet, this has to be done first and creates two new WT chr branches: in the first
+        // one the WT chromosome is presented in its default orientation, in the second one
+        // in reverse order. The segments of a WT chromosome are consecutive in genome_segs.
+        chr_name = *(s_ptr->seg_indexes+0);
+        maternal_is_paternal = s_ptr->is_maternal;
+        first = last = genome_seg_idx;
+        while (first > 0 && *((*(g_ptr->genome_segs+first-1))->seg_indexes+0) == chr_name) { first--; }
+        while (last < g_ptr->n_genome_segs-1 && *((*(g_ptr->genome_segs+last+1))->seg_indexes+0) == chr_name) { last++; }
+        cur_wt_chr_len = last - first + 1;
+
+        for (reversed=0; reversed<=1; reversed++) {
+            new_gsb_ptr = copy_genome_string_branch(gsb_ptr);
+            for (i=0; i<cur_wt_chr_len; i++) {
+                map_seg = new_gsb_ptr->seg_map + (reversed ? last-i : first+i);
                 map_seg->seg_id = new_gsb_ptr->next_seg_id++;
                 map_seg->maternal_is_paternal = maternal_is_paternal;
-                map_seg->reversed = 0;
-                g_hash_table_insert(new_gsb_ptr->map_of_encountered_segments, g_strdup(seg_idx_string), map_seg);
-                cur_wt_chr_len++;
+                map_seg->reversed = reversed;
             }
-        }
+            *(new_gsb_ptr->wt_chr_lens + new_gsb_ptr->n_wt_chrs_used++) = cur_wt_chr_len;
 
-        i = 0;
-        while (*(new_gsb_ptr->wt_chr_lens+i) != 0) { i++; }
-        *(new_gsb_ptr->wt_chr_lens+i) = cur_wt_chr_len;
-
-        // Now finally we can add the current segment to the string
-        int_arr_to_string((*(c_ptr->root_seg+s_idx))->seg_indexes, (*(c_ptr->root_seg+s_idx))->times_divided, seg_idx_string);
-        key_exists = g_hash_table_lookup_extended(new_gsb_ptr->map_of_encountered_segments, seg_idx_string, (gpointer*)orig_key_ptr, (gpointer*)orig_val_ptr);
-        map_seg = (struct map_seg_elements*)orig_val;
-        if (!key_exists) {
-            fprintf(stderr, "key_exists is FALSE unexpectedly. Exiting.\n");
-            exit(1);
-        }
-        sprintf(
-            new_string_to_be_cat,
-            "%d,%d,%d",
-            map_seg->seg_id,
-            (map_seg->maternal_is_paternal + (*(c_ptr->root_seg+s_idx))->is_maternal) % 2 == 1 ? 1 : 0,
-            (map_seg->reversed + (*(c_ptr->root_seg+s_idx))->is_plus) % 2 == 1 ? 0 : 1
-        );
-        strncat(new_gsb_ptr->cur_string, new_string_to_be_cat, strlen(new_string_to_be_cat));
-
-        // Was this last segment?
-        if (s_idx == c_ptr->n_segs - 1) {
-            strncat(new_gsb_ptr->cur_string, "}", 1);  // Close up somatic chromosome
-            g_array_append_val(nodes_array, new_gsb_ptr);  // This is the only place where new elements are added to nodes_array
-        }
-        else {
-            strncat(new_gsb_ptr->cur_string, ";", 1);  // Close up current segment
-            iterate_segs_and_update_map(new_gsb_ptr, s_idx+1, c_ptr, nodes_array, g_ptr);  // Pass the structure to handling the next segment
-        }
-        // End scenario 1
-        //
-
-
-        //
-        // In the second scenario, the WT chromosome is presented in reverse order
-        new_gsb_ptr = copy_genome_string_branch(gsb_ptr);
-        cur_wt_chr_len = 0;
-
-        for (i=g_ptr->n_genome_segs-1; i>=0; i--) {
-            if ( *((*(g_ptr->genome_segs+i))->seg_indexes+0) == chr_name ) {
-                int_arr_to_string((*(g_ptr->genome_segs+i))->seg_indexes, (*(g_ptr->genome_segs+i))->times_divided, seg_idx_string);
-                map_seg = malloc(sizeof(struct map_seg_elements));
-                if (map_seg == NULL) {
-                    fprintf(stderr, "Failed to malloc map_seg in iterate_segs_and_update_map(). Exiting.\n");
-                    exit(1);
-                }
-                map_seg->seg_id = new_gsb_ptr->next_seg_id++;
-                map_seg->maternal_is_paternal = maternal_is_paternal;
-                map_seg->reversed = 1;
-                g_hash_table_insert(new_gsb_ptr->map_of_encountered_segments, g_strdup(seg_idx_string), map_seg);
-                cur_wt_chr_len++;
-            }
-        }
-
-        i = 0;
-        while (*(new_gsb_ptr->wt_chr_lens+i) != 0) { i++; }
-        *(new_gsb_ptr->wt_chr_lens+i) = cur_wt_chr_len;
-
-        // Now finally we can add the current segment to the string
-        int_arr_to_string((*(c_ptr->root_seg+s_idx))->seg_indexes, (*(c_ptr->root_seg+s_idx))->times_divided, seg_idx_string);
-        key_exists = g_hash_table_lookup_extended(new_gsb_ptr->map_of_encountered_segments, seg_idx_string, (gpointer*)orig_key_ptr, (gpointer*)orig_val_ptr);
-        if (!key_exists) {
-            fprintf(stderr, "key_exists is FALSE unexpectedly. Exiting.\n");
-            exit(1);
+            // Now the current segment can be added to the string
+            iterate_segs_and_update_map(new_gsb_ptr, s_idx, c_ptr, nodes_array, g_ptr, upper_bound);
         }
-        map_seg = (struct map_seg_elements*)orig_val;
-        sprintf(
-            new_string_to_be_cat,
-            "%d,%d,%d",
-            map_seg->seg_id,
-            (map_seg->maternal_is_paternal + (*(c_ptr->root_seg+s_idx))->is_maternal) % 2 == 1 ? 1 : 0,
-            (map_seg->reversed + (*(c_ptr->root_seg+s_idx))->is_plus) % 2 == 1 ? 0 : 1
-        );
-        strncat(new_gsb_ptr->cur_string, new_string_to_be_cat, strlen(new_string_to_be_cat));
-
-        // Was this last segment?
-        if (s_idx == c_ptr->n_segs - 1) {
-            strncat(new_gsb_ptr->cur_string, "}", 1);  // Close up somatic chromosome
-            g_array_append_val(nodes_array, new_gsb_ptr);  // This is the only place where new elements are added to nodes_array
-        }
-        else {
-            strncat(new_gsb_ptr->cur_string, ";", 1);  // Close up current segment
-            iterate_segs_and_update_map(new_gsb_ptr, s_idx+1, c_ptr, nodes_array, g_ptr);  // Pass the structure to handling the next segment
-        }
-        // End scenario 2
-        //
-
 
         // In this part we branched so delete this internal node
         delete_genome_string_branch(gsb_ptr);
+        return;
+    }
+
+    g_string_append_printf(
+        gsb_ptr->cur_string,
+        "%d,%d,%d",
+        map_seg->seg_id,
+        (map_seg->maternal_is_paternal + s_ptr->is_maternal) % 2 == 1 ? 1 : 0,
+        (map_seg->reversed + s_ptr->is_plus) % 2 == 1 ? 0 : 1
+    );
+    if (exceeds_upper_bound(gsb_ptr->cur_string, upper_bound)) {
+        delete_genome_string_branch(gsb_ptr);
+        return;
+    }
+
+    // Was this last segment?
+    if (s_idx == c_ptr->n_segs - 1) {
+        g_string_append_c(gsb_ptr->cur_string, '}');  // Close up somatic chromosome
+        g_array_append_val(nodes_array, gsb_ptr);  // This is the only place where new elements are added to nodes_array
+    }
+    else {
+        g_string_append_c(gsb_ptr->cur_string, ';');  // Close up current segment
+        iterate_segs_and_update_map(gsb_ptr, s_idx+1, c_ptr, nodes_array, g_ptr, upper_bound);  // Pass the structure to handling the next segment
     }
 }
 
 void remove_non_smallest_members_from_genome_branch_array(GArray *nodes) {
-    char min_genome_string[10000];
+    char *min_genome_string;
     struct genome_string_branch *debug_gsb_ptr;
     int i;
-    
-    strcpy(min_genome_string, (g_array_index(nodes, struct genome_string_branch*, 0))->cur_string);
+    if (nodes->len == 0) {
+        return;
+    }
+
+    // Points into the smallest node, which is never removed below
+    min_genome_string = (g_array_index(nodes, struct genome_string_branch*, 0))->cur_string->str;
     for (i=1; i<nodes->len; i++) {
-        if (strcmp(min_genome_string, (g_array_index(nodes, struct genome_string_branch*, i))->cur_string) > 0) {
-            strcpy(min_genome_string, (g_array_index(nodes, struct genome_string_branch*, i))->cur_string);
+        if (strcmp(min_genome_string, (g_array_index(nodes, struct genome_string_branch*, i))->cur_string->str) > 0) {
+            min_genome_string = (g_array_index(nodes, struct genome_string_branch*, i))->cur_string->str;
         }
     }
     i=0;
     while (i < nodes->len) {
-        if (strcmp((g_array_index(nodes, struct genome_string_branch*, i))->cur_string, min_genome_string) > 0) {
+        if (strcmp((g_array_index(nodes, struct genome_string_branch*, i))->cur_string->str, min_genome_string) > 0) {
             debug_gsb_ptr = g_array_index(nodes, struct genome_string_branch*, i);
             g_array_remove_index(nodes, i);
         }
@@ -1502,18 +1903,23 @@ void remove_non_smallest_members_from_genome_branch_array(GArray *nodes) {
 // void nodes_array_element_free(struct genome_string_branch* gsb_ptr) {
 void nodes_array_element_free(gpointer gsb_ptr_ptr) {
     struct genome_string_branch *gsb_ptr = *((struct genome_string_branch **)gsb_ptr_ptr);
+    g_string_free(gsb_ptr->cur_string, 1);
+    gsb_ptr->cur_string = NULL;
     free(gsb_ptr->somatic_chr_is_used);
     gsb_ptr->somatic_chr_is_used = NULL;
-    g_hash_table_destroy(gsb_ptr->map_of_encountered_segments);
-    gsb_ptr->map_of_encountered_segments = NULL;
+    free(gsb_ptr->chr_order);
+    gsb_ptr->chr_order = NULL;
+    free(gsb_ptr->wt_chr_lens);
+    gsb_ptr->wt_chr_lens = NULL;
+    free(gsb_ptr->seg_map);
+    gsb_ptr->seg_map = NULL;
     free(gsb_ptr);
 
     return;
 }
 
-void get_unique_genome_string(struct genome* g_ptr, char* out_string_ptr) {
+int get_unique_genome_string_bounded(struct genome* g_ptr, char *upper_bound, GString *out_string) {
     int c_idx, s_idx, i, j, n_chrs_used, cur_node_count;
-    char seg_idx_string[MAX_TIMES_DIVIDED];  // Acts as a temporary string holder for the function
     struct chromosome *c_ptr;
     struct genome_string_branch *gsb_ptr;
 
@@ -1521,56 +1927,394 @@ void get_unique_genome_string(struct genome* g_ptr, char* out_string_ptr) {
     GArray *nodes = g_array_new(0, 0, sizeof(struct genome_string_branch*));
     g_array_set_clear_func(nodes, (GDestroyNotify)nodes_array_element_free);
     
+    // Identical chromosomes, and the two orientations of a palindromic chromosome,
+    // give identical branches, so only the first of them is branched on.
+    struct chromosome_info *info;
+    int *chr_ids = malloc(2 * g_ptr->n_chrs * sizeof(int));
+    if (chr_ids == NULL) {
+        fprintf(stderr, "Failed to malloc chr_ids in get_unique_genome_string(). Exiting.\n");
+        exit(1);
+    }
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        info = get_chromosome_info(*(g_ptr->root_chr+c_idx));
+        *(chr_ids+2*c_idx) = info->id;
+        *(chr_ids+2*c_idx+1) = info->reverse_id;
+    }
+    int is_symmetric_to_earlier_chr(int c_idx, int *somatic_chr_is_used) {
+        int prev_c_idx;
+        for (prev_c_idx=0; prev_c_idx<c_idx; prev_c_idx++) {
+            if (
+                (somatic_chr_is_used == NULL || !*(somatic_chr_is_used+prev_c_idx)) &&
+                (*(chr_ids+2*prev_c_idx) == *(chr_ids+2*c_idx) || *(chr_ids+2*prev_c_idx) == *(chr_ids+2*c_idx+1))
+            ) {
+                return(1);
+            }
+        }
+        return(0);
+    }
+
+    // An untouched WT chromosome is one whose every copy is an intact somatic
+    // chromosome. Untouched WT chromosomes of the same length with the same
+    // copies, up to swapping the alleles and the orientation, are
+    // interchangeable, so only the first unused one of them is branched on.
+    // Without this the number of tied branches grows factorially with the
+    // number of WT chromosomes.
+    int wt_chr, k, n_wt_chrs = *((*(g_ptr->genome_segs+g_ptr->n_genome_segs-1))->seg_indexes+0) + 1;
+    int *wt_chr_len = calloc(n_wt_chrs, sizeof(int));
+    int *wt_chr_first_seg = calloc(n_wt_chrs, sizeof(int));
+    int *wt_chr_copies = calloc(4 * n_wt_chrs, sizeof(int));  /* Number of intact copies by 2*is_maternal + is_plus */
+    int *wt_chr_class = calloc(n_wt_chrs, sizeof(int));  /* First interchangeable WT chromosome, -1 if not untouched */
+    int *chr_wt_chr = malloc(g_ptr->n_chrs * sizeof(int));  /* WT chromosome of an intact somatic chromosome, otherwise -1 */
+    if (wt_chr_len == NULL || wt_chr_first_seg == NULL || wt_chr_copies == NULL || wt_chr_class == NULL || chr_wt_chr == NULL) {
+        fprintf(stderr, "Failed to malloc WT chromosome classes in get_unique_genome_string(). Exiting.\n");
+        exit(1);
+    }
+    for (s_idx=g_ptr->n_genome_segs-1; s_idx>=0; s_idx--) {
+        wt_chr = *((*(g_ptr->genome_segs+s_idx))->seg_indexes+0);
+        *(wt_chr_len+wt_chr) += 1;
+        *(wt_chr_first_seg+wt_chr) = s_idx;
+    }
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+        struct seg *first_s_ptr = *(c_ptr->root_seg+0), *s_ptr, *wt_s_ptr;
+        wt_chr = *(first_s_ptr->seg_indexes+0);
+        int is_intact = (c_ptr->n_segs == *(wt_chr_len+wt_chr));
+        for (k=0; k<c_ptr->n_segs && is_intact; k++) {
+            s_ptr = *(c_ptr->root_seg+k);
+            wt_s_ptr = *(g_ptr->genome_segs + *(wt_chr_first_seg+wt_chr) + (first_s_ptr->is_plus ? k : c_ptr->n_segs-1-k));
+            is_intact = (
+                s_ptr->is_plus == first_s_ptr->is_plus &&
+                s_ptr->is_maternal == first_s_ptr->is_maternal &&
+                seg_indexes_cmp(s_ptr->times_divided, s_ptr->seg_indexes, wt_s_ptr->times_divided, wt_s_ptr->seg_indexes) == 0
+            );
+        }
+        if (is_intact) {
+            *(chr_wt_chr+c_idx) = wt_chr;
+            *(wt_chr_copies + 4*wt_chr + 2*first_s_ptr->is_maternal + first_s_ptr->is_plus) += 1;
+        }
+        else {
+            *(chr_wt_chr+c_idx) = -1;
+            for (k=0; k<c_ptr->n_segs; k++) {
+                *(wt_chr_class + *((*(c_ptr->root_seg+k))->seg_indexes+0)) = -1;
+            }
+        }
+    }
+    for (wt_chr=0; wt_chr<n_wt_chrs; wt_chr++) {
+        if (*(wt_chr_class+wt_chr) == -1 || *(wt_chr_len+wt_chr) == 0) {
+            *(wt_chr_class+wt_chr) = -1;
+            continue;
+        }
+
+        // Normalise the copies to the smallest of the four allele and orientation swaps
+        int *copies = wt_chr_copies + 4*wt_chr, swapped[4], smallest[4], swap;
+        for (swap=0; swap<4; swap++) {
+            for (k=0; k<4; k++) {
+                swapped[k ^ swap] = *(copies+k);
+            }
+            if (swap == 0 || memcmp(swapped, smallest, sizeof(smallest)) < 0) {
+                memcpy(smallest, swapped, sizeof(smallest));
+            }
+        }
+        memcpy(copies, smallest, sizeof(smallest));
+
+        *(wt_chr_class+wt_chr) = wt_chr;
+        for (k=0; k<wt_chr; k++) {
+            if (
+                *(wt_chr_class+k) == k &&
+                *(wt_chr_len+k) == *(wt_chr_len+wt_chr) &&
+                memcmp(wt_chr_copies + 4*k, copies, sizeof(smallest)) == 0
+            ) {
+                *(wt_chr_class+wt_chr) = k;
+                break;
+            }
+        }
+    }
+    int *wt_chr_is_unused = malloc(n_wt_chrs * sizeof(int));  /* Untouched and unused by the current branch */
+    int *first_unused_of_class = malloc(n_wt_chrs * sizeof(int));  /* Indexed by class, -1 if none */
+    if (wt_chr_is_unused == NULL || first_unused_of_class == NULL) {
+        fprintf(stderr, "Failed to malloc wt_chr_is_unused in get_unique_genome_string(). Exiting.\n");
+        exit(1);
+    }
+    void set_unused_wt_chrs(int *somatic_chr_is_used) {
+        int c_idx, wt_chr;
+        for (wt_chr=0; wt_chr<n_wt_chrs; wt_chr++) {
+            *(wt_chr_is_unused+wt_chr) = (*(wt_chr_class+wt_chr) != -1);
+            *(first_unused_of_class+wt_chr) = -1;
+        }
+        for (c_idx=0; c_idx<g_ptr->n_chrs && somatic_chr_is_used != NULL; c_idx++) {
+            if (*(chr_wt_chr+c_idx) != -1 && *(somatic_chr_is_used+c_idx)) {
+                *(wt_chr_is_unused + *(chr_wt_chr+c_idx)) = 0;
+            }
+        }
+        for (wt_chr=n_wt_chrs-1; wt_chr>=0; wt_chr--) {
+            if (*(wt_chr_is_unused+wt_chr)) {
+                *(first_unused_of_class + *(wt_chr_class+wt_chr)) = wt_chr;
+            }
+        }
+    }
+    int is_untouched_and_unused(int wt_chr) {
+        return(wt_chr != -1 && *(wt_chr_is_unused+wt_chr));
+    }
+    int is_equivalent_to_earlier_wt_chr(int c_idx) {
+        int wt_chr = *(chr_wt_chr+c_idx);
+        return(is_untouched_and_unused(wt_chr) && *(first_unused_of_class + *(wt_chr_class+wt_chr)) != wt_chr);
+    }
+
+    // Tied branches lead to the same genome strings if everything the rest of
+    // the search depends on is the same up to relabeling the WT chromosomes not
+    // labeled yet: the labels given so far, the unused chromosomes as read with
+    // these labels (in any order and orientation, since all are tried), and the
+    // number of unused untouched WT chromosomes of each class. Only one of them
+    // is kept. Unlabeled WT chromosomes are only told apart by where they occur,
+    // so they are renamed in order of first occurrence, with the allele and
+    // orientation of the first occurrence as the reference. The unused
+    // chromosomes are first ordered by a reading blind to the WT chromosome
+    // names, so that the renaming mostly does not depend on the chromosome
+    // indexes. Without this, tied branches of genomes with many alike but
+    // distinct chromosomes, e.g. the same deletion on each WT chromosome,
+    // grow factorially in number.
+    GString *residual_key = g_string_new(NULL);
+    GString *chr_reading[2] = {g_string_new(NULL), g_string_new(NULL)};
+    GPtrArray *chr_readings = g_ptr_array_new();
+    struct unused_chr_reading {
+        char *reading;  /* Reading blind to the names of the unlabeled WT chromosomes */
+        int c_idx;
+        int reversed;
+    };
+    int *n_unused_of_class = malloc(n_wt_chrs * sizeof(int));
+    int *wt_chr_name = malloc(n_wt_chrs * sizeof(int));  /* Name given in the residual key, -1 if none yet */
+    int *wt_chr_flip = malloc(n_wt_chrs * sizeof(int));  /* 2*allele + orientation flip relative to the first occurrence */
+    int wt_chr_name_count;
+    if (n_unused_of_class == NULL || wt_chr_name == NULL || wt_chr_flip == NULL) {
+        fprintf(stderr, "Failed to malloc n_unused_of_class in get_unique_genome_string(). Exiting.\n");
+        exit(1);
+    }
+    gint chr_readings_cmp(gconstpointer a, gconstpointer b) {
+        struct unused_chr_reading *r1 = *(struct unused_chr_reading**)a, *r2 = *(struct unused_chr_reading**)b;
+        int cmp = strcmp(r1->reading, r2->reading);
+        return(cmp != 0 ? cmp : r1->c_idx - r2->c_idx);
+    }
+    void read_unused_chr(struct genome_string_branch *gsb_ptr, struct chromosome *c_ptr, int reversed, int blind, GString *reading) {
+        int s_idx, genome_seg_idx, wt_chr, rank, seg_is_plus;
+        struct seg *s_ptr;
+        struct map_seg_elements *map_seg;
+
+        g_string_truncate(reading, 0);
+        for (s_idx=0; s_idx<c_ptr->n_segs; s_idx++) {
+            s_ptr = *(c_ptr->root_seg + (reversed ? c_ptr->n_segs-1-s_idx : s_idx));
+            seg_is_plus = (reversed ? s_ptr->is_plus ^ 1 : s_ptr->is_plus);
+            genome_seg_idx = find_genome_seg_idx(g_ptr, s_ptr);
+            map_seg = gsb_ptr->seg_map + genome_seg_idx;
+            if (map_seg->seg_id != -1) {
+                g_string_append_printf(
+                    reading,
+                    "%d,%d,%d;",
+                    map_seg->seg_id,
+                    (map_seg->maternal_is_paternal + s_ptr->is_maternal) % 2 == 1 ? 1 : 0,
+                    (map_seg->reversed + seg_is_plus) % 2 == 1 ? 0 : 1
+                );
+                continue;
+            }
+
+            // Not labeled yet, so read the position of the segment in its WT chromosome
+            wt_chr = *(s_ptr->seg_indexes+0);
+            if (blind) {
+                g_string_append_printf(reading, "-%d;", *(wt_chr_len+wt_chr));
+                continue;
+            }
+            rank = genome_seg_idx - *(wt_chr_first_seg+wt_chr);
+            if (*(wt_chr_name+wt_chr) == -1) {
+                *(wt_chr_name+wt_chr) = wt_chr_name_count++;
+                *(wt_chr_flip+wt_chr) = 2*s_ptr->is_maternal + (seg_is_plus ^ 1);
+            }
+            if (*(wt_chr_flip+wt_chr) % 2 == 1) {
+                rank = *(wt_chr_len+wt_chr) - 1 - rank;
+            }
+            g_string_append_printf(
+                reading,
+                "-%d.%d.%d,%d,%d;",
+                *(wt_chr_name+wt_chr),
+                rank,
+                *(wt_chr_len+wt_chr),
+                s_ptr->is_maternal ^ (*(wt_chr_flip+wt_chr) / 2),
+                seg_is_plus ^ (*(wt_chr_flip+wt_chr) % 2)
+            );
+        }
+    }
+    void get_residual_key(struct genome_string_branch *gsb_ptr) {
+        int c_idx, wt_chr, reversed, j;
+        struct chromosome *c_ptr;
+        struct unused_chr_reading *r_ptr;
+
+        set_unused_wt_chrs(gsb_ptr->somatic_chr_is_used);
+        g_string_printf(residual_key, "%d", gsb_ptr->next_seg_id);
+        for (j=0; j<gsb_ptr->n_wt_chrs_used; j++) {
+            g_string_append_printf(residual_key, ",%d", *(gsb_ptr->wt_chr_lens+j));
+        }
+
+        // Order the unused chromosomes by their blind readings in their smaller orientation
+        for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+            if (*(gsb_ptr->somatic_chr_is_used+c_idx) || is_untouched_and_unused(*(chr_wt_chr+c_idx))) {
+                continue;
+            }
+            c_ptr = *(g_ptr->root_chr+c_idx);
+            for (reversed=0; reversed<=1; reversed++) {
+                read_unused_chr(gsb_ptr, c_ptr, reversed, 1, chr_reading[reversed]);
+            }
+            r_ptr = malloc(sizeof(struct unused_chr_reading));
+            if (r_ptr == NULL) {
+                fprintf(stderr, "Failed to malloc unused_chr_reading in get_unique_genome_string(). Exiting.\n");
+                exit(1);
+            }
+            r_ptr->reversed = (strcmp(chr_reading[1]->str, chr_reading[0]->str) < 0);
+            r_ptr->reading = g_strdup(chr_reading[r_ptr->reversed]->str);
+            r_ptr->c_idx = c_idx;
+            g_ptr_array_add(chr_readings, r_ptr);
+        }
+        g_ptr_array_sort(chr_readings, (GCompareFunc)chr_readings_cmp);
+
+        // Read them again in this order, renaming the unlabeled WT chromosomes
+        for (wt_chr=0; wt_chr<n_wt_chrs; wt_chr++) {
+            *(wt_chr_name+wt_chr) = -1;
+        }
+        wt_chr_name_count = 0;
+        for (j=0; j<chr_readings->len; j++) {
+            r_ptr = (struct unused_chr_reading*)g_ptr_array_index(chr_readings, j);
+            read_unused_chr(gsb_ptr, *(g_ptr->root_chr+r_ptr->c_idx), r_ptr->reversed, 0, chr_reading[0]);
+            g_string_append_printf(residual_key, "{%s}", chr_reading[0]->str);
+            g_free(r_ptr->reading);
+            free(r_ptr);
+        }
+        g_ptr_array_set_size(chr_readings, 0);
+
+        g_string_append_c(residual_key, '|');
+        for (wt_chr=0; wt_chr<n_wt_chrs; wt_chr++) {
+            *(n_unused_of_class+wt_chr) = 0;
+        }
+        for (wt_chr=0; wt_chr<n_wt_chrs; wt_chr++) {
+            if (*(wt_chr_is_unused+wt_chr)) {
+                *(n_unused_of_class + *(wt_chr_class+wt_chr)) += 1;
+            }
+        }
+        for (wt_chr=0; wt_chr<n_wt_chrs; wt_chr++) {
+            if (*(n_unused_of_class+wt_chr) > 0) {
+                g_string_append_printf(residual_key, "%d:%d,", wt_chr, *(n_unused_of_class+wt_chr));
+            }
+        }
+    }
+    void remove_equivalent_members_from_genome_branch_array(GArray *nodes) {
+        if (nodes->len < 2) {
+            return;
+        }
+        GHashTable *seen_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+        int i = 0;
+        while (i < nodes->len) {
+            get_residual_key(g_array_index(nodes, struct genome_string_branch*, i));
+            if (g_hash_table_contains(seen_keys, residual_key->str)) {
+                g_array_remove_index(nodes, i);
+            }
+            else {
+                g_hash_table_insert(seen_keys, g_strdup(residual_key->str), NULL);
+                i++;
+            }
+        }
+        g_hash_table_destroy(seen_keys);
+    }
+    void free_search_data() {
+        free(chr_ids);
+        free(wt_chr_len);
+        free(wt_chr_first_seg);
+        free(wt_chr_copies);
+        free(wt_chr_class);
+        free(chr_wt_chr);
+        free(wt_chr_is_unused);
+        free(first_unused_of_class);
+        free(n_unused_of_class);
+        free(wt_chr_name);
+        free(wt_chr_flip);
+        g_string_free(residual_key, 1);
+        g_string_free(chr_reading[0], 1);
+        g_string_free(chr_reading[1], 1);
+        g_ptr_array_free(chr_readings, 1);
+    }
+
     // Initiate by taking all somatic chromosomes and both orientations as the root somatic chromosome
+    set_unused_wt_chrs(NULL);
     for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        if (is_symmetric_to_earlier_chr(c_idx, NULL) || is_equivalent_to_earlier_wt_chr(c_idx)) {
+            continue;
+        }
+
         // Present this chr in forward orientation
         c_ptr = *(g_ptr->root_chr+c_idx);
         gsb_ptr = create_genome_string_branch(g_ptr);
-        strncat(gsb_ptr->cur_string, "{", 1);  // Start of first somatic chromosome
+        g_string_append_c(gsb_ptr->cur_string, '{');  // Start of first somatic chromosome
         *(gsb_ptr->somatic_chr_is_used+c_idx) = 1; // Mark current somatic chromosome as used
-        iterate_segs_and_update_map(gsb_ptr, 0, c_ptr, nodes, g_ptr);  // After this step, genome_string_branch have been extended by an additional level of depth
+        *(gsb_ptr->chr_order+gsb_ptr->n_chrs_ordered++) = c_idx + 1;
+        iterate_segs_and_update_map(gsb_ptr, 0, c_ptr, nodes, g_ptr, upper_bound);  // After this step, genome_string_branch have been extended by an additional level of depth
+
+        if (*(chr_ids+2*c_idx) == *(chr_ids+2*c_idx+1)) {
+            continue;
+        }
 
         // Present this chr in reverse orientation
         c_ptr = copy_chromosome(c_ptr);
         invert_segs_in_chr(c_ptr, 0, c_ptr->n_segs - 1);
         gsb_ptr = create_genome_string_branch(g_ptr);
-        strncat(gsb_ptr->cur_string, "{", 1);
+        g_string_append_c(gsb_ptr->cur_string, '{');
         *(gsb_ptr->somatic_chr_is_used+c_idx) = 1; // Mark current somatic chromosome as used
-        iterate_segs_and_update_map(gsb_ptr, 0, c_ptr, nodes, g_ptr);
+        *(gsb_ptr->chr_order+gsb_ptr->n_chrs_ordered++) = -(c_idx + 1);
+        iterate_segs_and_update_map(gsb_ptr, 0, c_ptr, nodes, g_ptr, upper_bound);
         delete_chromosome(c_ptr);
     }
 
     // Compare and remove bad starts
     remove_non_smallest_members_from_genome_branch_array(nodes);
+    remove_equivalent_members_from_genome_branch_array(nodes);
     n_chrs_used = 1;
+    if (nodes->len == 0) {  // All branches exceeded upper_bound
+        g_array_free(nodes, 1);
+        free_search_data();
+        return(0);
+    }
 
     // Repeat until all chromosomes have been used up
     while (n_chrs_used < g_ptr->n_chrs) {
         cur_node_count = nodes->len;
 
         for (i=0; i<cur_node_count; i++) {
+            set_unused_wt_chrs((g_array_index(nodes, struct genome_string_branch*, i))->somatic_chr_is_used);
             for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
-                gsb_ptr = copy_genome_string_branch(g_array_index(nodes, struct genome_string_branch*, i));
-
-                if (*(gsb_ptr->somatic_chr_is_used+c_idx)) {
-                    delete_genome_string_branch(gsb_ptr);
+                gsb_ptr = g_array_index(nodes, struct genome_string_branch*, i);
+                if (
+                    *(gsb_ptr->somatic_chr_is_used+c_idx) ||
+                    is_symmetric_to_earlier_chr(c_idx, gsb_ptr->somatic_chr_is_used) ||
+                    is_equivalent_to_earlier_wt_chr(c_idx)
+                ) {
                     continue;
                 }
+                gsb_ptr = copy_genome_string_branch(gsb_ptr);
                 c_ptr = *(g_ptr->root_chr+c_idx);
 
                 // Forward orientation of current somatic chromosome
                 *(gsb_ptr->somatic_chr_is_used+c_idx) = 1;
-                strncat(gsb_ptr->cur_string, "{", 1);  // Start of the next somatic chromosome
-                iterate_segs_and_update_map(gsb_ptr, 0, c_ptr, nodes, g_ptr);
+                *(gsb_ptr->chr_order+gsb_ptr->n_chrs_ordered++) = c_idx + 1;
+                g_string_append_c(gsb_ptr->cur_string, '{');  // Start of the next somatic chromosome
+                iterate_segs_and_update_map(gsb_ptr, 0, c_ptr, nodes, g_ptr, upper_bound);
+
+                if (*(chr_ids+2*c_idx) == *(chr_ids+2*c_idx+1)) {
+                    continue;
+                }
 
 
                 // Reverse orientation of current somatic chromosome
                 gsb_ptr = copy_genome_string_branch(g_array_index(nodes, struct genome_string_branch*, i));
                 *(gsb_ptr->somatic_chr_is_used+c_idx) = 1;
-                strncat(gsb_ptr->cur_string, "{", 1);
+                *(gsb_ptr->chr_order+gsb_ptr->n_chrs_ordered++) = -(c_idx + 1);
+                g_string_append_c(gsb_ptr->cur_string, '{');
                 c_ptr = copy_chromosome(c_ptr);
                 invert_segs_in_chr(c_ptr, 0, c_ptr->n_segs - 1);
-                iterate_segs_and_update_map(gsb_ptr, 0, c_ptr, nodes, g_ptr);
+                iterate_segs_and_update_map(gsb_ptr, 0, c_ptr, nodes, g_ptr, upper_bound);
                 delete_chromosome(c_ptr);
             }
         }
@@ -1582,6 +2326,12 @@ void get_unique_genome_string(struct genome* g_ptr, char* out_string_ptr) {
 
         // Remove nodes with genome strings larger than minimum genome string
         remove_non_smallest_members_from_genome_branch_array(nodes);
+        remove_equivalent_members_from_genome_branch_array(nodes);
+        if (nodes->len == 0) {
+            g_array_free(nodes, 1);
+            free_search_data();
+            return(0);
+        }
     }
 
     // Now all chromosomes have been added to nodes->genome_string_branch variables, and all the
@@ -1589,29 +2339,313 @@ void get_unique_genome_string(struct genome* g_ptr, char* out_string_ptr) {
     // the WT chr lengths to the strings.
     for (i=0; i<nodes->len; i++) {
         gsb_ptr = g_array_index(nodes, struct genome_string_branch*, i);
-        strncat(gsb_ptr->cur_string, "[", 1);
-
-        j=0;
-        while (*(gsb_ptr->wt_chr_lens+j) != 0) {
-            if (j != 0) {
-                strncat(gsb_ptr->cur_string, ",", 1);
-            }
-            sprintf(seg_idx_string, "%d", *(gsb_ptr->wt_chr_lens+j));
-            strncat(gsb_ptr->cur_string, seg_idx_string, strlen(seg_idx_string));
+        g_string_append_c(gsb_ptr->cur_string, '[');
 
-            j++;
+        for (j=0; j<gsb_ptr->n_wt_chrs_used; j++) {
+            g_string_append_printf(gsb_ptr->cur_string, (j == 0 ? "%d" : ",%d"), *(gsb_ptr->wt_chr_lens+j));
         }
-        strncat(gsb_ptr->cur_string, "]", 1);
+        g_string_append_c(gsb_ptr->cur_string, ']');
     }
 
     remove_non_smallest_members_from_genome_branch_array(nodes);
     gsb_ptr = g_array_index(nodes, struct genome_string_branch*, 0);
-    strcpy(out_string_ptr, gsb_ptr->cur_string);
+    g_string_assign(out_string, gsb_ptr->cur_string->str);
+
+    // Remember the canonical labeling for the children of *g_ptr
+    struct map_seg_elements *map_seg;
+    g_ptr->n_canonical_chrs = gsb_ptr->n_chrs_ordered;
+    g_ptr->canonical_chr_ids = realloc(g_ptr->canonical_chr_ids, g_ptr->n_canonical_chrs * sizeof(int));
+    g_ptr->n_canonical_wt_chrs = n_wt_chrs;
+    g_ptr->canonical_wt_chr_reversed = realloc(g_ptr->canonical_wt_chr_reversed, n_wt_chrs * sizeof(int));
+    if (g_ptr->canonical_chr_ids == NULL || g_ptr->canonical_wt_chr_reversed == NULL) {
+        fprintf(stderr, "Failed to realloc canonical labeling in get_unique_genome_string(). Exiting.\n");
+        exit(1);
+    }
+    for (i=0; i<gsb_ptr->n_chrs_ordered; i++) {
+        c_idx = abs(*(gsb_ptr->chr_order+i)) - 1;
+        *(g_ptr->canonical_chr_ids+i) = *(chr_ids + 2*c_idx + (*(gsb_ptr->chr_order+i) > 0 ? 0 : 1));
+    }
+    for (wt_chr=0; wt_chr<n_wt_chrs; wt_chr++) {
+        *(g_ptr->canonical_wt_chr_reversed+wt_chr) = 0;
+    }
+    for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
+        map_seg = gsb_ptr->seg_map + s_idx;
+        if (map_seg->seg_id != -1) {
+            *(g_ptr->canonical_wt_chr_reversed + *((*(g_ptr->genome_segs+s_idx))->seg_indexes+0)) = map_seg->reversed;
+        }
+    }
+
     g_array_free(nodes, 1);
+    free_search_data();
+
+    return(1);
+}
 
+/*
+    Writes the genome string of *g_ptr with the somatic chromosomes ordered and
+    oriented, and the WT chromosomes oriented, as in the canonical labeling
+    inherited from the parent genome. Chromosomes are matched to the parent's
+    by their interned IDs, and chromosomes new to the child are appended. The
+    result is one of the strings get_unique_genome_string() chooses from, so
+    it is an upper bound of the unique genome string.
+*/
+void get_genome_string_in_parent_order(struct genome *g_ptr, GString *out_string) {
+    int c_idx, s_idx, i, k, is_reversed, wt_chr, wt_chr_reversed, seg_is_plus, next_seg_id = 0;
+    struct chromosome *c_ptr;
+    struct chromosome_info *info;
+    struct seg *s_ptr;
+    struct map_seg_elements *map_seg;
+
+    int *chr_order = malloc(g_ptr->n_chrs * sizeof(int));
+    int *chr_is_used = calloc(g_ptr->n_chrs, sizeof(int));
+    if (chr_order == NULL || chr_is_used == NULL) {
+        fprintf(stderr, "Failed to malloc chr_order in get_genome_string_in_parent_order(). Exiting.\n");
+        exit(1);
+    }
+    int n_ordered = 0;
+    for (i=0; i<g_ptr->n_canonical_chrs; i++) {
+        for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+            if (*(chr_is_used+c_idx)) {
+                continue;
+            }
+            info = get_chromosome_info(*(g_ptr->root_chr+c_idx));
+            if (info->id == *(g_ptr->canonical_chr_ids+i) || info->reverse_id == *(g_ptr->canonical_chr_ids+i)) {
+                *(chr_is_used+c_idx) = 1;
+                *(chr_order+n_ordered++) = (info->id == *(g_ptr->canonical_chr_ids+i) ? c_idx + 1 : -(c_idx + 1));
+                break;
+            }
+        }
+    }
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        if (!*(chr_is_used+c_idx)) {
+            *(chr_order+n_ordered++) = c_idx + 1;
+        }
+    }
+
+    struct map_seg_elements *seg_map = malloc(g_ptr->n_genome_segs * sizeof(struct map_seg_elements));
+    if (seg_map == NULL) {
+        fprintf(stderr, "Failed to malloc seg_map in get_genome_string_in_parent_order(). Exiting.\n");
+        exit(1);
+    }
+    for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
+        (seg_map+s_idx)->seg_id = -1;
+    }
+    GArray *wt_chr_lens = g_array_new(0, 0, sizeof(int));
+    GString *genome_string = out_string;
+    g_string_truncate(genome_string, 0);
+    for (i=0; i<n_ordered; i++) {
+        c_ptr = *(g_ptr->root_chr + abs(*(chr_order+i)) - 1);
+        is_reversed = (*(chr_order+i) < 0);
+        g_string_append_c(genome_string, '{');
+
+        for (k=0; k<c_ptr->n_segs; k++) {
+            s_ptr = *(c_ptr->root_seg + (is_reversed ? c_ptr->n_segs-1-k : k));
+            seg_is_plus = (is_reversed ? s_ptr->is_plus ^ 1 : s_ptr->is_plus);
+            map_seg = seg_map + find_genome_seg_idx(g_ptr, s_ptr);
+
+            if (map_seg->seg_id == -1) {
+                // First segment of a WT chromosome, label all the segments of the WT chromosome
+                wt_chr = *(s_ptr->seg_indexes+0);
+                wt_chr_reversed = (wt_chr < g_ptr->n_canonical_wt_chrs ? *(g_ptr->canonical_wt_chr_reversed+wt_chr) : 0);
+                int cur_wt_chr_len = 0;
+                for (s_idx=0; s_idx<g_ptr->n_genome_segs; s_idx++) {
+                    int wt_s_idx = (wt_chr_reversed ? g_ptr->n_genome_segs-1-s_idx : s_idx);
+                    if (*((*(g_ptr->genome_segs+wt_s_idx))->seg_indexes+0) != wt_chr) {
+                        continue;
+                    }
+                    map_seg = seg_map + wt_s_idx;
+                    map_seg->seg_id = next_seg_id++;
+                    map_seg->maternal_is_paternal = s_ptr->is_maternal;
+                    map_seg->reversed = wt_chr_reversed;
+                    cur_wt_chr_len++;
+                }
+                g_array_append_val(wt_chr_lens, cur_wt_chr_len);
+
+                map_seg = seg_map + find_genome_seg_idx(g_ptr, s_ptr);
+            }
+
+            g_string_append_printf(
+                genome_string,
+                "%d,%d,%d%c",
+                map_seg->seg_id,
+                (map_seg->maternal_is_paternal + s_ptr->is_maternal) % 2 == 1 ? 1 : 0,
+                (map_seg->reversed + seg_is_plus) % 2 == 1 ? 0 : 1,
+                (k == c_ptr->n_segs - 1 ? '}' : ';')
+            );
+        }
+    }
+
+    g_string_append_c(genome_string, '[');
+    for (i=0; i<wt_chr_lens->len; i++) {
+        g_string_append_printf(genome_string, (i == 0 ? "%d" : ",%d"), g_array_index(wt_chr_lens, int, i));
+    }
+    g_string_append_c(genome_string, ']');
+
+    g_array_free(wt_chr_lens, 1);
+    free(seg_map);
+    free(chr_order);
+    free(chr_is_used);
+    return;
+}
+
+/*
+    Gets the unique genome string of *g_ptr. If *g_ptr inherited the canonical
+    labeling of its parent, the genome string in the parent's labeling is used
+    as an upper bound, so that only branches that can still beat it are
+    searched. A child differs from its parent by one event, so this typically
+    cuts the search to the chromosomes changed by the event.
+*/
+void get_unique_genome_string(struct genome* g_ptr, GString *out_string) {
+    GString *upper_bound = NULL;
+    if (g_ptr->canonical_chr_ids != NULL) {
+        upper_bound = g_string_new(NULL);
+        get_genome_string_in_parent_order(g_ptr, upper_bound);
+    }
+
+    if (!get_unique_genome_string_bounded(g_ptr, (upper_bound == NULL ? NULL : upper_bound->str), out_string)) {
+        // Should not happen, since upper_bound is one of the genome strings of *g_ptr
+        get_unique_genome_string_bounded(g_ptr, NULL, out_string);
+    }
+
+    if (upper_bound != NULL) {
+        g_string_free(upper_bound, 1);
+    }
     return;
 }
 
+
+
+/*
+    Builds a genome from a unique genome string, e.g. the one in the fifth
+    output column. Segment IDs 0..n-1 are assigned to the reference chromosomes
+    in the order of the lengths within the square brackets, so the returned
+    genome has a single WT chromosome segment per reference chromosome if the
+    chromosome is intact. The genome has no history. Exits if the string is
+    malformed.
+*/
+struct genome* genome_from_unique_genome_string(char *genome_string) {
+    int n_wt_chrs = 0, n_segs = 0, wt_chr_len, n_chars, i, j;
+    int seg_id, is_maternal, is_minus;
+    char *c;
+    struct seg *s_ptr;
+
+    // Reference chromosome lengths
+    c = strchr(genome_string, '[');
+    if (c == NULL) {
+        fprintf(stderr, "Malformed genome string '%s' in genome_from_unique_genome_string(). Exiting.\n", genome_string);
+        exit(1);
+    }
+    c++;
+    GArray *wt_chr_lens = g_array_new(0, 0, sizeof(int));
+    while (sscanf(c, "%d%n", &wt_chr_len, &n_chars) == 1) {
+        if (wt_chr_len < 1) {
+            fprintf(stderr, "Malformed genome string '%s' in genome_from_unique_genome_string(). Exiting.\n", genome_string);
+            exit(1);
+        }
+        g_array_append_val(wt_chr_lens, wt_chr_len);
+        n_segs += wt_chr_len;
+        c += n_chars;
+        if (*c == ',') { c++; }
+    }
+    n_wt_chrs = wt_chr_lens->len;
+    if (n_wt_chrs == 0) {
+        fprintf(stderr, "Malformed genome string '%s' in genome_from_unique_genome_string(). Exiting.\n", genome_string);
+        exit(1);
+    }
+
+    struct genome *g_ptr = create_genome(n_wt_chrs, 0);
+    for (i=0; i<g_ptr->n_chrs; i++) {
+        delete_chromosome(*(g_ptr->root_chr+i));
+    }
+    g_ptr->n_chrs = 0;
+
+    // Reference segments. Each segment of a WT chromosome that is not intact is a child of the chromosome.
+    for (i=0; i<n_wt_chrs; i++) {
+        delete_seg(*(g_ptr->genome_segs+i));
+    }
+    g_ptr->n_genome_segs = n_segs;
+    g_ptr->genome_segs = realloc(g_ptr->genome_segs, n_segs * sizeof(struct seg*));
+    if (g_ptr->genome_segs == NULL) {
+        fprintf(stderr, "\nFailed to realloc g_ptr->genome_segs in genome_from_unique_genome_string(). Exiting.\n");
+        exit(1);
+    }
+    n_segs = 0;
+    for (i=0; i<n_wt_chrs; i++) {
+        wt_chr_len = g_array_index(wt_chr_lens, int, i);
+        for (j=0; j<wt_chr_len; j++) {
+            s_ptr = create_seg(i, 0);
+            if (wt_chr_len > 1) {
+                s_ptr->times_divided = 2;
+                s_ptr->seg_indexes = realloc(s_ptr->seg_indexes, 2 * sizeof(int));
+                if (s_ptr->seg_indexes == NULL) {
+                    fprintf(stderr, "\nFailed to realloc s_ptr->seg_indexes in genome_from_unique_genome_string(). Exiting.\n");
+                    exit(1);
+                }
+                *(s_ptr->seg_indexes+1) = j;
+            }
+            *(g_ptr->genome_segs+n_segs) = s_ptr;
+            n_segs++;
+        }
+    }
+
+    // Somatic chromosomes
+    struct chromosome *c_ptr;
+    c = genome_string;
+    while (*c == '{') {
+        c++;
+        c_ptr = malloc(sizeof(struct chromosome));
+        if (c_ptr == NULL) {
+            fprintf(stderr, "\nCreation of chromosome node failed. Exiting.\n");
+            exit(1);
+        }
+        c_ptr->n_segs = 0;
+        c_ptr->root_seg = NULL;
+        c_ptr->info = NULL;
+        c_ptr->used_bps = NULL;
+        c_ptr->n_used_bps = -1;
+        c_ptr->used_bps_changed = 0;
+        while (sscanf(c, "%d,%d,%d%n", &seg_id, &is_maternal, &is_minus, &n_chars) == 3) {
+            if (seg_id < 0 || seg_id >= g_ptr->n_genome_segs) {
+                fprintf(stderr, "Segment ID %d out of range in genome string '%s'. Exiting.\n", seg_id, genome_string);
+                exit(1);
+            }
+            s_ptr = copy_seg(*(g_ptr->genome_segs+seg_id));
+            s_ptr->is_maternal = is_maternal;
+            s_ptr->is_plus = (is_minus ? 0 : 1);
+            c_ptr->n_segs++;
+            c_ptr->root_seg = realloc(c_ptr->root_seg, c_ptr->n_segs * sizeof(struct seg*));
+            if (c_ptr->root_seg == NULL) {
+                fprintf(stderr, "\nFailed to realloc c_ptr->root_seg in genome_from_unique_genome_string(). Exiting.\n");
+                exit(1);
+            }
+            *(c_ptr->root_seg+c_ptr->n_segs-1) = s_ptr;
+            c += n_chars;
+            if (*c == ';') { c++; }
+        }
+        if (*c != '}' || c_ptr->n_segs == 0) {
+            fprintf(stderr, "Malformed genome string '%s' in genome_from_unique_genome_string(). Exiting.\n", genome_string);
+            exit(1);
+        }
+        c++;
+
+        g_ptr->n_chrs++;
+        g_ptr->root_chr = realloc(g_ptr->root_chr, g_ptr->n_chrs * sizeof(struct chromosome*));
+        if (g_ptr->root_chr == NULL) {
+            fprintf(stderr, "\nFailed to realloc g_ptr->root_chr in genome_from_unique_genome_string(). Exiting.\n");
+            exit(1);
+        }
+        *(g_ptr->root_chr+g_ptr->n_chrs-1) = c_ptr;
+    }
+    if (*c != '[') {
+        fprintf(stderr, "Malformed genome string '%s' in genome_from_unique_genome_string(). Exiting.\n", genome_string);
+        exit(1);
+    }
+
+    g_array_free(wt_chr_lens, 1);
+
+    return(g_ptr);
+}
+
 /*
     End function to create unique representation of rearranged genomes
 */
@@ -0,0 +1,201 @@
+/*
+    Engines, see struct rg_engine in rg_enumerator.h. start_engine() sets up
+    the process-wide state used by the other modules from the parameters of
+    an engine, and stop_engine() tears it down, so that several enumerations
+    can be run one after the other in the same process.
+*/
+
+extern int N_CHRS, IS_DIPLOID, MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
+extern int MAX_EVENTS_OF_TYPE[N_RG_TYPES];
+extern int REDUCE_COMMUTING;
+extern GHashTable *reduced_genomes;
+extern GHashTable *seen_somatic_genomes;
+extern struct seen_budget *seen_budget;
+extern GHashTable *chromosome_store;
+extern GThreadPool *batch_pool;
+extern struct progress *progress;
+extern struct genome_sink *SINK;
+extern struct worker_link *WORKER_LINK;
+
+/*
+    Function prototypes
+*/
+struct rg_engine* create_engine(int n_chrs, int is_diploid, int max_dup_depth, int max_overall_depth);
+void delete_engine(struct rg_engine *e_ptr);
+void start_engine(struct rg_engine *e_ptr);
+void stop_engine(struct rg_engine *e_ptr);
+long run_engine(struct rg_engine *e_ptr);
+void set_enabled_rg_types(struct rg_engine *e_ptr, char *types_string);
+void set_max_events(struct rg_engine *e_ptr, char *max_events_string);
+/*
+    End function prototypes
+*/
+
+
+/*
+    Functions for engines
+*/
+struct rg_engine* create_engine(int n_chrs, int is_diploid, int max_dup_depth, int max_overall_depth) {
+    struct rg_engine *e_ptr = malloc(sizeof(struct rg_engine));
+    if (e_ptr == NULL) {
+        fprintf(stderr, "\nCreation of engine failed. Exiting.\n");
+        exit(1);
+    }
+    e_ptr->n_chrs = n_chrs;
+    e_ptr->is_diploid = is_diploid;
+    e_ptr->max_dup_depth = max_dup_depth;
+    e_ptr->max_overall_depth = max_overall_depth;
+    e_ptr->n_threads = 1;
+    e_ptr->max_seen_memory = 0;
+    e_ptr->progress_interval = 0;
+    e_ptr->metrics_path = NULL;
+    int rg;
+    for (rg=0; rg<N_RG_TYPES; rg++) {
+        e_ptr->max_events[rg] = (rg == INV_DUP ? 0 : -1);
+    }
+    e_ptr->reduce_commuting = 0;
+    e_ptr->sink = NULL;
+    e_ptr->stdout_sink = NULL;
+    return(e_ptr);
+}
+
+void delete_engine(struct rg_engine *e_ptr) {
+    free(e_ptr);
+    return;
+}
+
+void start_engine(struct rg_engine *e_ptr) {
+    N_CHRS = e_ptr->n_chrs;
+    IS_DIPLOID = e_ptr->is_diploid;
+    MAX_DEPTH_DUP = e_ptr->max_dup_depth;
+    MAX_DEPTH_NONDUP = e_ptr->max_overall_depth;
+    memcpy(MAX_EVENTS_OF_TYPE, e_ptr->max_events, sizeof(MAX_EVENTS_OF_TYPE));
+    if (get_n_restriction_bits() > 64) {
+        fprintf(stderr, "The limits on the number of events of each type are too many to keep track of. Exiting.\n");
+        exit(1);
+    }
+    REDUCE_COMMUTING = e_ptr->reduce_commuting;
+    if (REDUCE_COMMUTING) {
+        reduced_genomes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    }
+
+    if (e_ptr->sink == NULL) {
+        e_ptr->stdout_sink = create_text_sink(stdout);
+    }
+    SINK = (e_ptr->sink == NULL ? e_ptr->stdout_sink : e_ptr->sink);
+
+    seen_somatic_genomes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)delete_seen_genome);
+    if (chromosome_store == NULL) {
+        chromosome_store = g_hash_table_new(g_str_hash, g_str_equal);
+    }
+    if (e_ptr->max_seen_memory > 0) {
+        seen_budget = create_seen_budget(e_ptr->max_seen_memory << 20);
+    }
+    if (e_ptr->n_threads > 1) {
+        batch_pool = g_thread_pool_new(render_batch_child_in_pool, NULL, e_ptr->n_threads, 1, NULL);
+    }
+    progress = create_progress(e_ptr->progress_interval, e_ptr->metrics_path, MAX_DEPTH_NONDUP);
+    return;
+}
+
+void stop_engine(struct rg_engine *e_ptr) {
+    if (SINK->flush != NULL) {
+        SINK->flush(SINK);
+    }
+    SINK = NULL;
+    if (e_ptr->stdout_sink != NULL) {
+        delete_sink(e_ptr->stdout_sink);
+        e_ptr->stdout_sink = NULL;
+    }
+
+    delete_progress(progress);
+    progress = NULL;
+    if (batch_pool != NULL) {
+        g_thread_pool_free(batch_pool, 0, 1);
+        batch_pool = NULL;
+    }
+    if (seen_budget != NULL) {
+        delete_seen_budget(seen_budget);
+        seen_budget = NULL;
+    }
+    if (reduced_genomes != NULL) {
+        g_hash_table_destroy(reduced_genomes);
+        reduced_genomes = NULL;
+    }
+    REDUCE_COMMUTING = 0;
+    g_hash_table_destroy(seen_somatic_genomes);
+    seen_somatic_genomes = NULL;
+    clear_chromosome_store();  // No genome is left
+    return;
+}
+
+long run_engine(struct rg_engine *e_ptr) {
+    long n_visited;
+
+    start_engine(e_ptr);
+    if (WORKER_LINK != NULL) {
+        run_work_units();
+    }
+    else {
+        bridge(create_genome(N_CHRS, IS_DIPLOID));
+    }
+    finish_progress(progress, g_hash_table_size(seen_somatic_genomes), (seen_budget == NULL ? -1 : seen_budget->n_bytes));
+    n_visited = progress->n_visited;
+    stop_engine(e_ptr);
+
+    return(n_visited);
+}
+
+/*
+    Enables only the rearrangement types of a comma-separated list of the
+    names of the detailed history, e.g. "tb,fb", with no limit on their
+    number. Inverted duplications can be enabled with "id".
+*/
+void set_enabled_rg_types(struct rg_engine *e_ptr, char *types_string) {
+    gchar **fields = g_strsplit(types_string, ",", 0);
+    int i, rg;
+
+    for (rg=0; rg<N_RG_TYPES; rg++) {
+        e_ptr->max_events[rg] = 0;
+    }
+    for (i=0; *(fields+i) != NULL; i++) {
+        rg = txt_to_rg_type(*(fields+i));
+        if (rg < 0) {
+            fprintf(stderr, "Unknown rearrangement type '%s' in types. Exiting.\n", *(fields+i));
+            exit(1);
+        }
+        e_ptr->max_events[rg] = -1;
+    }
+    g_strfreev(fields);
+
+    return;
+}
+
+/*
+    Parses limits given as a comma-separated list of <rg_type>=<n>, e.g.
+    "wcl=1,tb=2". A limit of 0 disables the type.
+*/
+void set_max_events(struct rg_engine *e_ptr, char *max_events_string) {
+    gchar **fields = g_strsplit(max_events_string, ",", 0);
+    char name[8];
+    int i, rg, n;
+
+    for (i=0; *(fields+i) != NULL; i++) {
+        if (sscanf(*(fields+i), "%7[^=]=%d", name, &n) != 2 || n < 0) {
+            fprintf(stderr, "Could not parse limit '%s', expected <rg_type>=<non-negative integer>. Exiting.\n", *(fields+i));
+            exit(1);
+        }
+        rg = txt_to_rg_type(name);
+        if (rg < 0) {
+            fprintf(stderr, "Unknown rearrangement type '%s' in limits. Exiting.\n", name);
+            exit(1);
+        }
+        e_ptr->max_events[rg] = n;
+    }
+    g_strfreev(fields);
+
+    return;
+}
+/*
+    End functions for engines
+*/
@@ -0,0 +1,54 @@
+/*
+    The rearrangement enumerator as a library, see rg_enumerator.h. All the
+    modules are included into this file, which is compiled on its own into
+    librg_enumerator.a, and is included by the program
+    rg_enumerator.multi_chr.no_ids.main.c.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <glib.h>
+#include "rg_enumerator_classes.c"
+#include "rg_enumerator_sink.c"
+#include "rg_enumerator_target.c"
+#include "rg_enumerator_progress.c"
+#include "rg_enumerator_workers.c"
+#include "rg_enumerator.multi_chr.no_ids.c"
+#include "rg_enumerator_predecessors.c"
+#include "rg_enumerator_mitm.c"
+#include "rg_enumerator_sampler.c"
+#include "rg_enumerator_successors.c"
+#include "rg_enumerator_engine.c"
+
+int N_CHRS, IS_DIPLOID, MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
+int MAX_EVENTS_OF_TYPE[N_RG_TYPES] = {
+    [DEL] = -1, [TD] = -1, [INV_DUP] = 0, [INV] = -1, [TEL_BREAK] = -1, [FOLD_BACK] = -1,
+    [BAL_TRANSLOC] = -1, [UNBAL_TRANSLOC] = -1, [WC_DUP] = -1, [WC_DEL] = -1, [WG_DUP] = -1
+};
+int REDUCE_COMMUTING = 0;
+GHashTable *reduced_genomes = NULL;  /* Seen genomes whose expansion was reduced, with REDUCE_COMMUTING */
+GHashTable *seen_somatic_genomes = NULL;
+struct seen_budget *seen_budget = NULL;
+struct shared_seen_set *SHARED_SEEN = NULL;  /* Shared by the worker processes of run_workers() */
+struct worker_link *WORKER_LINK = NULL;  /* Link to the parent, in a worker process */
+struct worker_link **PEER_LINKS = NULL;  /* Links to the other workers, by worker, with a partitioned table of seen genomes */
+int N_WORKERS = 1, WORKER_IDX = 0;
+struct work_stack *WORK_STACK = NULL;    /* Batches being handled, in a worker process */
+GHashTable *chromosome_store = NULL;
+GMutex chromosome_store_lock;
+int chromosome_store_next_id = 0;
+struct target_pattern *TARGET = NULL;
+int TARGET_N_FOUND = 0;
+long N_OUTPUT_BYTES = 0;
+struct genome_sink *SINK = NULL;
+struct progress *progress = NULL;
+__thread struct event_collector *collector = NULL;  /* Per thread, since the sampler enumerates on several threads */
+GThreadPool *batch_pool = NULL;
@@ -0,0 +1,501 @@
+/*
+    Functions for the bidirectional meet-in-the-middle search.
+
+    Instead of enumerating all genomes down to the full depth, the histories
+    of a single target genome are searched by growing two frontiers: forward
+    from the wild type genome with enum_children(), and backward from the
+    target genome with enum_predecessors(). A history of overall depth d is
+    found when a genome at forward depth ceil(d/2) and a genome at backward
+    depth floor(d/2) have the same unique genome string. d is increased until
+    the first such meeting, so only histories of minimal overall depth are
+    reported.
+
+    Backward steps only record the rearrangement type. Each joined history is
+    replayed forward with enum_children() from the meeting genome, which
+    recovers the detailed history (the index of each rearrangement) exactly as
+    the exhaustive enumeration would print it, and validates the join.
+
+    The frontiers are keyed by the unique genome string together with the
+    state that restricts the remaining events: the numbers of duplicative
+    and whole-genome duplication events, and whether the last forward event
+    was a fold-back (only telomeric breaks and fold-backs may follow it). A
+    backward genome keeps every equally short step towards the target, so
+    that all histories through a meeting genome are replayed.
+
+    Undoing a loss of DNA (deletion, telomeric break, fold-back, unbalanced
+    translocation or whole chromosome deletion) restores the lost DNA in its
+    wild type configuration only, so the backward frontier misses histories
+    in which lost DNA had been rearranged before. If the frontiers do not
+    meet within MAX_DEPTH_NONDUP, the forward frontier alone is grown to the
+    full depth, which is the exhaustive search. Histories found by the join
+    are reported with a warning whenever such losses were undone, as shorter
+    histories may have been missed.
+*/
+
+extern int N_CHRS, IS_DIPLOID, MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
+extern int MAX_EVENTS_OF_TYPE[N_RG_TYPES];
+
+struct mitm_step {
+    char *next_key;     /* Key of the next genome towards the target */
+    enum rg_type rg;    /* Rearrangement leading from this genome to the next one */
+};
+
+struct mitm_node {
+    struct genome *g_ptr;
+    char *genome_string;
+    GPtrArray *steps;   /* mitm_steps towards the target, empty for the target itself */
+    int depth;          /* Number of rearrangements between this genome and the target */
+    int dup_depth;
+    int wgd_depth;
+    int allows_fold_back;  /* Remaining events are none or start with a telomeric break or a fold-back */
+};
+
+/*
+    Function prototypes
+*/
+char* get_mitm_key(char *genome_string, int flag, int dup_depth, int wgd_depth);
+struct mitm_node* create_mitm_node(struct genome *g_ptr, char *genome_string, int depth, int dup_depth, int wgd_depth, int allows_fold_back);
+void add_mitm_step(struct mitm_node *n_ptr, char *next_key, enum rg_type rg);
+void delete_mitm_node(struct mitm_node *n_ptr);
+int rg_type_loses_dna(enum rg_type rg);
+void add_missing_wt_chrs(struct genome *g_ptr, int n_wt_chrs);
+GPtrArray* expand_forward_frontier(GPtrArray *frontier, GHashTable *forward_seen, GHashTable *forward_by_string);
+GPtrArray* expand_backward_frontier(GPtrArray *frontier, GHashTable *backward_seen);
+void replay_mitm_history(struct genome *g_ptr, struct mitm_node *n_ptr, GHashTable *backward_seen, GHashTable *histories);
+void join_mitm_frontiers(GPtrArray *backward_nodes, GHashTable *forward_by_string, GHashTable *backward_seen, int depth, GHashTable *histories);
+int compare_strings(const void *a, const void *b);
+int mitm_search(char *target_genome_string);
+/*
+    End function prototypes
+*/
+
+
+char* get_mitm_key(char *genome_string, int flag, int dup_depth, int wgd_depth) {
+    GString *key = g_string_new(NULL);
+    g_string_printf(key, "%s|%d|%d|%d", genome_string, flag, dup_depth, wgd_depth);
+    return(g_string_free(key, 0));
+}
+
+struct mitm_node* create_mitm_node(struct genome *g_ptr, char *genome_string, int depth, int dup_depth, int wgd_depth, int allows_fold_back) {
+    struct mitm_node *n_ptr = malloc(sizeof(struct mitm_node));
+    if (n_ptr == NULL) {
+        fprintf(stderr, "\nCreation of mitm node failed. Exiting.\n");
+        exit(1);
+    }
+    n_ptr->g_ptr = g_ptr;
+    n_ptr->genome_string = g_strdup(genome_string);
+    n_ptr->steps = g_ptr_array_new();
+    n_ptr->depth = depth;
+    n_ptr->dup_depth = dup_depth;
+    n_ptr->wgd_depth = wgd_depth;
+    n_ptr->allows_fold_back = allows_fold_back;
+    return(n_ptr);
+}
+
+void add_mitm_step(struct mitm_node *n_ptr, char *next_key, enum rg_type rg) {
+    struct mitm_step *s_ptr = malloc(sizeof(struct mitm_step));
+    if (s_ptr == NULL) {
+        fprintf(stderr, "\nCreation of mitm step failed. Exiting.\n");
+        exit(1);
+    }
+    s_ptr->next_key = g_strdup(next_key);
+    s_ptr->rg = rg;
+    g_ptr_array_add(n_ptr->steps, s_ptr);
+    return;
+}
+
+void delete_mitm_node(struct mitm_node *n_ptr) {
+    guint i;
+    struct mitm_step *s_ptr;
+    delete_genome(n_ptr->g_ptr);
+    g_free(n_ptr->genome_string);
+    for (i=0; i<n_ptr->steps->len; i++) {
+        s_ptr = (struct mitm_step*)g_ptr_array_index(n_ptr->steps, i);
+        g_free(s_ptr->next_key);
+        free(s_ptr);
+    }
+    g_ptr_array_free(n_ptr->steps, 1);
+    free(n_ptr);
+    return;
+}
+
+/*
+    Whether undoing a rearrangement of type rg has to guess the lost DNA,
+    which enum_predecessors() restores in its wild type configuration only.
+*/
+int rg_type_loses_dna(enum rg_type rg) {
+    return(rg == DEL || rg == TEL_BREAK || rg == FOLD_BACK || rg == UNBAL_TRANSLOC || rg == WC_DEL);
+}
+
+/*
+    Fully lost WT chromosomes do not appear in unique genome strings. Adds
+    their reference segments to g_ptr->genome_segs so that whole chromosome
+    deletions can be undone.
+*/
+void add_missing_wt_chrs(struct genome *g_ptr, int n_wt_chrs) {
+    int n_present = *((*(g_ptr->genome_segs+g_ptr->n_genome_segs-1))->seg_indexes+0) + 1;
+    int i;
+    if (n_present >= n_wt_chrs) {
+        return;
+    }
+
+    g_ptr->genome_segs = realloc(g_ptr->genome_segs, (g_ptr->n_genome_segs + n_wt_chrs - n_present) * sizeof(struct seg*));
+    if (g_ptr->genome_segs == NULL) {
+        fprintf(stderr, "\nFailed to realloc g_ptr->genome_segs in add_missing_wt_chrs(). Exiting.\n");
+        exit(1);
+    }
+    for (i=n_present; i<n_wt_chrs; i++) {
+        *(g_ptr->genome_segs+g_ptr->n_genome_segs) = create_seg(i, 0);
+        g_ptr->n_genome_segs++;
+    }
+    forget_bp_uses(g_ptr);
+
+    return;
+}
+
+/*
+    Expands all genomes of the forward frontier by one rearrangement and
+    returns the genomes not seen before as the next frontier.
+*/
+GPtrArray* expand_forward_frontier(GPtrArray *frontier, GHashTable *forward_seen, GHashTable *forward_by_string) {
+    guint i, j;
+    int ends_in_fold_back;
+    GString *genome_string = g_string_new(NULL);
+    char *key;
+    struct genome *g_ptr, *child_ptr;
+    GPtrArray *children, *same_string_genomes;
+    GPtrArray *next_frontier = g_ptr_array_new();
+
+    for (i=0; i<frontier->len; i++) {
+        g_ptr = (struct genome*)g_ptr_array_index(frontier, i);
+        children = g_ptr_array_new();
+        enum_children(g_ptr, children, g_ptr->dup_depth < MAX_DEPTH_DUP);
+
+        for (j=0; j<children->len; j++) {
+            child_ptr = (struct genome*)g_ptr_array_index(children, j);
+            get_unique_genome_string(child_ptr, genome_string);
+            ends_in_fold_back = (*(child_ptr->history+child_ptr->depth-1) == FOLD_BACK);
+            key = get_mitm_key(genome_string->str, ends_in_fold_back, child_ptr->dup_depth, child_ptr->wgd_depth);
+
+            if (g_hash_table_contains(forward_seen, key)) {
+                g_free(key);
+                delete_genome(child_ptr);
+                continue;
+            }
+            g_hash_table_insert(forward_seen, key, child_ptr);
+
+            same_string_genomes = (GPtrArray*)g_hash_table_lookup(forward_by_string, genome_string->str);
+            if (same_string_genomes == NULL) {
+                same_string_genomes = g_ptr_array_new();
+                g_hash_table_insert(forward_by_string, g_strdup(genome_string->str), same_string_genomes);
+            }
+            g_ptr_array_add(same_string_genomes, child_ptr);
+            g_ptr_array_add(next_frontier, child_ptr);
+        }
+
+        g_ptr_array_free(children, 1);
+    }
+
+    g_string_free(genome_string, 1);
+    return(next_frontier);
+}
+
+/*
+    Expands all genomes of the backward frontier by one rearrangement towards
+    the wild type genome and returns the genomes not seen before as the next
+    frontier. Genomes seen before at the same depth gain another step.
+*/
+GPtrArray* expand_backward_frontier(GPtrArray *frontier, GHashTable *backward_seen) {
+    guint i, j, k;
+    int dup_depth, wgd_depth;
+    GString *genome_string = g_string_new(NULL);
+    char *key, *n_key;
+    enum rg_type rg;
+    enum rg_type rg_types[] = {DEL, INV, TEL_BREAK, BAL_TRANSLOC, UNBAL_TRANSLOC, WC_DEL, TD, FOLD_BACK, WC_DUP, WG_DUP};
+    struct mitm_node *n_ptr, *pred_n_ptr;
+    struct genome *pred_ptr;
+    GPtrArray *predecessors;
+    GPtrArray *next_frontier = g_ptr_array_new();
+
+    for (i=0; i<frontier->len; i++) {
+        n_ptr = (struct mitm_node*)g_ptr_array_index(frontier, i);
+        n_key = get_mitm_key(n_ptr->genome_string, n_ptr->allows_fold_back, n_ptr->dup_depth, n_ptr->wgd_depth);
+
+        for (j=0; j<sizeof(rg_types)/sizeof(enum rg_type); j++) {
+            rg = rg_types[j];
+            dup_depth = n_ptr->dup_depth + rg_type_is_dup(rg);
+            wgd_depth = n_ptr->wgd_depth + (rg == WG_DUP);
+            if (
+                MAX_EVENTS_OF_TYPE[rg] == 0 ||
+                dup_depth > MAX_DEPTH_DUP ||
+                wgd_depth > 1 ||
+                (rg == FOLD_BACK && !n_ptr->allows_fold_back)
+            ) {
+                continue;
+            }
+
+            predecessors = g_ptr_array_new();
+            enum_predecessors(n_ptr->g_ptr, rg, predecessors);
+            for (k=0; k<predecessors->len; k++) {
+                pred_ptr = (struct genome*)g_ptr_array_index(predecessors, k);
+                if (pred_ptr->n_chrs == 0) {
+                    delete_genome(pred_ptr);
+                    continue;
+                }
+
+                get_unique_genome_string(pred_ptr, genome_string);
+                key = get_mitm_key(genome_string->str, (rg == TEL_BREAK || rg == FOLD_BACK), dup_depth, wgd_depth);
+                pred_n_ptr = (struct mitm_node*)g_hash_table_lookup(backward_seen, key);
+                if (pred_n_ptr != NULL) {
+                    if (pred_n_ptr->depth == n_ptr->depth + 1) {
+                        add_mitm_step(pred_n_ptr, n_key, rg);
+                    }
+                    g_free(key);
+                    delete_genome(pred_ptr);
+                    continue;
+                }
+
+                pred_n_ptr = create_mitm_node(
+                    pred_ptr, genome_string->str, n_ptr->depth + 1, dup_depth, wgd_depth, (rg == TEL_BREAK || rg == FOLD_BACK)
+                );
+                add_mitm_step(pred_n_ptr, n_key, rg);
+                g_hash_table_insert(backward_seen, key, pred_n_ptr);
+                g_ptr_array_add(next_frontier, pred_n_ptr);
+            }
+            g_ptr_array_free(predecessors, 1);
+        }
+
+        g_free(n_key);
+    }
+
+    g_string_free(genome_string, 1);
+    return(next_frontier);
+}
+
+/*
+    Applies the rearrangements from *n_ptr towards the target to *g_ptr, which
+    has the same unique genome string as *n_ptr, by forward enumeration. All
+    completed histories are stored in *histories, keyed by detailed history.
+    *g_ptr is consumed.
+*/
+void replay_mitm_history(struct genome *g_ptr, struct mitm_node *n_ptr, GHashTable *backward_seen, GHashTable *histories) {
+    guint i, j;
+    GString *genome_string;
+    char *history;
+    struct genome *child_ptr;
+    struct mitm_step *s_ptr;
+    struct mitm_node *next_n_ptr;
+    GPtrArray *children;
+
+    if (n_ptr->steps->len == 0) {
+        history = get_detailed_history(g_ptr);
+        if (g_hash_table_contains(histories, history)) {
+            g_free(history);
+            delete_genome(g_ptr);
+        }
+        else {
+            g_hash_table_insert(histories, history, g_ptr);
+        }
+        return;
+    }
+
+    genome_string = g_string_new(NULL);
+    children = g_ptr_array_new();
+    enum_children(g_ptr, children, g_ptr->dup_depth < MAX_DEPTH_DUP);
+    for (i=0; i<children->len; i++) {
+        child_ptr = (struct genome*)g_ptr_array_index(children, i);
+        get_unique_genome_string(child_ptr, genome_string);
+        for (j=0; j<n_ptr->steps->len; j++) {
+            s_ptr = (struct mitm_step*)g_ptr_array_index(n_ptr->steps, j);
+            if (*(child_ptr->history+child_ptr->depth-1) != s_ptr->rg) {
+                continue;
+            }
+            next_n_ptr = (struct mitm_node*)g_hash_table_lookup(backward_seen, s_ptr->next_key);
+            if (strcmp(genome_string->str, next_n_ptr->genome_string) == 0) {
+                replay_mitm_history(copy_genome(child_ptr), next_n_ptr, backward_seen, histories);
+            }
+        }
+        delete_genome(child_ptr);
+    }
+
+    g_ptr_array_free(children, 1);
+    g_string_free(genome_string, 1);
+    delete_genome(g_ptr);
+    return;
+}
+
+/*
+    Replays the histories of overall depth exactly depth through the genomes
+    of *backward_nodes that also occur in the forward frontier.
+*/
+void join_mitm_frontiers(GPtrArray *backward_nodes, GHashTable *forward_by_string, GHashTable *backward_seen, int depth, GHashTable *histories) {
+    guint i, j;
+    struct mitm_node *n_ptr;
+    struct genome *g_ptr;
+    GPtrArray *same_string_genomes;
+
+    for (i=0; i<backward_nodes->len; i++) {
+        n_ptr = (struct mitm_node*)g_ptr_array_index(backward_nodes, i);
+        same_string_genomes = (GPtrArray*)g_hash_table_lookup(forward_by_string, n_ptr->genome_string);
+        if (same_string_genomes == NULL) {
+            continue;
+        }
+        for (j=0; j<same_string_genomes->len; j++) {
+            g_ptr = (struct genome*)g_ptr_array_index(same_string_genomes, j);
+            if (
+                g_ptr->depth + n_ptr->depth != depth ||
+                g_ptr->dup_depth + n_ptr->dup_depth > MAX_DEPTH_DUP ||
+                g_ptr->wgd_depth + n_ptr->wgd_depth > 1 ||
+                (g_ptr->depth > 0 && *(g_ptr->history+g_ptr->depth-1) == FOLD_BACK && !n_ptr->allows_fold_back)
+            ) {
+                continue;
+            }
+            replay_mitm_history(copy_genome(g_ptr), n_ptr, backward_seen, histories);
+        }
+    }
+    return;
+}
+
+int compare_strings(const void *a, const void *b) {
+    return(strcmp(*(char* const*)a, *(char* const*)b));
+}
+
+/*
+    Prints all minimal histories of the genome given by *target_genome_string
+    within MAX_DEPTH_NONDUP and MAX_DEPTH_DUP, and returns their number.
+*/
+int mitm_search(char *target_genome_string) {
+    GString *genome_string = g_string_new(NULL);
+    int i, depth, forward_depth = 0, backward_depth = 0, n_found = 0, may_miss_losses = 0;
+    guint k;
+
+    // Target genome
+    struct genome *target_ptr = genome_from_unique_genome_string(target_genome_string);
+    get_unique_genome_string(target_ptr, genome_string);
+    if (strcmp(genome_string->str, target_genome_string) != 0) {
+        fprintf(stderr, "Genome string '%s' is not in its normalised form '%s'. Exiting.\n", target_genome_string, genome_string->str);
+        exit(1);
+    }
+    if (*((*(target_ptr->genome_segs+target_ptr->n_genome_segs-1))->seg_indexes+0) + 1 > N_CHRS) {
+        fprintf(stderr, "Genome string '%s' has more than %d WT chromosomes. Exiting.\n", target_genome_string, N_CHRS);
+        exit(1);
+    }
+    add_missing_wt_chrs(target_ptr, N_CHRS);
+
+    GHashTable *forward_seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)delete_genome);
+    GHashTable *forward_by_string = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    GHashTable *backward_seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)delete_mitm_node);
+    GHashTable *histories = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)delete_genome);
+
+    // Depth 0 of both frontiers
+    struct genome *wt_ptr = create_genome(N_CHRS, IS_DIPLOID);
+    get_unique_genome_string(wt_ptr, genome_string);
+    g_hash_table_insert(forward_seen, get_mitm_key(genome_string->str, 0, 0, 0), wt_ptr);
+    GPtrArray *same_string_genomes = g_ptr_array_new();
+    g_ptr_array_add(same_string_genomes, wt_ptr);
+    g_hash_table_insert(forward_by_string, g_strdup(genome_string->str), same_string_genomes);
+    GPtrArray *forward_frontier = g_ptr_array_new();
+    g_ptr_array_add(forward_frontier, wt_ptr);
+
+    struct mitm_node *target_n_ptr = create_mitm_node(target_ptr, target_genome_string, 0, 0, 0, 1);
+    g_hash_table_insert(backward_seen, get_mitm_key(target_genome_string, 1, 0, 0), target_n_ptr);
+    GPtrArray *backward_frontier = g_ptr_array_new();
+    g_ptr_array_add(backward_frontier, target_n_ptr);
+
+    GPtrArray *tmp_frontier;
+    GPtrArray *backward_nodes = g_ptr_array_new();
+    g_ptr_array_add(backward_nodes, target_n_ptr);
+
+    for (depth=0; depth<=MAX_DEPTH_NONDUP; depth++) {
+        fprintf(stderr, "Meet-in-the-middle search at depth %d...\n", depth);
+
+        // Grow the frontiers to ceil(depth/2) forward and floor(depth/2) backward rearrangements
+        if (forward_depth < (depth + 1) / 2) {
+            tmp_frontier = expand_forward_frontier(forward_frontier, forward_seen, forward_by_string);
+            g_ptr_array_free(forward_frontier, 1);
+            forward_frontier = tmp_frontier;
+            forward_depth++;
+        }
+        if (backward_depth < depth / 2) {
+            tmp_frontier = expand_backward_frontier(backward_frontier, backward_seen);
+            g_ptr_array_free(backward_frontier, 1);
+            backward_frontier = tmp_frontier;
+            for (k=0; k<backward_frontier->len; k++) {
+                g_ptr_array_add(backward_nodes, g_ptr_array_index(backward_frontier, k));
+            }
+            backward_depth++;
+        }
+
+        // Join the frontiers on genomes with an overall depth of exactly depth
+        join_mitm_frontiers(backward_nodes, forward_by_string, backward_seen, depth, histories);
+
+        if (g_hash_table_size(histories) > 0) {
+            break;
+        }
+    }
+
+    // Shorter or further histories can hide behind undone losses of rearranged DNA once the backward frontier is used
+    for (i=0; i<N_RG_TYPES && depth >= 2; i++) {
+        if (rg_type_loses_dna(i) && MAX_EVENTS_OF_TYPE[i] != 0) {
+            may_miss_losses = 1;
+        }
+    }
+
+    // Fall back to the exhaustive search by growing the forward frontier alone
+    if (g_hash_table_size(histories) == 0) {
+        g_ptr_array_set_size(backward_nodes, 1);
+        may_miss_losses = 0;
+        while (forward_depth < MAX_DEPTH_NONDUP && g_hash_table_size(histories) == 0) {
+            fprintf(stderr, "Exhaustive forward search at depth %d...\n", forward_depth + 1);
+            tmp_frontier = expand_forward_frontier(forward_frontier, forward_seen, forward_by_string);
+            g_ptr_array_free(forward_frontier, 1);
+            forward_frontier = tmp_frontier;
+            forward_depth++;
+            join_mitm_frontiers(backward_nodes, forward_by_string, backward_seen, forward_depth, histories);
+        }
+    }
+
+    // Print the histories in a defined order
+    n_found = g_hash_table_size(histories);
+    char **history_keys = malloc((n_found > 0 ? n_found : 1) * sizeof(char*));
+    if (history_keys == NULL) {
+        fprintf(stderr, "\nFailed to malloc history_keys in mitm_search(). Exiting.\n");
+        exit(1);
+    }
+    i = 0;
+    void iterator(gpointer key, gpointer val, gpointer data) {
+        (void)val;
+        (void)data;
+        *(history_keys+i) = (char*)key;
+        i++;
+    }
+    g_hash_table_foreach(histories, (GHFunc)iterator, NULL);
+    qsort(history_keys, n_found, sizeof(char*), compare_strings);
+    for (i=0; i<n_found; i++) {
+        print_genome((struct genome*)g_hash_table_lookup(histories, *(history_keys+i)), target_genome_string);
+    }
+    free(history_keys);
+    if (may_miss_losses) {
+        fprintf(stderr, "Warning: undone losses of DNA were restored in their wild type configuration only, histories in which lost DNA had been rearranged before may be missing.\n");
+    }
+
+    g_ptr_array_free(forward_frontier, 1);
+    g_ptr_array_free(backward_frontier, 1);
+    g_ptr_array_free(backward_nodes, 1);
+    void free_ptr_array(gpointer key, gpointer val, gpointer data) {
+        (void)key;
+        (void)data;
+        g_ptr_array_free((GPtrArray*)val, 1);
+    }
+    g_hash_table_foreach(forward_by_string, (GHFunc)free_ptr_array, NULL);
+    g_hash_table_destroy(forward_by_string);
+    g_hash_table_destroy(forward_seen);
+    g_hash_table_destroy(backward_seen);
+    g_hash_table_destroy(histories);
+    g_string_free(genome_string, 1);
+
+    return(n_found);
+}
+/*
+    End functions for the bidirectional meet-in-the-middle search
+*/
@@ -0,0 +1,575 @@
+/*
+    Inverse operators of the rearrangement enumerators.
+
+    For a given simplified genome and rg_type, the enum_pred_* functions
+    enumerate the genomes that give the input genome (up to the unique genome
+    string) after one event of the given type. Predecessors are appended to
+    a GPtrArray as simplified genomes without history.
+
+    Every event creates its junctions between new breakpoints, so undoing
+    an event must turn each of its junctions into a natural join, i.e. the
+    two segments are reference neighbours in reference orientation. This is
+    what the functions below test for.
+
+    Inversions, tandem duplications, balanced translocations, whole chromosome
+    duplications and whole genome duplications lose no DNA, and their inverses
+    are exact. Deletions, telomeric breaks, fold-backs, unbalanced
+    translocations and whole chromosome deletions lose DNA. Their inverses
+    restore the lost DNA in reference configuration only, so predecessors in
+    which the lost DNA was itself rearranged are not enumerated.
+*/
+
+extern int IS_DIPLOID;
+
+/*
+    Function prototypes
+*/
+int is_natural_join(struct genome *g_ptr, struct seg *s1_ptr, int s1_is_plus, struct seg *s2_ptr, int s2_is_plus);
+int segs_are_identical(struct seg *s1_ptr, struct seg *s2_ptr);
+int chromosomes_are_identical(struct chromosome *c1_ptr, struct chromosome *c2_ptr);
+struct chromosome* get_reference_segs(struct genome *g_ptr, int from, int to, int is_plus, int is_maternal);
+struct chromosome* get_reference_flank(struct genome *g_ptr, struct seg *s_ptr, int to_right);
+struct chromosome* get_reference_gap(struct genome *g_ptr, struct seg *s1_ptr, struct seg *s2_ptr);
+void add_chromosome_to_genome(struct genome *g_ptr, struct chromosome *c_ptr);
+
+void enum_predecessors(struct genome *g_ptr, enum rg_type rg, GPtrArray *predecessors);
+void enum_pred_dels(struct genome *g_ptr, GPtrArray *predecessors);
+void enum_pred_tds(struct genome *g_ptr, GPtrArray *predecessors);
+void enum_pred_invs(struct genome *g_ptr, GPtrArray *predecessors);
+void enum_pred_tel_breaks(struct genome *g_ptr, GPtrArray *predecessors);
+void enum_pred_fbs(struct genome *g_ptr, GPtrArray *predecessors);
+void enum_pred_bal_translocs(struct genome *g_ptr, GPtrArray *predecessors);
+void enum_pred_unbal_translocs(struct genome *g_ptr, GPtrArray *predecessors);
+void enum_pred_wc_dups(struct genome *g_ptr, GPtrArray *predecessors);
+void enum_pred_wc_dels(struct genome *g_ptr, GPtrArray *predecessors);
+void enum_pred_wg_dups(struct genome *g_ptr, GPtrArray *predecessors);
+/*
+    End function prototypes
+*/
+
+
+/*
+    Helper functions
+*/
+/* Would *s1_ptr followed by *s2_ptr, in the given orientations, be a join that exists in the reference? */
+int is_natural_join(struct genome *g_ptr, struct seg *s1_ptr, int s1_is_plus, struct seg *s2_ptr, int s2_is_plus) {
+    if (
+        s1_ptr->is_maternal != s2_ptr->is_maternal ||
+        s1_is_plus != s2_is_plus ||
+        *(s1_ptr->seg_indexes+0) != *(s2_ptr->seg_indexes+0)  // Both segments must come from the same WT chromosome
+    ) {
+        return(0);
+    }
+
+    int seg1_idx = find_genome_seg_idx(g_ptr, s1_ptr);
+    int seg2_idx = find_genome_seg_idx(g_ptr, s2_ptr);
+    return(s1_is_plus ? seg1_idx + 1 == seg2_idx : seg1_idx - 1 == seg2_idx);
+}
+
+int segs_are_identical(struct seg *s1_ptr, struct seg *s2_ptr) {
+    return(
+        s1_ptr->is_plus == s2_ptr->is_plus &&
+        s1_ptr->is_maternal == s2_ptr->is_maternal &&
+        int_array_cmp(s1_ptr->times_divided, s1_ptr->seg_indexes, s2_ptr->times_divided, s2_ptr->seg_indexes)
+    );
+}
+
+/* Are the two chromosomes identical in either orientation? */
+int chromosomes_are_identical(struct chromosome *c1_ptr, struct chromosome *c2_ptr) {
+    struct chromosome_info *info1 = get_chromosome_info(c1_ptr);
+    struct chromosome_info *info2 = get_chromosome_info(c2_ptr);
+    return(info1->id == info2->id || info1->id == info2->reverse_id);
+}
+
+/*
+    Returns a chromosome with the reference segments g_ptr->genome_segs[from..to]
+    in reference order if is_plus, or the same segments in reverse order and
+    orientation otherwise.
+*/
+struct chromosome* get_reference_segs(struct genome *g_ptr, int from, int to, int is_plus, int is_maternal) {
+    struct chromosome *c_ptr = malloc(sizeof(struct chromosome));
+    if (c_ptr == NULL) {
+        fprintf(stderr, "\nCreation of chromosome node failed. Exiting.\n");
+        exit(1);
+    }
+    c_ptr->n_segs = to - from + 1;
+    c_ptr->info = NULL;
+    c_ptr->used_bps = NULL;
+    c_ptr->n_used_bps = -1;
+    c_ptr->used_bps_changed = 0;
+    c_ptr->root_seg = malloc(c_ptr->n_segs * sizeof(struct seg*));
+    if (c_ptr->root_seg == NULL) {
+        fprintf(stderr, "\nCreation of root seg node failed. Exiting.\n");
+        exit(1);
+    }
+
+    int i;
+    struct seg *s_ptr;
+    for (i=0; i<c_ptr->n_segs; i++) {
+        s_ptr = copy_seg(*(g_ptr->genome_segs + (is_plus ? from + i : to - i)));
+        s_ptr->is_plus = is_plus;
+        s_ptr->is_maternal = is_maternal;
+        *(c_ptr->root_seg+i) = s_ptr;
+    }
+
+    return(c_ptr);
+}
+
+/*
+    Returns the reference segments that follow (to_right) or precede (!to_right)
+    *s_ptr in its reading direction up to the telomere of its WT chromosome,
+    or NULL if *s_ptr already is at the telomere.
+*/
+struct chromosome* get_reference_flank(struct genome *g_ptr, struct seg *s_ptr, int to_right) {
+    int seg_idx = find_genome_seg_idx(g_ptr, s_ptr);
+    int wt_chr = *(s_ptr->seg_indexes+0);
+    int first = seg_idx, last = seg_idx;
+    while (first > 0 && *((*(g_ptr->genome_segs+first-1))->seg_indexes+0) == wt_chr) { first--; }
+    while (last < g_ptr->n_genome_segs-1 && *((*(g_ptr->genome_segs+last+1))->seg_indexes+0) == wt_chr) { last++; }
+
+    if (to_right == s_ptr->is_plus) {  // Flank extends towards the q-telomere of the WT chromosome
+        if (seg_idx == last) { return(NULL); }
+        return(get_reference_segs(g_ptr, seg_idx+1, last, s_ptr->is_plus, s_ptr->is_maternal));
+    }
+    else {
+        if (seg_idx == first) { return(NULL); }
+        return(get_reference_segs(g_ptr, first, seg_idx-1, s_ptr->is_plus, s_ptr->is_maternal));
+    }
+}
+
+/*
+    Returns the reference segments between *s1_ptr and *s2_ptr if *s1_ptr
+    followed by these segments and *s2_ptr would be the reference, or NULL
+    otherwise.
+*/
+struct chromosome* get_reference_gap(struct genome *g_ptr, struct seg *s1_ptr, struct seg *s2_ptr) {
+    if (
+        s1_ptr->is_maternal != s2_ptr->is_maternal ||
+        s1_ptr->is_plus != s2_ptr->is_plus ||
+        *(s1_ptr->seg_indexes+0) != *(s2_ptr->seg_indexes+0)
+    ) {
+        return(NULL);
+    }
+
+    int seg1_idx = find_genome_seg_idx(g_ptr, s1_ptr);
+    int seg2_idx = find_genome_seg_idx(g_ptr, s2_ptr);
+    if (s1_ptr->is_plus && seg2_idx > seg1_idx + 1) {
+        return(get_reference_segs(g_ptr, seg1_idx+1, seg2_idx-1, 1, s1_ptr->is_maternal));
+    }
+    else if (!s1_ptr->is_plus && seg2_idx < seg1_idx - 1) {
+        return(get_reference_segs(g_ptr, seg2_idx+1, seg1_idx-1, 0, s1_ptr->is_maternal));
+    }
+
+    return(NULL);
+}
+
+void add_chromosome_to_genome(struct genome *g_ptr, struct chromosome *c_ptr) {
+    g_ptr->n_chrs += 1;
+    g_ptr->root_chr = realloc(g_ptr->root_chr, g_ptr->n_chrs * (sizeof(struct chromosome*)));
+    if (g_ptr->root_chr == NULL) {
+        fprintf(stderr, "\nrealloc of g_ptr->root_chr failed. Exiting.\n");
+        exit(1);
+    }
+    *(g_ptr->root_chr + g_ptr->n_chrs - 1) = c_ptr;
+    return;
+}
+/*
+    End helper functions
+*/
+
+
+/*
+    Predecessor enumeration functions
+*/
+void enum_predecessors(struct genome *g_ptr, enum rg_type rg, GPtrArray *predecessors) {
+    switch(rg) {
+        case DEL            : enum_pred_dels(g_ptr, predecessors); break;
+        case TD             : enum_pred_tds(g_ptr, predecessors); break;
+        case INV            : enum_pred_invs(g_ptr, predecessors); break;
+        case TEL_BREAK      : enum_pred_tel_breaks(g_ptr, predecessors); break;
+        case FOLD_BACK      : enum_pred_fbs(g_ptr, predecessors); break;
+        case BAL_TRANSLOC   : enum_pred_bal_translocs(g_ptr, predecessors); break;
+        case UNBAL_TRANSLOC : enum_pred_unbal_translocs(g_ptr, predecessors); break;
+        case WC_DUP         : enum_pred_wc_dups(g_ptr, predecessors); break;
+        case WC_DEL         : enum_pred_wc_dels(g_ptr, predecessors); break;
+        case WG_DUP         : enum_pred_wg_dups(g_ptr, predecessors); break;
+        case INV_DUP        : break;  // Not enumerated in bridge() by default either
+    }
+    return;
+}
+
+void enum_pred_dels(struct genome *g_ptr, GPtrArray *predecessors) {
+    int c_idx, s_idx;
+    struct chromosome *c_ptr, *deleted_segs;
+    struct genome *new_g_ptr;
+
+    // Re-insert the reference segments between the two ends of a deletion junction
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+        for (s_idx=0; s_idx<c_ptr->n_segs-1; s_idx++) {
+            deleted_segs = get_reference_gap(g_ptr, *(c_ptr->root_seg+s_idx), *(c_ptr->root_seg+s_idx+1));
+            if (deleted_segs == NULL) {
+                continue;
+            }
+            new_g_ptr = copy_genome(g_ptr);
+            insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), deleted_segs, s_idx+1);
+            simplify_genome(new_g_ptr);
+            g_ptr_array_add(predecessors, new_g_ptr);
+            delete_chromosome(deleted_segs);
+        }
+    }
+
+    return;
+}
+
+void enum_pred_tds(struct genome *g_ptr, GPtrArray *predecessors) {
+    int c_idx, from, len, i, is_tandem;
+    struct chromosome *c_ptr;
+    struct genome *new_g_ptr;
+
+    /*
+        A tandem duplication of segments B..Y in A B..Y Z gives A B..Y B..Y Z,
+        where A B and Y Z are natural joins and Y B is the new junction.
+    */
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+        for (from=1; from<c_ptr->n_segs; from++) {
+            for (len=1; from+2*len < c_ptr->n_segs; len++) {
+                is_tandem = 1;
+                for (i=0; i<len; i++) {
+                    if (!segs_are_identical(*(c_ptr->root_seg+from+i), *(c_ptr->root_seg+from+len+i))) {
+                        is_tandem = 0;
+                        break;
+                    }
+                }
+                if (
+                    !is_tandem ||
+                    is_natural_join(g_ptr, *(c_ptr->root_seg+from+len-1), (*(c_ptr->root_seg+from+len-1))->is_plus, *(c_ptr->root_seg+from+len), (*(c_ptr->root_seg+from+len))->is_plus) ||
+                    !is_natural_join(g_ptr, *(c_ptr->root_seg+from-1), (*(c_ptr->root_seg+from-1))->is_plus, *(c_ptr->root_seg+from), (*(c_ptr->root_seg+from))->is_plus) ||
+                    !is_natural_join(g_ptr, *(c_ptr->root_seg+from+len-1), (*(c_ptr->root_seg+from+len-1))->is_plus, *(c_ptr->root_seg+from+2*len), (*(c_ptr->root_seg+from+2*len))->is_plus)
+                ) {
+                    continue;
+                }
+
+                new_g_ptr = copy_genome(g_ptr);
+                delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), from+len, from+2*len-1);
+                simplify_genome(new_g_ptr);
+                g_ptr_array_add(predecessors, new_g_ptr);
+            }
+        }
+    }
+
+    return;
+}
+
+void enum_pred_invs(struct genome *g_ptr, GPtrArray *predecessors) {
+    int c_idx, from, to;
+    struct chromosome *c_ptr;
+    struct seg *first_ptr, *last_ptr;
+    struct genome *new_g_ptr;
+
+    // Inverting segments from..to back must turn both flanking junctions into natural joins
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+        for (from=1; from<c_ptr->n_segs-1; from++) {
+            first_ptr = *(c_ptr->root_seg+from);
+            if (is_natural_join(g_ptr, *(c_ptr->root_seg+from-1), (*(c_ptr->root_seg+from-1))->is_plus, first_ptr, first_ptr->is_plus)) {
+                continue;
+            }
+            for (to=from; to<c_ptr->n_segs-1; to++) {
+                last_ptr = *(c_ptr->root_seg+to);
+                if (
+                    !is_natural_join(g_ptr, *(c_ptr->root_seg+from-1), (*(c_ptr->root_seg+from-1))->is_plus, last_ptr, !last_ptr->is_plus) ||
+                    !is_natural_join(g_ptr, first_ptr, !first_ptr->is_plus, *(c_ptr->root_seg+to+1), (*(c_ptr->root_seg+to+1))->is_plus)
+                ) {
+                    continue;
+                }
+
+                new_g_ptr = copy_genome(g_ptr);
+                invert_segs_in_chr(*(new_g_ptr->root_chr+c_idx), from, to);
+                simplify_genome(new_g_ptr);
+                g_ptr_array_add(predecessors, new_g_ptr);
+            }
+        }
+    }
+
+    return;
+}
+
+void enum_pred_tel_breaks(struct genome *g_ptr, GPtrArray *predecessors) {
+    int c_idx;
+    struct chromosome *c_ptr, *lost_segs;
+    struct genome *new_g_ptr;
+
+    // Restore the reference segments beyond either end of a chromosome
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+
+        lost_segs = get_reference_flank(g_ptr, *(c_ptr->root_seg+0), 0);
+        if (lost_segs != NULL) {
+            new_g_ptr = copy_genome(g_ptr);
+            insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), lost_segs, 0);
+            simplify_genome(new_g_ptr);
+            g_ptr_array_add(predecessors, new_g_ptr);
+            delete_chromosome(lost_segs);
+        }
+
+        lost_segs = get_reference_flank(g_ptr, *(c_ptr->root_seg+c_ptr->n_segs-1), 1);
+        if (lost_segs != NULL) {
+            new_g_ptr = copy_genome(g_ptr);
+            insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), lost_segs, c_ptr->n_segs);
+            simplify_genome(new_g_ptr);
+            g_ptr_array_add(predecessors, new_g_ptr);
+            delete_chromosome(lost_segs);
+        }
+    }
+
+    return;
+}
+
+void enum_pred_fbs(struct genome *g_ptr, GPtrArray *predecessors) {
+    int c_idx, half, i, is_palindrome;
+    struct chromosome *c_ptr, *lost_segs;
+    struct seg *s1_ptr, *s2_ptr;
+    struct genome *new_g_ptr;
+
+    /*
+        A fold-back of the retained segments S gives the palindrome S' S (or
+        S S', which is the same chromosome read the other way). Undoing it
+        removes S' and restores the lost telomeric segments in front of S.
+    */
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+        if (c_ptr->n_segs % 2 != 0) {
+            continue;
+        }
+        half = c_ptr->n_segs / 2;
+
+        is_palindrome = 1;
+        for (i=0; i<half; i++) {
+            s1_ptr = *(c_ptr->root_seg+half-1-i);
+            s2_ptr = *(c_ptr->root_seg+half+i);
+            if (
+                s1_ptr->is_plus == s2_ptr->is_plus ||
+                s1_ptr->is_maternal != s2_ptr->is_maternal ||
+                !int_array_cmp(s1_ptr->times_divided, s1_ptr->seg_indexes, s2_ptr->times_divided, s2_ptr->seg_indexes)
+            ) {
+                is_palindrome = 0;
+                break;
+            }
+        }
+        if (!is_palindrome) {
+            continue;
+        }
+
+        lost_segs = get_reference_flank(g_ptr, *(c_ptr->root_seg+half), 0);
+        if (lost_segs == NULL) {
+            continue;
+        }
+        new_g_ptr = copy_genome(g_ptr);
+        delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), 0, half-1);
+        insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), lost_segs, 0);
+        simplify_genome(new_g_ptr);
+        g_ptr_array_add(predecessors, new_g_ptr);
+        delete_chromosome(lost_segs);
+    }
+
+    return;
+}
+
+void enum_pred_bal_translocs(struct genome *g_ptr, GPtrArray *predecessors) {
+    int c1_idx, c2_idx, b1, b2, c2_is_inverted;
+    struct chromosome *c1_ptr, *c2_ptr, *seg_holder1, *seg_holder2;
+    struct genome *new_g_ptr;
+
+    /*
+        Chromosomes A B and C D with junctions between A and B and C and D are
+        the products of a balanced translocation between A D and C B if the
+        joins A D and C B are natural. Both translocation cases are covered by
+        trying the second chromosome in both orientations.
+    */
+    for (c1_idx=0; c1_idx<g_ptr->n_chrs; c1_idx++) {
+    for (c2_idx=c1_idx+1; c2_idx<g_ptr->n_chrs; c2_idx++) {
+    for (c2_is_inverted=0; c2_is_inverted<=1; c2_is_inverted++) {
+        c1_ptr = *(g_ptr->root_chr+c1_idx);
+        c2_ptr = copy_chromosome(*(g_ptr->root_chr+c2_idx));
+        if (c2_is_inverted) {
+            invert_segs_in_chr(c2_ptr, 0, c2_ptr->n_segs-1);
+        }
+
+        for (b1=0; b1<c1_ptr->n_segs-1; b1++) {
+        for (b2=0; b2<c2_ptr->n_segs-1; b2++) {
+            if (
+                !is_natural_join(g_ptr, *(c1_ptr->root_seg+b1), (*(c1_ptr->root_seg+b1))->is_plus, *(c2_ptr->root_seg+b2+1), (*(c2_ptr->root_seg+b2+1))->is_plus) ||
+                !is_natural_join(g_ptr, *(c2_ptr->root_seg+b2), (*(c2_ptr->root_seg+b2))->is_plus, *(c1_ptr->root_seg+b1+1), (*(c1_ptr->root_seg+b1+1))->is_plus)
+            ) {
+                continue;
+            }
+
+            new_g_ptr = copy_genome(g_ptr);
+            seg_holder1 = yank_segments(c1_ptr, b1+1, c1_ptr->n_segs-1);  // B
+            seg_holder2 = yank_segments(c2_ptr, b2+1, c2_ptr->n_segs-1);  // D
+
+            // A D
+            delete_segs_from_chr(*(new_g_ptr->root_chr+c1_idx), b1+1, c1_ptr->n_segs-1);
+            insert_segs_into_chr(*(new_g_ptr->root_chr+c1_idx), seg_holder2, b1+1);
+
+            // C B
+            if (c2_is_inverted) {
+                invert_segs_in_chr(*(new_g_ptr->root_chr+c2_idx), 0, c2_ptr->n_segs-1);
+            }
+            delete_segs_from_chr(*(new_g_ptr->root_chr+c2_idx), b2+1, c2_ptr->n_segs-1);
+            insert_segs_into_chr(*(new_g_ptr->root_chr+c2_idx), seg_holder1, b2+1);
+
+            simplify_genome(new_g_ptr);
+            g_ptr_array_add(predecessors, new_g_ptr);
+            delete_chromosome(seg_holder1);
+            delete_chromosome(seg_holder2);
+        }
+        }
+
+        delete_chromosome(c2_ptr);
+    }
+    }
+    }
+
+    return;
+}
+
+void enum_pred_unbal_translocs(struct genome *g_ptr, GPtrArray *predecessors) {
+    int c_idx, b1;
+    struct chromosome *c_ptr, *lost_segs1, *lost_segs2, *new_c_ptr;
+    struct genome *new_g_ptr;
+
+    /*
+        A chromosome A B with a junction between A and B is the retained
+        product of a balanced translocation between A Q and P B, where Q and P
+        are the reference segments beyond A and in front of B.
+    */
+    for (c_idx=0; c_idx<g_ptr->n_chrs; c_idx++) {
+        c_ptr = *(g_ptr->root_chr+c_idx);
+        for (b1=0; b1<c_ptr->n_segs-1; b1++) {
+            if (is_natural_join(g_ptr, *(c_ptr->root_seg+b1), (*(c_ptr->root_seg+b1))->is_plus, *(c_ptr->root_seg+b1+1), (*(c_ptr->root_seg+b1+1))->is_plus)) {
+                continue;
+            }
+            lost_segs1 = get_reference_flank(g_ptr, *(c_ptr->root_seg+b1), 1);
+            lost_segs2 = get_reference_flank(g_ptr, *(c_ptr->root_seg+b1+1), 0);
+            if (lost_segs1 == NULL || lost_segs2 == NULL) {
+                if (lost_segs1 != NULL) { delete_chromosome(lost_segs1); }
+                if (lost_segs2 != NULL) { delete_chromosome(lost_segs2); }
+                continue;
+            }
+
+            new_g_ptr = copy_genome(g_ptr);
+
+            // P B
+            new_c_ptr = yank_segments(c_ptr, b1+1, c_ptr->n_segs-1);
+            insert_segs_into_chr(new_c_ptr, lost_segs2, 0);
+            add_chromosome_to_genome(new_g_ptr, new_c_ptr);
+
+            // A Q
+            delete_segs_from_chr(*(new_g_ptr->root_chr+c_idx), b1+1, c_ptr->n_segs-1);
+            insert_segs_into_chr(*(new_g_ptr->root_chr+c_idx), lost_segs1, b1+1);
+
+            simplify_genome(new_g_ptr);
+            g_ptr_array_add(predecessors, new_g_ptr);
+            delete_chromosome(lost_segs1);
+            delete_chromosome(lost_segs2);
+        }
+    }
+
+    return;
+}
+
+void enum_pred_wc_dups(struct genome *g_ptr, GPtrArray *predecessors) {
+    int c1_idx, c2_idx;
+    struct genome *new_g_ptr;
+
+    for (c1_idx=0; c1_idx<g_ptr->n_chrs; c1_idx++) {
+        for (c2_idx=c1_idx+1; c2_idx<g_ptr->n_chrs; c2_idx++) {
+            if (!chromosomes_are_identical(*(g_ptr->root_chr+c1_idx), *(g_ptr->root_chr+c2_idx))) {
+                continue;
+            }
+            new_g_ptr = copy_genome(g_ptr);
+            lose_chromosome_in_genome(new_g_ptr, c2_idx);
+            simplify_genome(new_g_ptr);
+            g_ptr_array_add(predecessors, new_g_ptr);
+        }
+    }
+
+    return;
+}
+
+void enum_pred_wc_dels(struct genome *g_ptr, GPtrArray *predecessors) {
+    int first, last, is_maternal;
+    struct genome *new_g_ptr;
+
+    // Add back an intact copy of any WT chromosome allele
+    for (first=0; first<g_ptr->n_genome_segs; first=last+1) {
+        last = first;
+        while (
+            last < g_ptr->n_genome_segs-1 &&
+            *((*(g_ptr->genome_segs+last+1))->seg_indexes+0) == *((*(g_ptr->genome_segs+first))->seg_indexes+0)
+        ) {
+            last++;
+        }
+
+        for (is_maternal=0; is_maternal<=(IS_DIPLOID ? 1 : 0); is_maternal++) {
+            new_g_ptr = copy_genome(g_ptr);
+            add_chromosome_to_genome(new_g_ptr, get_reference_segs(g_ptr, first, last, 1, is_maternal));
+            simplify_genome(new_g_ptr);
+            g_ptr_array_add(predecessors, new_g_ptr);
+        }
+    }
+
+    return;
+}
+
+void enum_pred_wg_dups(struct genome *g_ptr, GPtrArray *predecessors) {
+    if (g_ptr->n_chrs == 0 || g_ptr->n_chrs % 2 != 0) {
+        return;
+    }
+
+    int c1_idx, c2_idx;
+    int *copy_of = malloc(g_ptr->n_chrs * sizeof(int));  // Index of the chromosome a chromosome was paired with
+    if (copy_of == NULL) {
+        fprintf(stderr, "\nFailed to malloc copy_of in enum_pred_wg_dups(). Exiting.\n");
+        exit(1);
+    }
+    for (c1_idx=0; c1_idx<g_ptr->n_chrs; c1_idx++) {
+        *(copy_of+c1_idx) = -1;
+    }
+
+    // Every chromosome must have an identical partner
+    for (c1_idx=0; c1_idx<g_ptr->n_chrs; c1_idx++) {
+        if (*(copy_of+c1_idx) != -1) {
+            continue;
+        }
+        for (c2_idx=c1_idx+1; c2_idx<g_ptr->n_chrs; c2_idx++) {
+            if (*(copy_of+c2_idx) == -1 && chromosomes_are_identical(*(g_ptr->root_chr+c1_idx), *(g_ptr->root_chr+c2_idx))) {
+                *(copy_of+c1_idx) = c2_idx;
+                *(copy_of+c2_idx) = c1_idx;
+                break;
+            }
+        }
+        if (*(copy_of+c1_idx) == -1) {
+            free(copy_of);
+            return;
+        }
+    }
+
+    struct genome *new_g_ptr = copy_genome(g_ptr);
+    for (c1_idx=g_ptr->n_chrs-1; c1_idx>=0; c1_idx--) {
+        if (*(copy_of+c1_idx) < c1_idx) {
+            lose_chromosome_in_genome(new_g_ptr, c1_idx);
+        }
+    }
+    simplify_genome(new_g_ptr);
+    g_ptr_array_add(predecessors, new_g_ptr);
+
+    free(copy_of);
+    return;
+}
+/*
+    End predecessor enumeration functions
+*/
@@ -0,0 +1,280 @@
+/*
+    Progress reporting for long runs.
+
+    The engine counts every derivative genome it visits, and keeps track of
+    how many of the children of each genome on the current path from the WT
+    genome have been completed, which gives the fraction of the whole
+    enumeration done so far. A report is written to stderr every --progress
+    seconds, and the metrics are written to the --metrics-file in the
+    Prometheus text format, by writing a temporary file and renaming it over
+    the metrics file, so that readers never see a partial file. SIGUSR1
+    requests a report at the next visited genome, since writing it from the
+    signal handler would not be safe.
+*/
+
+extern int MAX_DEPTH_NONDUP;
+extern long N_OUTPUT_BYTES;
+extern struct progress *progress;
+
+struct progress {
+    gint64 start_time;   /* Microseconds, as returned by g_get_monotonic_time() */
+    gint64 interval;     /* Microseconds between reports, 0 for reports on SIGUSR1 only */
+    gint64 last_report_time;
+    char *metrics_path;  /* NULL if no metrics file */
+    char *metrics_tmp_path;
+    int max_depth;
+    long n_visited;
+    long n_visited_at_last_report;
+    long n_expanded;
+    long *n_visited_by_depth;  /* max_depth + 1 of them */
+    long *n_children;          /* Children of the genome at each depth of the current path, 0 below the path */
+    long *n_children_done;
+    int is_finished;
+};
+
+volatile sig_atomic_t PROGRESS_REQUESTED = 0;
+
+/*
+    Function prototypes
+*/
+struct progress* create_progress(double interval_seconds, char *metrics_path, int max_depth);
+void delete_progress(struct progress *p_ptr);
+void request_progress_report(int signum);
+void start_progress_children(struct progress *p_ptr, int depth, long n_children);
+void finish_progress_child(struct progress *p_ptr, int depth);
+void end_progress_children(struct progress *p_ptr, int depth);
+int count_progress_visit(struct progress *p_ptr, int depth, int is_new);
+double get_fraction_done(struct progress *p_ptr);
+long get_resident_memory();
+void report_progress(struct progress *p_ptr, long n_seen, long n_seen_bytes);
+void finish_progress(struct progress *p_ptr, long n_seen, long n_seen_bytes);
+void write_progress_metrics(struct progress *p_ptr, long n_seen, long n_seen_bytes, double rate, double fraction_done, long resident_memory);
+/*
+    End function prototypes
+*/
+
+
+/*
+    Functions for progress reporting
+*/
+struct progress* create_progress(double interval_seconds, char *metrics_path, int max_depth) {
+    struct progress *p_ptr = malloc(sizeof(struct progress));
+    if (p_ptr == NULL) {
+        fprintf(stderr, "\nCreation of progress failed. Exiting.\n");
+        exit(1);
+    }
+    p_ptr->start_time = p_ptr->last_report_time = g_get_monotonic_time();
+    p_ptr->interval = (gint64)(interval_seconds * 1e6);
+    p_ptr->metrics_path = metrics_path;
+    p_ptr->metrics_tmp_path = (metrics_path == NULL ? NULL : g_strdup_printf("%s.tmp", metrics_path));
+    p_ptr->max_depth = max_depth;
+    p_ptr->n_visited = p_ptr->n_visited_at_last_report = p_ptr->n_expanded = 0;
+    p_ptr->is_finished = 0;
+
+    p_ptr->n_visited_by_depth = calloc(max_depth + 1, sizeof(long));
+    p_ptr->n_children = calloc(max_depth + 1, sizeof(long));
+    p_ptr->n_children_done = calloc(max_depth + 1, sizeof(long));
+    if (p_ptr->n_visited_by_depth == NULL || p_ptr->n_children == NULL || p_ptr->n_children_done == NULL) {
+        fprintf(stderr, "\nCreation of progress counts failed. Exiting.\n");
+        exit(1);
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_progress_report;
+    action.sa_flags = SA_RESTART;  // Output is not interrupted
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, NULL);
+
+    return(p_ptr);
+}
+
+void delete_progress(struct progress *p_ptr) {
+    signal(SIGUSR1, SIG_DFL);
+    g_free(p_ptr->metrics_tmp_path);
+    free(p_ptr->n_visited_by_depth);
+    free(p_ptr->n_children);
+    free(p_ptr->n_children_done);
+    free(p_ptr);
+    return;
+}
+
+void request_progress_report(int signum) {
+    (void)signum;
+    PROGRESS_REQUESTED = 1;
+}
+
+/* The genome at depth is about to go through its n_children children */
+void start_progress_children(struct progress *p_ptr, int depth, long n_children) {
+    if (depth <= p_ptr->max_depth) {
+        *(p_ptr->n_children+depth) = n_children;
+        *(p_ptr->n_children_done+depth) = 0;
+    }
+    return;
+}
+
+void finish_progress_child(struct progress *p_ptr, int depth) {
+    if (depth <= p_ptr->max_depth) {
+        *(p_ptr->n_children_done+depth) += 1;
+    }
+    return;
+}
+
+void end_progress_children(struct progress *p_ptr, int depth) {
+    if (depth <= p_ptr->max_depth) {
+        *(p_ptr->n_children+depth) = 0;
+    }
+    return;
+}
+
+/*
+    Counts a visited genome at depth, is_new if it is expanded. Returns
+    whether a report is due, which the caller makes with report_progress(),
+    since only it knows the size of its seen genomes. The clock is only read
+    every 256 genomes.
+*/
+int count_progress_visit(struct progress *p_ptr, int depth, int is_new) {
+    p_ptr->n_visited++;
+    p_ptr->n_expanded += is_new;
+    if (depth <= p_ptr->max_depth) {
+        *(p_ptr->n_visited_by_depth+depth) += 1;
+    }
+
+    if (PROGRESS_REQUESTED) {
+        return(1);
+    }
+    if (p_ptr->interval > 0 && (p_ptr->n_visited & 255) == 0) {
+        return(g_get_monotonic_time() - p_ptr->last_report_time >= p_ptr->interval);
+    }
+    return(0);
+}
+
+/*
+    Fraction of the enumeration done, from the position of the current path
+    in the tree. Each of the n children of the genome at some depth stands
+    for 1/n of the share of the genome, the completed children for all of it
+    and the child in progress for the fraction done of its own children.
+*/
+double get_fraction_done(struct progress *p_ptr) {
+    double fraction = 0, share = 1;
+    int depth;
+    if (p_ptr->is_finished) {
+        return(1);
+    }
+    for (depth=0; depth<=p_ptr->max_depth && *(p_ptr->n_children+depth) > 0; depth++) {
+        fraction += share * *(p_ptr->n_children_done+depth) / *(p_ptr->n_children+depth);
+        share /= *(p_ptr->n_children+depth);
+    }
+    return(fraction);
+}
+
+/* Resident memory of the process in bytes, -1 if unknown */
+long get_resident_memory() {
+    long n_pages, n_resident_pages;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL) {
+        return(-1);
+    }
+    if (fscanf(statm, "%ld %ld", &n_pages, &n_resident_pages) != 2) {
+        n_resident_pages = -1;
+    }
+    fclose(statm);
+    return(n_resident_pages < 0 ? -1 : n_resident_pages * sysconf(_SC_PAGESIZE));
+}
+
+/*
+    Writes a report to stderr and to the metrics file. n_seen is the number of
+    seen genomes, -1 if there is no table of seen genomes, and n_seen_bytes
+    their estimated size, -1 if not known.
+*/
+void report_progress(struct progress *p_ptr, long n_seen, long n_seen_bytes) {
+    gint64 now = g_get_monotonic_time();
+    double elapsed = (now - p_ptr->start_time) / 1e6;
+    double since_last_report = (now - p_ptr->last_report_time) / 1e6;
+    double rate = (since_last_report > 0 ? (p_ptr->n_visited - p_ptr->n_visited_at_last_report) / since_last_report : 0);
+    double fraction_done = get_fraction_done(p_ptr);
+    long resident_memory = get_resident_memory();
+    int depth;
+
+    PROGRESS_REQUESTED = 0;
+    p_ptr->last_report_time = now;
+    p_ptr->n_visited_at_last_report = p_ptr->n_visited;
+
+    fprintf(stderr, "Progress after %.0f s: %ld genomes visited (%.0f/s), %ld expanded, by depth", elapsed, p_ptr->n_visited, rate, p_ptr->n_expanded);
+    for (depth=1; depth<=p_ptr->max_depth; depth++) {
+        fprintf(stderr, " %d:%ld", depth, *(p_ptr->n_visited_by_depth+depth));
+    }
+    if (n_seen >= 0) {
+        fprintf(stderr, ", %ld seen genomes", n_seen);
+        if (n_seen_bytes >= 0) {
+            fprintf(stderr, " (%ld MB)", n_seen_bytes >> 20);
+        }
+    }
+    if (resident_memory >= 0) {
+        fprintf(stderr, ", %ld MB resident", resident_memory >> 20);
+    }
+    fprintf(stderr, ", %ld MB output, %.2f%% done", N_OUTPUT_BYTES >> 20, 100 * fraction_done);
+    if (fraction_done > 0) {
+        fprintf(stderr, ", about %.0f s left", elapsed * (1 - fraction_done) / fraction_done);
+    }
+    fprintf(stderr, ".\n");
+
+    if (p_ptr->metrics_path != NULL) {
+        write_progress_metrics(p_ptr, n_seen, n_seen_bytes, rate, fraction_done, resident_memory);
+    }
+    return;
+}
+
+/* Final report, only written if reports were asked for */
+void finish_progress(struct progress *p_ptr, long n_seen, long n_seen_bytes) {
+    p_ptr->is_finished = 1;
+    if (p_ptr->interval > 0 || p_ptr->metrics_path != NULL) {
+        report_progress(p_ptr, n_seen, n_seen_bytes);
+    }
+    return;
+}
+
+void write_progress_metrics(struct progress *p_ptr, long n_seen, long n_seen_bytes, double rate, double fraction_done, long resident_memory) {
+    double elapsed = (p_ptr->last_report_time - p_ptr->start_time) / 1e6;
+    int depth;
+
+    FILE *metrics = fopen(p_ptr->metrics_tmp_path, "w");
+    if (metrics == NULL) {
+        fprintf(stderr, "Could not write metrics file %s, continuing.\n", p_ptr->metrics_tmp_path);
+        return;
+    }
+
+    void write_metric(char *name, char *type, char *help, double value) {
+        fprintf(metrics, "# HELP rg_enumerator_%s %s\n# TYPE rg_enumerator_%s %s\nrg_enumerator_%s %.17g\n", name, help, name, type, name, value);
+    }
+    write_metric("elapsed_seconds", "gauge", "Time since the start of the enumeration.", elapsed);
+    write_metric("genomes_visited_total", "counter", "Derivative genomes visited.", p_ptr->n_visited);
+    write_metric("genomes_expanded_total", "counter", "Derivative genomes visited for the first time, or with fewer events than before.", p_ptr->n_expanded);
+    write_metric("genomes_per_second", "gauge", "Derivative genomes visited per second since the previous report.", rate);
+    fprintf(metrics, "# HELP rg_enumerator_genomes_visited_by_depth_total Derivative genomes visited by number of events.\n# TYPE rg_enumerator_genomes_visited_by_depth_total counter\n");
+    for (depth=1; depth<=p_ptr->max_depth; depth++) {
+        fprintf(metrics, "rg_enumerator_genomes_visited_by_depth_total{depth=\"%d\"} %ld\n", depth, *(p_ptr->n_visited_by_depth+depth));
+    }
+    if (n_seen >= 0) {
+        write_metric("seen_genomes", "gauge", "Genomes in the table of seen genomes.", n_seen);
+    }
+    if (n_seen_bytes >= 0) {
+        write_metric("seen_genome_bytes", "gauge", "Estimated size of the table of seen genomes.", n_seen_bytes);
+    }
+    if (resident_memory >= 0) {
+        write_metric("resident_memory_bytes", "gauge", "Resident memory of the process.", resident_memory);
+    }
+    write_metric("output_bytes_total", "counter", "Bytes of output written.", N_OUTPUT_BYTES);
+    write_metric("fraction_done", "gauge", "Fraction of the enumeration done, from the children of the genomes on the current path.", fraction_done);
+    if (fraction_done > 0) {
+        write_metric("eta_seconds", "gauge", "Estimated time left, assuming a constant rate.", elapsed * (1 - fraction_done) / fraction_done);
+    }
+
+    if (fclose(metrics) != 0 || rename(p_ptr->metrics_tmp_path, p_ptr->metrics_path) != 0) {
+        fprintf(stderr, "Could not write metrics file %s, continuing.\n", p_ptr->metrics_path);
+    }
+    return;
+}
+/*
+    End functions for progress reporting
+*/
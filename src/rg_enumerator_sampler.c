@@ -0,0 +1,405 @@
+/*
+    Functions for sampling random histories (Monte Carlo).
+
+    Beyond the depths the exhaustive enumeration can reach, histories are
+    sampled as random walks from the wild type genome. At each step a
+    rearrangement type is drawn with probability proportional to its rate,
+    among the types that can follow the current genome (see
+    rg_type_is_enumerated()) and have at least one event, and then one of its
+    events is drawn uniformly, using the regular enumerators as the move set.
+    A walk ends after MAX_DEPTH_NONDUP events, or earlier if no event is
+    possible. Only the genome of the drawn event is built: the other events
+    are counted with count_events_of_type(), which remembers the number of
+    events of each block of chromosomes across samples. Neither counting the
+    events of a new block nor materialising the drawn event builds the
+    genomes of the other events, see skip_events(), and the intermediate
+    genomes of a walk are never canonicalised, so a step costs little more
+    than building one child and the chromosome keys of its blocks.
+
+    Sample i only depends on the seed and i, so the output is identical for
+    any number of threads. Samples are drawn in windows of
+    SAMPLE_WINDOW_SIZE, on sampler->pool if more than one thread is used, and
+    each window is printed in order and freed before the next one is drawn.
+    Memory is therefore bounded: the interned chromosomes are freed with the
+    genomes holding them, the block counts are cleared between windows once
+    there are more than MAX_KNOWN_BLOCKS of them, and the rarest patterns are
+    dropped from the pattern counts once more than MAX_SAMPLED_PATTERNS
+    distinct patterns have been seen.
+*/
+
+extern int N_CHRS, IS_DIPLOID, MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
+extern struct progress *progress;
+
+#define SAMPLE_WINDOW_SIZE 1024
+#define MAX_KNOWN_BLOCKS (1 << 20)
+#define MAX_SAMPLED_PATTERNS (1 << 20)
+
+struct sample {
+    long idx;
+    struct genome *g_ptr;
+    GString *unique_genome_string;
+    GString *cn_string;
+    GString *rg_string;
+    struct sampler *s_ptr;
+};
+struct sampler {
+    double rates[N_RG_TYPES];  /* Relative rate of each rearrangement type */
+    guint32 seed;
+    struct sample *window;
+    int n_pending;  /* Number of samples of the window still being drawn on pool */
+    GMutex lock;
+    GCond all_sampled;
+    GThreadPool *pool;  /* NULL if single-threaded */
+    struct block_counts *known_blocks;
+    GHashTable *pattern_counts;  /* Number of samples of each "<cn_string> <rg_string>" */
+    int min_pattern_count;       /* Patterns with at most this many samples have been dropped */
+    long n_dropped;              /* Number of samples of the dropped patterns */
+};
+
+/*
+    Function prototypes
+*/
+struct sampler* create_sampler(guint32 seed, char *rates_string, int n_threads);
+void delete_sampler(struct sampler *s_ptr);
+void set_sampling_rates(struct sampler *s_ptr, char *rates_string);
+struct genome* sample_history(struct sampler *s_ptr, GRand *rand);
+void draw_sample(struct sample *smp_ptr);
+void draw_sample_in_pool(gpointer data, gpointer user_data);
+void count_pattern(struct sampler *s_ptr, char *cn_string, char *rg_string);
+void print_pattern_counts(struct sampler *s_ptr);
+long run_sampler(long n_samples, guint32 seed, char *rates_string, int n_threads);
+/*
+    End function prototypes
+*/
+
+
+struct sampler* create_sampler(guint32 seed, char *rates_string, int n_threads) {
+    struct sampler *s_ptr = malloc(sizeof(struct sampler));
+    if (s_ptr == NULL) {
+        fprintf(stderr, "\nCreation of sampler failed. Exiting.\n");
+        exit(1);
+    }
+
+    int i;
+    for (i=0; i<N_RG_TYPES; i++) {
+        s_ptr->rates[i] = 1.0;
+    }
+    if (rates_string != NULL) {
+        set_sampling_rates(s_ptr, rates_string);
+    }
+    s_ptr->seed = seed;
+
+    s_ptr->window = malloc(SAMPLE_WINDOW_SIZE * sizeof(struct sample));
+    if (s_ptr->window == NULL) {
+        fprintf(stderr, "\nCreation of sample window failed. Exiting.\n");
+        exit(1);
+    }
+    for (i=0; i<SAMPLE_WINDOW_SIZE; i++) {
+        (s_ptr->window+i)->g_ptr = NULL;
+        (s_ptr->window+i)->unique_genome_string = g_string_new(NULL);
+        (s_ptr->window+i)->cn_string = g_string_new(NULL);
+        (s_ptr->window+i)->rg_string = g_string_new(NULL);
+        (s_ptr->window+i)->s_ptr = s_ptr;
+    }
+    s_ptr->n_pending = 0;
+    g_mutex_init(&(s_ptr->lock));
+    g_cond_init(&(s_ptr->all_sampled));
+    s_ptr->pool = (n_threads > 1 ? g_thread_pool_new(draw_sample_in_pool, NULL, n_threads, 1, NULL) : NULL);
+    s_ptr->known_blocks = create_block_counts();
+
+    s_ptr->pattern_counts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free);
+    s_ptr->min_pattern_count = 0;
+    s_ptr->n_dropped = 0;
+
+    return(s_ptr);
+}
+
+void delete_sampler(struct sampler *s_ptr) {
+    int i;
+    if (s_ptr->pool != NULL) {
+        g_thread_pool_free(s_ptr->pool, 0, 1);
+    }
+    for (i=0; i<SAMPLE_WINDOW_SIZE; i++) {
+        g_string_free((s_ptr->window+i)->unique_genome_string, 1);
+        g_string_free((s_ptr->window+i)->cn_string, 1);
+        g_string_free((s_ptr->window+i)->rg_string, 1);
+    }
+    free(s_ptr->window);
+    delete_block_counts(s_ptr->known_blocks);
+    g_mutex_clear(&(s_ptr->lock));
+    g_cond_clear(&(s_ptr->all_sampled));
+    g_hash_table_destroy(s_ptr->pattern_counts);
+    free(s_ptr);
+    return;
+}
+
+/*
+    Parses rates given as a comma-separated list of <rg_type>=<rate>, using the
+    names of the detailed history, e.g. "del=2,td=0.5,wgd=0". Rearrangement
+    types not listed keep the rate 1.
+*/
+void set_sampling_rates(struct sampler *s_ptr, char *rates_string) {
+    gchar **fields = g_strsplit(rates_string, ",", 0);
+    char name[8];
+    double rate;
+    int i, rg;
+
+    for (i=0; *(fields+i) != NULL; i++) {
+        if (sscanf(*(fields+i), "%7[^=]=%lf", name, &rate) != 2 || rate < 0) {
+            fprintf(stderr, "Could not parse rate '%s', expected <rg_type>=<non-negative rate>. Exiting.\n", *(fields+i));
+            exit(1);
+        }
+        rg = txt_to_rg_type(name);
+        if (rg < 0) {
+            fprintf(stderr, "Unknown rearrangement type '%s' in rates. Exiting.\n", name);
+            exit(1);
+        }
+        s_ptr->rates[rg] = rate;
+    }
+    g_strfreev(fields);
+
+    return;
+}
+
+/*
+    Walks a random history from the wild type genome and returns its last
+    genome.
+*/
+struct genome* sample_history(struct sampler *s_ptr, GRand *rand) {
+    struct genome *g_ptr = create_genome(N_CHRS, IS_DIPLOID), *child_ptr;
+    GArray *events = g_array_new(0, 0, sizeof(struct rg_event));
+    struct rg_event *e_ptr;
+    double weights[N_RG_TYPES], total, x;
+    int rg, chosen_rg;
+    guint i, j;
+
+    while (g_ptr->depth < MAX_DEPTH_NONDUP) {
+        for (rg=0; rg<N_RG_TYPES; rg++) {
+            weights[rg] = (rg_type_is_enumerated(g_ptr, rg, g_ptr->dup_depth < MAX_DEPTH_DUP) ? s_ptr->rates[rg] : 0);
+        }
+
+        // Draw a rearrangement type, then one of its events. Types without
+        // events are excluded and the type is drawn again.
+        child_ptr = NULL;
+        while (child_ptr == NULL) {
+            total = 0;
+            for (rg=0; rg<N_RG_TYPES; rg++) {
+                total += weights[rg];
+            }
+            if (total <= 0) {
+                break;
+            }
+
+            x = g_rand_double_range(rand, 0, total);
+            chosen_rg = -1;
+            for (rg=0; rg<N_RG_TYPES; rg++) {
+                if (weights[rg] <= 0) {
+                    continue;
+                }
+                chosen_rg = rg;
+                if (x < weights[rg]) {
+                    break;
+                }
+                x -= weights[rg];
+            }
+
+            g_array_set_size(events, 0);
+            count_events_of_type(g_ptr, chosen_rg, events, s_ptr->known_blocks);
+            if (events->len == 0) {
+                weights[chosen_rg] = 0;
+                continue;
+            }
+
+            // Twins and counted events are separate events, their genomes are only built when drawn
+            i = g_rand_int_range(rand, 0, events->len);
+            e_ptr = &g_array_index(events, struct rg_event, i);
+            child_ptr = (e_ptr->g_ptr != NULL ? e_ptr->g_ptr : materialize_event(g_ptr, e_ptr));
+            for (j=0; j<events->len; j++) {
+                if (j != i && g_array_index(events, struct rg_event, j).g_ptr != NULL) {
+                    delete_genome(g_array_index(events, struct rg_event, j).g_ptr);
+                }
+            }
+        }
+
+        if (child_ptr == NULL) {
+            break;
+        }
+        delete_genome(g_ptr);
+        g_ptr = child_ptr;
+    }
+    g_array_free(events, 1);
+
+    return(g_ptr);
+}
+
+void draw_sample(struct sample *smp_ptr) {
+    guint32 seed[3] = {smp_ptr->s_ptr->seed, (guint32)smp_ptr->idx, (guint32)(smp_ptr->idx >> 32)};
+    GRand *rand = g_rand_new_with_seed_array(seed, 3);
+
+    smp_ptr->g_ptr = sample_history(smp_ptr->s_ptr, rand);
+    get_unique_genome_string(smp_ptr->g_ptr, smp_ptr->unique_genome_string);
+    get_rg_pattern(smp_ptr->g_ptr, smp_ptr->cn_string, smp_ptr->rg_string);
+
+    g_rand_free(rand);
+    return;
+}
+
+// Task function of sampler->pool
+void draw_sample_in_pool(gpointer data, gpointer user_data) {
+    struct sample *smp_ptr = (struct sample*)data;
+    struct sampler *s_ptr = smp_ptr->s_ptr;
+    (void)user_data;
+
+    draw_sample(smp_ptr);
+
+    g_mutex_lock(&(s_ptr->lock));
+    s_ptr->n_pending--;
+    if (s_ptr->n_pending == 0) {
+        g_cond_signal(&(s_ptr->all_sampled));
+    }
+    g_mutex_unlock(&(s_ptr->lock));
+    return;
+}
+
+/*
+    Counts a sample of the pattern. When the table is full, the patterns with
+    the fewest samples are dropped until it is at most half full, so the counts
+    reported are exact for the patterns that were never dropped and lower
+    bounds otherwise.
+*/
+void count_pattern(struct sampler *s_ptr, char *cn_string, char *rg_string) {
+    GString *key = g_string_new(NULL);
+    g_string_printf(key, "%s %s", cn_string, rg_string);
+
+    long *count_ptr = (long*)g_hash_table_lookup(s_ptr->pattern_counts, key->str);
+    if (count_ptr != NULL) {
+        (*count_ptr)++;
+        g_string_free(key, 1);
+        return;
+    }
+
+    GHashTableIter iter;
+    gpointer pattern, count;
+    if (g_hash_table_size(s_ptr->pattern_counts) >= MAX_SAMPLED_PATTERNS) {
+        while (g_hash_table_size(s_ptr->pattern_counts) > MAX_SAMPLED_PATTERNS / 2) {
+            s_ptr->min_pattern_count++;
+            g_hash_table_iter_init(&iter, s_ptr->pattern_counts);
+            while (g_hash_table_iter_next(&iter, &pattern, &count)) {
+                if (*(long*)count <= s_ptr->min_pattern_count) {
+                    s_ptr->n_dropped += *(long*)count;
+                    g_hash_table_iter_remove(&iter);
+                }
+            }
+        }
+    }
+
+    count_ptr = malloc(sizeof(long));
+    if (count_ptr == NULL) {
+        fprintf(stderr, "\nFailed to malloc pattern count. Exiting.\n");
+        exit(1);
+    }
+    *count_ptr = 1;
+    g_hash_table_insert(s_ptr->pattern_counts, g_string_free(key, 0), count_ptr);
+
+    return;
+}
+
+/*
+    Prints the pattern counts to stderr, most frequent pattern first.
+*/
+void print_pattern_counts(struct sampler *s_ptr) {
+    GPtrArray *patterns = g_ptr_array_new();
+    GHashTableIter iter;
+    gpointer pattern, count;
+    guint i;
+
+    g_hash_table_iter_init(&iter, s_ptr->pattern_counts);
+    while (g_hash_table_iter_next(&iter, &pattern, &count)) {
+        g_ptr_array_add(patterns, pattern);
+    }
+
+    int pattern_count_cmp(const void *a, const void *b) {
+        long count_a = *(long*)g_hash_table_lookup(s_ptr->pattern_counts, *(char**)a);
+        long count_b = *(long*)g_hash_table_lookup(s_ptr->pattern_counts, *(char**)b);
+        if (count_a != count_b) {
+            return(count_a > count_b ? -1 : 1);
+        }
+        return(strcmp(*(char**)a, *(char**)b));
+    }
+    g_ptr_array_sort(patterns, pattern_count_cmp);
+
+    fprintf(stderr, "Pattern frequencies (samples, cn_pattern, rg_pattern):\n");
+    for (i=0; i<patterns->len; i++) {
+        pattern = g_ptr_array_index(patterns, i);
+        fprintf(stderr, "%ld %s\n", *(long*)g_hash_table_lookup(s_ptr->pattern_counts, pattern), (char*)pattern);
+    }
+    if (s_ptr->n_dropped > 0) {
+        fprintf(stderr, "%ld samples of patterns sampled at most %d times are not counted above.\n", s_ptr->n_dropped, s_ptr->min_pattern_count);
+    }
+    g_ptr_array_free(patterns, 1);
+
+    return;
+}
+
+/*
+    Draws n_samples random histories, prints their last genomes in the usual
+    output format and the pattern frequencies at the end. Returns the number
+    of samples drawn.
+*/
+long run_sampler(long n_samples, guint32 seed, char *rates_string, int n_threads) {
+    struct sampler *s_ptr = create_sampler(seed, rates_string, n_threads);
+    struct sample *smp_ptr;
+    long first;
+    int i, n;
+
+    start_progress_children(progress, 0, n_samples);
+    for (first=0; first<n_samples; first+=SAMPLE_WINDOW_SIZE) {
+        n = (n_samples - first < SAMPLE_WINDOW_SIZE ? n_samples - first : SAMPLE_WINDOW_SIZE);
+        for (i=0; i<n; i++) {
+            (s_ptr->window+i)->idx = first + i;
+        }
+
+        if (s_ptr->pool == NULL) {
+            for (i=0; i<n; i++) {
+                draw_sample(s_ptr->window+i);
+            }
+        }
+        else {
+            g_mutex_lock(&(s_ptr->lock));
+            s_ptr->n_pending = n;
+            for (i=0; i<n; i++) {
+                g_thread_pool_push(s_ptr->pool, s_ptr->window+i, NULL);
+            }
+            while (s_ptr->n_pending > 0) {
+                g_cond_wait(&(s_ptr->all_sampled), &(s_ptr->lock));
+            }
+            g_mutex_unlock(&(s_ptr->lock));
+        }
+
+        for (i=0; i<n; i++) {
+            smp_ptr = s_ptr->window+i;
+            print_genome_with_pattern(smp_ptr->g_ptr, smp_ptr->cn_string->str, smp_ptr->rg_string->str, smp_ptr->unique_genome_string->str);
+            count_pattern(s_ptr, smp_ptr->cn_string->str, smp_ptr->rg_string->str);
+            finish_progress_child(progress, 0);
+            if (count_progress_visit(progress, smp_ptr->g_ptr->depth, 1)) {
+                report_progress(progress, -1, -1);
+            }
+            delete_genome(smp_ptr->g_ptr);
+            smp_ptr->g_ptr = NULL;
+        }
+
+        // No genome is left at this point. Block counts are keyed by chromosome IDs, which start from 0 again.
+        if (g_hash_table_size(s_ptr->known_blocks->counts) > MAX_KNOWN_BLOCKS) {
+            clear_chromosome_store();
+            g_hash_table_remove_all(s_ptr->known_blocks->counts);
+        }
+    }
+
+    print_pattern_counts(s_ptr);
+    delete_sampler(s_ptr);
+
+    return(n_samples);
+}
+/*
+    End functions for sampling random histories
+*/
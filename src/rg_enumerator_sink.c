@@ -0,0 +1,181 @@
+/*
+    Built-in sinks for the visited genomes, see struct genome_sink in
+    rg_enumerator.h. The print functions of rg_enumerator_classes.c pass every
+    visited genome to SINK. The text and binary sinks add the bytes they write
+    to N_OUTPUT_BYTES.
+*/
+
+extern struct genome_sink *SINK;
+extern long N_OUTPUT_BYTES;
+
+/*
+    Function prototypes
+*/
+struct genome_sink* create_sink(void (*visit)(struct genome_sink*, struct visited_genome*), void (*flush)(struct genome_sink*), void (*delete_data)(void*), void *data);
+void delete_sink(struct genome_sink *sink);
+void flush_file_sink(struct genome_sink *sink);
+struct genome_sink* create_text_sink(FILE *out);
+void visit_text_sink(struct genome_sink *sink, struct visited_genome *v_ptr);
+struct genome_sink* create_binary_sink(FILE *out);
+void visit_binary_sink(struct genome_sink *sink, struct visited_genome *v_ptr);
+void write_binary_string(FILE *out, char *string);
+struct genome_sink* create_count_sink(int max_depth);
+void visit_count_sink(struct genome_sink *sink, struct visited_genome *v_ptr);
+void delete_genome_counts(void *data);
+struct genome_sink* create_null_sink();
+void visit_null_sink(struct genome_sink *sink, struct visited_genome *v_ptr);
+/*
+    End function prototypes
+*/
+
+
+/*
+    Functions for sinks
+*/
+struct genome_sink* create_sink(void (*visit)(struct genome_sink*, struct visited_genome*), void (*flush)(struct genome_sink*), void (*delete_data)(void*), void *data) {
+    struct genome_sink *sink = malloc(sizeof(struct genome_sink));
+    if (sink == NULL) {
+        fprintf(stderr, "\nCreation of sink failed. Exiting.\n");
+        exit(1);
+    }
+    sink->visit = visit;
+    sink->flush = flush;
+    sink->delete_data = delete_data;
+    sink->data = data;
+    return(sink);
+}
+
+void delete_sink(struct genome_sink *sink) {
+    if (sink->delete_data != NULL) {
+        sink->delete_data(sink->data);
+    }
+    free(sink);
+    return;
+}
+
+void flush_file_sink(struct genome_sink *sink) {
+    fflush((FILE*)sink->data);
+    return;
+}
+
+/* The usual output, see the README */
+struct genome_sink* create_text_sink(FILE *out) {
+    return(create_sink(visit_text_sink, flush_file_sink, NULL, out));
+}
+
+void visit_text_sink(struct genome_sink *sink, struct visited_genome *v_ptr) {
+    FILE *out = (FILE*)sink->data;
+    int i;
+
+    // Print out current detailed history
+    for (i=0; i<v_ptr->depth; i++) {
+        N_OUTPUT_BYTES += fprintf(
+            out,
+            "%s%d%s",
+            rg_type_to_txt(*(v_ptr->history+i)),
+            *(v_ptr->history_idx+i),
+            (i == v_ptr->depth - 1 ? " " : "-")
+        );
+    }
+
+    // Print out current history
+    for (i=0; i<v_ptr->depth; i++) {
+        N_OUTPUT_BYTES += fprintf(
+            out,
+            "%s%s",
+            rg_type_to_txt(*(v_ptr->history+i)),
+            (i == v_ptr->depth - 1 ? " " : "-")
+        );
+    }
+
+    // Print out the rearrangement pattern and the unique somatic genome string
+    N_OUTPUT_BYTES += fprintf(out, "%s %s %s\n", v_ptr->cn_string, v_ptr->rg_string, v_ptr->genome_string);
+
+    return;
+}
+
+/* See rg_enumerator.h for the format */
+struct genome_sink* create_binary_sink(FILE *out) {
+    return(create_sink(visit_binary_sink, flush_file_sink, NULL, out));
+}
+
+void visit_binary_sink(struct genome_sink *sink, struct visited_genome *v_ptr) {
+    FILE *out = (FILE*)sink->data;
+    gint32 header[3] = {v_ptr->depth, v_ptr->dup_depth, v_ptr->is_seen};
+    gint32 event;
+    int i;
+
+    fwrite(header, sizeof(gint32), 3, out);
+    for (i=0; i<v_ptr->depth; i++) {
+        event = *(v_ptr->history+i);
+        fwrite(&event, sizeof(gint32), 1, out);
+    }
+    for (i=0; i<v_ptr->depth; i++) {
+        event = *(v_ptr->history_idx+i);
+        fwrite(&event, sizeof(gint32), 1, out);
+    }
+    N_OUTPUT_BYTES += (3 + 2 * v_ptr->depth) * sizeof(gint32);
+
+    write_binary_string(out, v_ptr->cn_string);
+    write_binary_string(out, v_ptr->rg_string);
+    write_binary_string(out, v_ptr->genome_string);
+
+    return;
+}
+
+void write_binary_string(FILE *out, char *string) {
+    gint32 len = strlen(string);
+    fwrite(&len, sizeof(gint32), 1, out);
+    fwrite(string, 1, len, out);
+    N_OUTPUT_BYTES += sizeof(gint32) + len;
+    return;
+}
+
+/* Only counts the visits, in the struct genome_counts of sink->data */
+struct genome_sink* create_count_sink(int max_depth) {
+    struct genome_counts *counts = malloc(sizeof(struct genome_counts));
+    if (counts == NULL) {
+        fprintf(stderr, "\nCreation of genome counts failed. Exiting.\n");
+        exit(1);
+    }
+    counts->n_visited = 0;
+    counts->n_seen = 0;
+    counts->max_depth = max_depth;
+    counts->n_by_depth = calloc(max_depth + 1, sizeof(long));
+    if (counts->n_by_depth == NULL) {
+        fprintf(stderr, "\nCreation of genome counts by depth failed. Exiting.\n");
+        exit(1);
+    }
+    return(create_sink(visit_count_sink, NULL, delete_genome_counts, counts));
+}
+
+void visit_count_sink(struct genome_sink *sink, struct visited_genome *v_ptr) {
+    struct genome_counts *counts = (struct genome_counts*)sink->data;
+    counts->n_visited++;
+    counts->n_seen += v_ptr->is_seen;
+    if (v_ptr->depth <= counts->max_depth) {
+        *(counts->n_by_depth+v_ptr->depth) += 1;
+    }
+    return;
+}
+
+void delete_genome_counts(void *data) {
+    struct genome_counts *counts = (struct genome_counts*)data;
+    free(counts->n_by_depth);
+    free(counts);
+    return;
+}
+
+/* Discards the genomes, e.g. to time the enumeration alone */
+struct genome_sink* create_null_sink() {
+    return(create_sink(visit_null_sink, NULL, NULL, NULL));
+}
+
+void visit_null_sink(struct genome_sink *sink, struct visited_genome *v_ptr) {
+    (void)sink;
+    (void)v_ptr;
+    return;
+}
+/*
+    End functions for sinks
+*/
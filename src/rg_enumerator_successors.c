@@ -0,0 +1,224 @@
+/*
+    One step of the enumeration for external search algorithms, see
+    get_successors(). All the children of a batch of genomes are enumerated
+    as in bridge(), for the rearrangement types allowed after each genome
+    (duplicative ones only below MAX_DEPTH_DUP), and their canonical genome
+    strings are computed. Children with the same genome string are returned
+    once, with the fewest events, so twins and children shared by several
+    parents are dropped.
+
+    The results go to a successor set, which is reused from call to call: the
+    successors are one array, their genome strings one buffer, and duplicates
+    are found with an open-addressing table of successor indexes, so once the
+    buffers have grown nothing is allocated per child for the results. The
+    child genomes themselves are still built by the enumerators. Calls on
+    different successor sets can run on different threads, since the
+    enumerators only share the chromosome store, which is locked.
+*/
+
+extern int MAX_DEPTH_DUP;
+
+struct successor_set {
+    GArray *successors;  /* struct successor of the last call */
+    GString *keys;       /* Their genome strings, each terminated by a NUL */
+    guint64 *hashes;     /* Hash of the genome string of each successor */
+    int n_hashes;
+    int *slots;          /* Index + 1 of the successor in each slot, 0 if empty */
+    int n_slots;         /* A power of two, at least twice the number of successors */
+    GArray *events;
+    GString *key;
+};
+
+/*
+    Function prototypes
+*/
+struct successor_set* create_successor_set();
+void delete_successor_set(struct successor_set *ss_ptr);
+void clear_successor_set(struct successor_set *ss_ptr);
+struct successor* get_successors(struct successor_set *ss_ptr, struct genome **genomes, int n_genomes, int *n_successors);
+void add_successor(struct successor_set *ss_ptr, int parent_idx, struct rg_event *e_ptr);
+int* find_successor_slot(struct successor_set *ss_ptr, char *key, guint64 hash);
+void grow_successor_slots(struct successor_set *ss_ptr);
+/*
+    End function prototypes
+*/
+
+
+/*
+    Functions for successor sets
+*/
+struct successor_set* create_successor_set() {
+    struct successor_set *ss_ptr = malloc(sizeof(struct successor_set));
+    if (ss_ptr == NULL) {
+        fprintf(stderr, "\nCreation of successor set failed. Exiting.\n");
+        exit(1);
+    }
+    ss_ptr->successors = g_array_new(0, 0, sizeof(struct successor));
+    ss_ptr->keys = g_string_new(NULL);
+    ss_ptr->n_hashes = 256;
+    ss_ptr->hashes = malloc(ss_ptr->n_hashes * sizeof(guint64));
+    ss_ptr->n_slots = 2 * ss_ptr->n_hashes;
+    ss_ptr->slots = calloc(ss_ptr->n_slots, sizeof(int));
+    if (ss_ptr->hashes == NULL || ss_ptr->slots == NULL) {
+        fprintf(stderr, "\nCreation of successor slots failed. Exiting.\n");
+        exit(1);
+    }
+    ss_ptr->events = g_array_new(0, 0, sizeof(struct rg_event));
+    ss_ptr->key = g_string_new(NULL);
+    return(ss_ptr);
+}
+
+void delete_successor_set(struct successor_set *ss_ptr) {
+    clear_successor_set(ss_ptr);
+    g_array_free(ss_ptr->successors, 1);
+    g_string_free(ss_ptr->keys, 1);
+    free(ss_ptr->hashes);
+    free(ss_ptr->slots);
+    g_array_free(ss_ptr->events, 1);
+    g_string_free(ss_ptr->key, 1);
+    free(ss_ptr);
+    return;
+}
+
+// Deletes the genomes of the successors not taken over by the caller
+void clear_successor_set(struct successor_set *ss_ptr) {
+    guint i;
+    for (i=0; i<ss_ptr->successors->len; i++) {
+        if (g_array_index(ss_ptr->successors, struct successor, i).g_ptr != NULL) {
+            delete_genome(g_array_index(ss_ptr->successors, struct successor, i).g_ptr);
+        }
+    }
+    g_array_set_size(ss_ptr->successors, 0);
+    g_string_truncate(ss_ptr->keys, 0);
+    memset(ss_ptr->slots, 0, ss_ptr->n_slots * sizeof(int));
+    return;
+}
+
+/*
+    Returns the distinct children of genomes[0..n_genomes-1] and sets
+    *n_successors to their number. The array, and the genomes of the
+    successors, belong to ss_ptr until its next use. Set the g_ptr of a
+    successor to NULL to keep its genome, which must then be deleted with
+    delete_genome(). The genomes passed are not changed.
+*/
+struct successor* get_successors(struct successor_set *ss_ptr, struct genome **genomes, int n_genomes, int *n_successors) {
+    struct genome *g_ptr;
+    struct rg_event *e_ptr;
+    int g_idx;
+    guint i;
+
+    clear_successor_set(ss_ptr);
+    for (g_idx=0; g_idx<n_genomes; g_idx++) {
+        g_ptr = *(genomes+g_idx);
+        enum_events(g_ptr, ss_ptr->events, 1, g_ptr->dup_depth < MAX_DEPTH_DUP);
+        for (i=0; i<ss_ptr->events->len; i++) {
+            e_ptr = &g_array_index(ss_ptr->events, struct rg_event, i);
+            if (e_ptr->g_ptr != NULL) {  // Twins have the genome of an earlier event
+                add_successor(ss_ptr, g_idx, e_ptr);
+            }
+        }
+        g_array_set_size(ss_ptr->events, 0);
+    }
+
+    // The keys buffer does not move any more
+    struct successor *s_ptr;
+    for (i=0; i<ss_ptr->successors->len; i++) {
+        s_ptr = &g_array_index(ss_ptr->successors, struct successor, i);
+        s_ptr->genome_string = ss_ptr->keys->str + s_ptr->key_offset;
+    }
+
+    *n_successors = ss_ptr->successors->len;
+    return((struct successor*)ss_ptr->successors->data);
+}
+
+/*
+    Adds the child of event *e_ptr, which takes over its genome, unless a
+    successor with the same genome string and at most as many events is
+    already in the set. A child with fewer events replaces the successor.
+*/
+void add_successor(struct successor_set *ss_ptr, int parent_idx, struct rg_event *e_ptr) {
+    struct genome *g_ptr = e_ptr->g_ptr;
+    struct successor *s_ptr;
+    guint64 hash;
+    int *slot;
+
+    // Sleep sets only hold for the search of bridge(), see update_sleep_set()
+    memset(g_ptr->sleep_set, 0, sizeof(g_ptr->sleep_set));
+    get_unique_genome_string(g_ptr, ss_ptr->key);
+    hash = hash_genome_string(ss_ptr->key->str);
+    slot = find_successor_slot(ss_ptr, ss_ptr->key->str, hash);
+
+    if (*slot > 0) {
+        s_ptr = &g_array_index(ss_ptr->successors, struct successor, *slot - 1);
+        if (s_ptr->depth <= g_ptr->depth && s_ptr->dup_depth <= g_ptr->dup_depth) {
+            delete_genome(g_ptr);
+            return;
+        }
+        delete_genome(s_ptr->g_ptr);
+    }
+    else {
+        if ((int)ss_ptr->successors->len == ss_ptr->n_hashes) {
+            grow_successor_slots(ss_ptr);
+            slot = find_successor_slot(ss_ptr, ss_ptr->key->str, hash);
+        }
+        g_array_set_size(ss_ptr->successors, ss_ptr->successors->len + 1);
+        *slot = ss_ptr->successors->len;
+        *(ss_ptr->hashes + *slot - 1) = hash;
+
+        s_ptr = &g_array_index(ss_ptr->successors, struct successor, *slot - 1);
+        s_ptr->key_offset = ss_ptr->keys->len;
+        g_string_append_len(ss_ptr->keys, ss_ptr->key->str, ss_ptr->key->len + 1);
+    }
+
+    s_ptr->parent_idx = parent_idx;
+    s_ptr->rg = e_ptr->rg;
+    s_ptr->hist_idx = e_ptr->hist_idx;
+    s_ptr->depth = g_ptr->depth;
+    s_ptr->dup_depth = g_ptr->dup_depth;
+    s_ptr->g_ptr = g_ptr;
+    return;
+}
+
+// Slot of the successor with genome string key, or the empty slot for it
+int* find_successor_slot(struct successor_set *ss_ptr, char *key, guint64 hash) {
+    int slot_idx = hash & (ss_ptr->n_slots - 1);
+    int *slot;
+    while (1) {
+        slot = ss_ptr->slots + slot_idx;
+        if (*slot == 0) {
+            return(slot);
+        }
+        if (*(ss_ptr->hashes + *slot - 1) == hash && strcmp(ss_ptr->keys->str + g_array_index(ss_ptr->successors, struct successor, *slot - 1).key_offset, key) == 0) {
+            return(slot);
+        }
+        slot_idx = (slot_idx + 1) & (ss_ptr->n_slots - 1);
+    }
+}
+
+// Doubles the capacity of the successor table
+void grow_successor_slots(struct successor_set *ss_ptr) {
+    guint i;
+    int slot_idx;
+
+    ss_ptr->n_hashes *= 2;
+    ss_ptr->hashes = realloc(ss_ptr->hashes, ss_ptr->n_hashes * sizeof(guint64));
+    free(ss_ptr->slots);
+    ss_ptr->n_slots = 2 * ss_ptr->n_hashes;
+    ss_ptr->slots = calloc(ss_ptr->n_slots, sizeof(int));
+    if (ss_ptr->hashes == NULL || ss_ptr->slots == NULL) {
+        fprintf(stderr, "\nGrowing successor slots failed. Exiting.\n");
+        exit(1);
+    }
+
+    for (i=0; i<ss_ptr->successors->len; i++) {
+        slot_idx = *(ss_ptr->hashes+i) & (ss_ptr->n_slots - 1);
+        while (*(ss_ptr->slots+slot_idx) != 0) {
+            slot_idx = (slot_idx + 1) & (ss_ptr->n_slots - 1);
+        }
+        *(ss_ptr->slots+slot_idx) = i + 1;
+    }
+    return;
+}
+/*
+    End functions for successor sets
+*/
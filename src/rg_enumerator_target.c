@@ -0,0 +1,173 @@
+/*
+    Functions for the goal-directed target mode.
+
+    In target mode only the derivative genomes whose rearrangement pattern
+    string (output columns 3 and 4) is identical to a given target pattern are
+    printed. Branches that provably cannot reach the target within the
+    remaining depth budget are not expanded.
+
+    The lower bounds used for pruning are the following.
+    * Rearrangements. A single event creates at most two new rearrangement
+      junctions (balanced translocations and inversions create two, the rest
+      create at most one), so if the target has n more rearrangements than the
+      current genome, at least ceil(n/2) more events are needed.
+    * Copy number. Non-duplicative events never increase the copy number of any
+      segment, and a duplicative event at most doubles it. If the highest
+      total copy number of the target is larger than that of the current genome,
+      at least ceil(log2(target/current)) more duplicative events are needed.
+    * Lost alleles. A wild type chromosome allele whose copy number has dropped
+      to zero along its whole length can never be regained, so a genome with
+      more lost alleles than the target cannot reach the target at all.
+*/
+
+struct target_pattern {
+    char *cn_string;  /* Allelic copy number portion of the target pattern string */
+    char *rg_string;  /* Rearrangement portion of the target pattern string */
+    int n_rgs;
+    int max_cn;
+    int n_lost_alleles;
+};
+
+extern int MAX_DEPTH_DUP, MAX_DEPTH_NONDUP;
+extern struct target_pattern *TARGET;
+extern int TARGET_N_FOUND;
+
+#define TARGET_UNREACHABLE (1<<20)
+
+/*
+    Function prototypes
+*/
+void get_rg_pattern_stats(char *cn_string, char *rg_string, int *n_rgs, int *max_cn, int *n_lost_alleles);
+struct target_pattern* create_target_pattern(char *cn_string, char *rg_string);
+void delete_target_pattern(struct target_pattern *t_ptr);
+int check_target(struct genome *g_ptr, GString *cn_string, GString *rg_string, int *can_reach_target);
+/*
+    End function prototypes
+*/
+
+
+/*
+    Collects the statistics needed for the target lower bounds from the two
+    portions of a rearrangement pattern string. Exits if cn_string is malformed.
+*/
+void get_rg_pattern_stats(char *cn_string, char *rg_string, int *n_rgs, int *max_cn, int *n_lost_alleles) {
+    int paternal_cn, maternal_cn, n_chars;
+    int paternal_is_lost = 1, maternal_is_lost = 1;
+    char *c = cn_string;
+
+    *max_cn = 0;
+    *n_lost_alleles = 0;
+    while (1) {
+        if (sscanf(c, "%d,%d%n", &paternal_cn, &maternal_cn, &n_chars) != 2) {
+            fprintf(stderr, "Malformed copy number pattern string '%s' in get_rg_pattern_stats(). Exiting.\n", cn_string);
+            exit(1);
+        }
+        c += n_chars;
+
+        if (paternal_cn + maternal_cn > *max_cn) {
+            *max_cn = paternal_cn + maternal_cn;
+        }
+        if (paternal_cn != 0) { paternal_is_lost = 0; }
+        if (maternal_cn != 0) { maternal_is_lost = 0; }
+
+        // End of a wild type chromosome?
+        if (*c != '/') {
+            *n_lost_alleles += paternal_is_lost + maternal_is_lost;
+            paternal_is_lost = maternal_is_lost = 1;
+        }
+
+        if (*c == '\0') {
+            break;
+        }
+        else if (*c != '/' && *c != ';') {
+            fprintf(stderr, "Malformed copy number pattern string '%s' in get_rg_pattern_stats(). Exiting.\n", cn_string);
+            exit(1);
+        }
+        c++;
+    }
+
+    // Rearrangements are forward slash-separated
+    *n_rgs = 0;
+    if (*rg_string != '\0') {
+        *n_rgs = 1;
+        for (c = rg_string; *c != '\0'; c++) {
+            if (*c == '/') {
+                (*n_rgs)++;
+            }
+        }
+    }
+
+    return;
+}
+
+struct target_pattern* create_target_pattern(char *cn_string, char *rg_string) {
+    struct target_pattern *t_ptr = malloc(sizeof(struct target_pattern));
+    if (t_ptr == NULL) {
+        fprintf(stderr, "\nCreation of target pattern failed. Exiting.\n");
+        exit(1);
+    }
+    t_ptr->cn_string = g_strdup(cn_string);
+    t_ptr->rg_string = g_strdup(rg_string);
+    get_rg_pattern_stats(t_ptr->cn_string, t_ptr->rg_string, &(t_ptr->n_rgs), &(t_ptr->max_cn), &(t_ptr->n_lost_alleles));
+
+    return(t_ptr);
+}
+
+void delete_target_pattern(struct target_pattern *t_ptr) {
+    g_free(t_ptr->cn_string);
+    g_free(t_ptr->rg_string);
+    free(t_ptr);
+    return;
+}
+
+/*
+    Returns whether *g_ptr, with the rearrangement pattern *cn_string and
+    *rg_string from get_rg_pattern(), has the target rearrangement pattern, and
+    sets *can_reach_target to whether any descendant of *g_ptr can still have
+    the target pattern within MAX_DEPTH_NONDUP and MAX_DEPTH_DUP. Only reads
+    global state, so it is safe to call from the batch worker threads.
+*/
+int check_target(struct genome *g_ptr, GString *cn_string, GString *rg_string, int *can_reach_target) {
+    int n_rgs, max_cn, n_lost_alleles, is_target;
+    int depth_lower_bound = 0, dup_depth_lower_bound = 0;
+
+    is_target = (strcmp(cn_string->str, TARGET->cn_string) == 0 && strcmp(rg_string->str, TARGET->rg_string) == 0);
+    get_rg_pattern_stats(cn_string->str, rg_string->str, &n_rgs, &max_cn, &n_lost_alleles);
+
+    // Missing rearrangements
+    if (TARGET->n_rgs > n_rgs) {
+        depth_lower_bound = (TARGET->n_rgs - n_rgs + 1) / 2;
+    }
+
+    // Copy number distance
+    if (TARGET->max_cn > max_cn) {
+        if (max_cn == 0) {
+            dup_depth_lower_bound = TARGET_UNREACHABLE;
+        }
+        else {
+            while (max_cn < TARGET->max_cn) {
+                max_cn *= 2;
+                dup_depth_lower_bound++;
+            }
+        }
+    }
+    if (dup_depth_lower_bound > depth_lower_bound) {
+        depth_lower_bound = dup_depth_lower_bound;
+    }
+
+    // Lost alleles
+    if (n_lost_alleles > TARGET->n_lost_alleles) {
+        depth_lower_bound = TARGET_UNREACHABLE;
+    }
+
+    *can_reach_target = (
+        !is_target &&
+        g_ptr->depth + depth_lower_bound <= MAX_DEPTH_NONDUP &&
+        g_ptr->dup_depth + dup_depth_lower_bound <= MAX_DEPTH_DUP
+    );
+
+    return(is_target);
+}
+/*
+    End functions for the goal-directed target mode
+*/
@@ -0,0 +1,620 @@
+/*
+    Multi-process enumeration, see run_workers(). The parent forks workers,
+    each with its own heap, its own seen_somatic_genomes and its own output
+    file, and then coordinates them. The workers share a fingerprint set in
+    an anonymous shared memory mapping, set up before the fork, in which they
+    claim the genomes they expand, so that a genome expanded by one worker is
+    only printed as seen by the others.
+
+    The set is open-addressing, with three words per slot: the 64-bit hash of
+    the canonical genome string, claimed with a compare-and-swap, then the
+    (depth, dup_depth) of the expansion and the offset of its detailed history
+    in an arena of the same mapping, published once the history and the
+    restrictions of the expansion (see get_child_restrictions()) are written.
+    A genome has one slot per expansion, as in the Pareto fronts of
+    seen_somatic_genomes, and slots are never freed, so a lookup scans the
+    probe sequence up to the first empty slot. Two genomes with the same hash
+    are taken for the same genome, which is unlikely below billions of
+    genomes. Once the set or its arena is full, genomes are expanded without
+    being claimed, so the enumeration still completes, but the workers can
+    repeat each other's work.
+
+    The work is balanced dynamically. Each worker is linked to the parent by
+    a Unix domain socket pair, over which they exchange messages of one line.
+    A worker out of work says "IDLE", and the parent answers with a work unit
+    (see run_work_units()), or "DONE" once all the workers are idle and no
+    unit is left. The first unit is the whole enumeration. When a worker is
+    idle and no unit is queued, the parent asks the busy workers to "DONATE",
+    and they answer with a unit of the children they have left at their
+    shallowest depth, or "NONE".
+
+    Without shared memory, the table of seen genomes is partitioned between
+    the workers instead: each canonical genome string belongs to the worker
+    get_seen_owner() picks from its hash, and only that worker keeps it in
+    its seen_somatic_genomes, so each one holds about 1/n of the table. The
+    workers are linked to each other by socket pairs as well, over which they
+    claim the children of a batch from their owners, one message per owner
+    for the whole batch (see claim_batch_children()). Every genome is then
+    expanded once, as with the shared set, and the table is not limited to
+    the shared mapping.
+*/
+
+extern struct shared_seen_set *SHARED_SEEN;
+extern struct worker_link *WORKER_LINK;
+extern struct worker_link **PEER_LINKS;
+extern int N_WORKERS, WORKER_IDX;
+
+struct shared_seen_set {
+    guint64 *slots;       /* Hash, point and restrictions of each slot, 0 if empty */
+    guint64 n_slots;      /* A power of two */
+    guint64 max_used;     /* Slots claimed before the set is full */
+    guint64 n_used;
+    char *arena;          /* Detailed histories of the claimed expansions */
+    guint64 arena_size;
+    guint64 arena_used;
+    guint64 n_unclaimed;  /* Expansions not claimed since the set was full */
+    size_t map_size;
+};
+#define SHARED_SEEN_SLOT_WORDS 3
+#define SHARED_SEEN_SLOT_BYTES (SHARED_SEEN_SLOT_WORDS * sizeof(guint64))
+
+// End of the socket pair between the parent and a worker, or between two workers
+struct worker_link {
+    int fd;
+    GString *in;         /* Bytes received after the last complete message */
+    GString *out;        /* Messages queued, not sent yet, see queue_worker_message() */
+    GQueue *claims;      /* Children waiting for an answer of the owner at the other end, between workers */
+    int state;           /* WORKER_BUSY, WORKER_ASKED or WORKER_IDLE, in the parent */
+    gint64 next_ask_time;  /* Microseconds, before which a worker that had nothing to donate is not asked again */
+    int n_until_check;   /* Children handled before the next check for requests, in the worker */
+};
+enum worker_state {
+    WORKER_BUSY,
+    WORKER_ASKED,  /* Busy, and asked to donate */
+    WORKER_IDLE
+};
+#define WORKER_ASK_INTERVAL 1000  /* Microseconds */
+
+/*
+    Function prototypes
+*/
+struct shared_seen_set* create_shared_seen_set(long n_bytes);
+void delete_shared_seen_set(struct shared_seen_set *ss_ptr);
+char* claim_shared_genome(guint64 hash, int depth, int dup_depth, guint64 restrictions, char *genome_hist);
+struct worker_link* create_worker_link(int fd);
+void delete_worker_link(struct worker_link *wl_ptr);
+void send_worker_message(struct worker_link *wl_ptr, char *message);
+void queue_worker_message(struct worker_link *wl_ptr, char *message);
+void flush_worker_messages(struct worker_link *wl_ptr);
+int receive_worker_bytes(struct worker_link *wl_ptr);
+char* next_worker_message(struct worker_link *wl_ptr);
+char* wait_worker_message(struct worker_link *wl_ptr);
+int has_worker_message(struct worker_link *wl_ptr);
+long run_workers(struct rg_engine *e_ptr, int n_workers, long shared_memory, char *output_prefix, int is_binary);
+void run_worker(struct rg_engine *e_ptr, int worker_idx, char *output_prefix, int is_binary);
+void coordinate_workers(struct worker_link **links, int n_workers);
+int* create_peer_fds(int n_workers);
+/*
+    End function prototypes
+*/
+
+
+/*
+    Functions for the shared fingerprint set
+*/
+/*
+    A quarter of the mapping goes to the slots, the rest to the histories,
+    which take about 40 bytes each against 24 for a slot.
+*/
+struct shared_seen_set* create_shared_seen_set(long n_bytes) {
+    void *map;
+    struct shared_seen_set *ss_ptr;
+    guint64 n_slots = 1;
+
+    while (n_slots * 2 * SHARED_SEEN_SLOT_BYTES <= (guint64)n_bytes / 4) {
+        n_slots *= 2;
+    }
+    if ((guint64)n_bytes < sizeof(struct shared_seen_set) + n_slots * SHARED_SEEN_SLOT_BYTES + 1024) {
+        fprintf(stderr, "\nShared memory of %ld bytes is too small. Exiting.\n", n_bytes);
+        exit(1);
+    }
+    map = mmap(NULL, n_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "\nCreation of shared seen genome set failed. Exiting.\n");
+        exit(1);
+    }
+
+    // The mapping is zero-filled, and is at the same address in the workers
+    ss_ptr = (struct shared_seen_set*)map;
+    ss_ptr->map_size = n_bytes;
+    ss_ptr->slots = (guint64*)((char*)map + sizeof(struct shared_seen_set));
+    ss_ptr->n_slots = n_slots;
+    ss_ptr->max_used = n_slots / 8 * 7;
+    ss_ptr->arena = (char*)(ss_ptr->slots + SHARED_SEEN_SLOT_WORDS * n_slots);
+    ss_ptr->arena_size = n_bytes - sizeof(struct shared_seen_set) - n_slots * SHARED_SEEN_SLOT_BYTES;
+
+    return(ss_ptr);
+}
+
+void delete_shared_seen_set(struct shared_seen_set *ss_ptr) {
+    munmap(ss_ptr, ss_ptr->map_size);
+    return;
+}
+
+/*
+    Claims for this worker the expansion, with depth events and dup_depth
+    duplicative events, of the genome whose genome string has the given
+    hash_genome_string(), unless a worker already claimed one with at most as
+    many of both and restrictions among the given ones. Returns NULL if the caller is to expand the genome,
+    otherwise the detailed history of the earlier expansion, in the shared
+    mapping.
+*/
+char* claim_shared_genome(guint64 hash, int depth, int dup_depth, guint64 restrictions, char *genome_hist) {
+    struct shared_seen_set *ss_ptr = SHARED_SEEN;
+    guint64 idx, key, point, expected;
+    guint64 hist_offset = 0;
+    size_t hist_len = strlen(genome_hist) + 1;
+    guint64 *slot;
+
+    hash += (hash == 0);
+    idx = hash & (ss_ptr->n_slots - 1);
+    while (1) {
+        slot = ss_ptr->slots + SHARED_SEEN_SLOT_WORDS * idx;
+        key = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+        if (key == 0) {
+            if (__atomic_load_n(&(ss_ptr->n_used), __ATOMIC_RELAXED) >= ss_ptr->max_used) {
+                __atomic_fetch_add(&(ss_ptr->n_unclaimed), 1, __ATOMIC_RELAXED);
+                return(NULL);
+            }
+            if (hist_offset == 0) {  // Kept if the slot is taken by another genome first
+                hist_offset = __atomic_fetch_add(&(ss_ptr->arena_used), hist_len, __ATOMIC_RELAXED) + 1;
+                if (hist_offset - 1 + hist_len > ss_ptr->arena_size) {
+                    __atomic_fetch_add(&(ss_ptr->n_unclaimed), 1, __ATOMIC_RELAXED);
+                    return(NULL);
+                }
+                memcpy(ss_ptr->arena + hist_offset - 1, genome_hist, hist_len);
+            }
+            expected = 0;
+            if (__atomic_compare_exchange_n(slot, &expected, hash, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                point = ((guint64)depth << 56) | ((guint64)dup_depth << 48) | hist_offset;
+                __atomic_store_n(slot+2, restrictions, __ATOMIC_RELAXED);
+                __atomic_store_n(slot+1, point, __ATOMIC_RELEASE);
+                __atomic_fetch_add(&(ss_ptr->n_used), 1, __ATOMIC_RELAXED);
+                return(NULL);
+            }
+            key = expected;
+        }
+        if (key == hash) {
+            // The point is published right after the hash, and after the restrictions
+            while ((point = __atomic_load_n(slot+1, __ATOMIC_ACQUIRE)) == 0) {
+                sched_yield();
+            }
+            if ((point >> 56) <= (guint64)depth && ((point >> 48) & 255) <= (guint64)dup_depth && (__atomic_load_n(slot+2, __ATOMIC_RELAXED) & ~restrictions) == 0) {
+                return(ss_ptr->arena + (point & (((guint64)1 << 48) - 1)) - 1);
+            }
+        }
+        idx = (idx + 1) & (ss_ptr->n_slots - 1);
+    }
+}
+/*
+    End functions for the shared fingerprint set
+*/
+
+
+/*
+    Functions for worker links
+*/
+struct worker_link* create_worker_link(int fd) {
+    struct worker_link *wl_ptr = malloc(sizeof(struct worker_link));
+    if (wl_ptr == NULL) {
+        fprintf(stderr, "\nCreation of worker link failed. Exiting.\n");
+        exit(1);
+    }
+    wl_ptr->fd = fd;
+    wl_ptr->in = g_string_new(NULL);
+    wl_ptr->out = g_string_new(NULL);
+    wl_ptr->claims = g_queue_new();
+    wl_ptr->state = WORKER_BUSY;
+    wl_ptr->next_ask_time = 0;
+    wl_ptr->n_until_check = 1;
+    return(wl_ptr);
+}
+
+void delete_worker_link(struct worker_link *wl_ptr) {
+    close(wl_ptr->fd);
+    g_string_free(wl_ptr->in, 1);
+    g_string_free(wl_ptr->out, 1);
+    g_queue_free(wl_ptr->claims);
+    free(wl_ptr);
+    return;
+}
+
+void send_worker_message(struct worker_link *wl_ptr, char *message) {
+    GString *line = g_string_new(message);
+    ssize_t n_written;
+    gsize n_done = 0;
+
+    g_string_append_c(line, '\n');
+    while (n_done < line->len) {
+        n_written = write(wl_ptr->fd, line->str + n_done, line->len - n_done);
+        if (n_written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n_written <= 0) {
+            fprintf(stderr, "\nSending a message between workers failed. Exiting.\n");
+            exit(1);
+        }
+        n_done += n_written;
+    }
+    g_string_free(line, 1);
+    return;
+}
+
+/*
+    Queues a message to be sent by flush_worker_messages(), for links on
+    which both ends send requests, which must not block each other.
+*/
+void queue_worker_message(struct worker_link *wl_ptr, char *message) {
+    g_string_append(wl_ptr->out, message);
+    g_string_append_c(wl_ptr->out, '\n');
+    return;
+}
+
+// Sends as much of the queued messages as the socket takes without blocking
+void flush_worker_messages(struct worker_link *wl_ptr) {
+    ssize_t n_written;
+
+    while (wl_ptr->out->len > 0) {
+        n_written = send(wl_ptr->fd, wl_ptr->out->str, wl_ptr->out->len, MSG_DONTWAIT);
+        if (n_written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n_written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (n_written <= 0) {
+            fprintf(stderr, "\nSending a message between workers failed. Exiting.\n");
+            exit(1);
+        }
+        g_string_erase(wl_ptr->out, 0, n_written);
+    }
+    return;
+}
+
+// Reads what has arrived, at least one byte, and returns 0 at the end of the stream
+int receive_worker_bytes(struct worker_link *wl_ptr) {
+    char bfr[4096];
+    ssize_t n_read;
+
+    do {
+        n_read = read(wl_ptr->fd, bfr, sizeof(bfr));
+    } while (n_read < 0 && errno == EINTR);
+    if (n_read < 0) {
+        fprintf(stderr, "\nReceiving a message between workers failed. Exiting.\n");
+        exit(1);
+    }
+    g_string_append_len(wl_ptr->in, bfr, n_read);
+    return(n_read > 0);
+}
+
+// The next complete message received, without its newline, or NULL
+char* next_worker_message(struct worker_link *wl_ptr) {
+    char *end = memchr(wl_ptr->in->str, '\n', wl_ptr->in->len);
+    char *message;
+
+    if (end == NULL) {
+        return(NULL);
+    }
+    message = g_strndup(wl_ptr->in->str, end - wl_ptr->in->str);
+    g_string_erase(wl_ptr->in, 0, end - wl_ptr->in->str + 1);
+    return(message);
+}
+
+char* wait_worker_message(struct worker_link *wl_ptr) {
+    char *message;
+    while ((message = next_worker_message(wl_ptr)) == NULL) {
+        if (!receive_worker_bytes(wl_ptr)) {
+            fprintf(stderr, "\nWorker link closed unexpectedly. Exiting.\n");
+            exit(1);
+        }
+    }
+    return(message);
+}
+
+// Whether a message is waiting, without blocking
+int has_worker_message(struct worker_link *wl_ptr) {
+    struct pollfd pfd = {wl_ptr->fd, POLLIN, 0};
+    return(memchr(wl_ptr->in->str, '\n', wl_ptr->in->len) != NULL || poll(&pfd, 1, 0) > 0);
+}
+/*
+    End functions for worker links
+*/
+
+
+/*
+    Functions for workers
+*/
+/*
+    Runs the engine on n_workers processes sharing shared_memory MB, or
+    partitioning the table of seen genomes between them if shared_memory is
+    0, and returns the number of derivative genomes visited by all of them.
+    Worker i writes the text or binary output to <output_prefix>.<i>. The
+    sink of the engine is not used. Which worker expands a genome depends on their
+    timing, so the files differ from run to run, but together they hold every
+    derivative genome, and every genome printed as seen refers to a history
+    printed in one of them.
+*/
+long run_workers(struct rg_engine *e_ptr, int n_workers, long shared_memory, char *output_prefix, int is_binary) {
+    struct worker_link **links = malloc(n_workers * sizeof(struct worker_link*));
+    long n_visited = 0, n_worker_visited;
+    int *peer_fds = NULL;
+    char *message;
+    int i, j, status, n_failed = 0;
+    int fds[2];
+    pid_t pid;
+
+    if (n_workers < 1) {
+        fprintf(stderr, "\nThe number of workers must be at least 1. Exiting.\n");
+        exit(1);
+    }
+    if (links == NULL) {
+        fprintf(stderr, "\nCreation of worker links failed. Exiting.\n");
+        exit(1);
+    }
+    if (shared_memory > 0) {
+        SHARED_SEEN = create_shared_seen_set(shared_memory << 20);
+    }
+    else if (n_workers > 1) {
+        peer_fds = create_peer_fds(n_workers);
+    }
+    fflush(stdout);
+    fflush(stderr);
+    for (i=0; i<n_workers; i++) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            fprintf(stderr, "\nCreation of the socket of worker %d failed. Exiting.\n", i);
+            exit(1);
+        }
+        pid = fork();
+        if (pid < 0) {
+            fprintf(stderr, "\nStarting worker %d failed. Exiting.\n", i);
+            exit(1);
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            for (j=0; j<i; j++) {
+                close((*(links+j))->fd);
+            }
+            WORKER_LINK = create_worker_link(fds[1]);
+            N_WORKERS = n_workers;
+            WORKER_IDX = i;
+            if (peer_fds != NULL) {
+                PEER_LINKS = malloc(n_workers * sizeof(struct worker_link*));
+                if (PEER_LINKS == NULL) {
+                    fprintf(stderr, "\nCreation of peer links failed. Exiting.\n");
+                    exit(1);
+                }
+                for (j=0; j<n_workers*n_workers; j++) {
+                    if (j / n_workers != i && *(peer_fds+j) >= 0) {
+                        close(*(peer_fds+j));
+                    }
+                }
+                for (j=0; j<n_workers; j++) {
+                    *(PEER_LINKS+j) = (j == i ? NULL : create_worker_link(*(peer_fds+i*n_workers+j)));
+                }
+            }
+            run_worker(e_ptr, i, output_prefix, is_binary);
+            _exit(0);
+        }
+        close(fds[1]);
+        *(links+i) = create_worker_link(fds[0]);
+    }
+    if (peer_fds != NULL) {
+        for (j=0; j<n_workers*n_workers; j++) {
+            if (*(peer_fds+j) >= 0) {
+                close(*(peer_fds+j));
+            }
+        }
+        free(peer_fds);
+    }
+
+    coordinate_workers(links, n_workers);
+
+    for (i=0; i<n_workers; i++) {
+        while (strcmp((message = wait_worker_message(*(links+i))), "NONE") == 0) {  // Asked to donate just before going idle
+            g_free(message);
+        }
+        if (sscanf(message, "VISITED %ld", &n_worker_visited) != 1) {
+            fprintf(stderr, "\nUnexpected message '%s' from worker %d. Exiting.\n", message, i);
+            exit(1);
+        }
+        n_visited += n_worker_visited;
+        g_free(message);
+    }
+    // The links stay open until all the workers are done, since a worker can still answer a request to donate
+    for (i=0; i<n_workers; i++) {
+        if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            n_failed++;
+        }
+    }
+    for (i=0; i<n_workers; i++) {
+        delete_worker_link(*(links+i));
+    }
+    free(links);
+    if (n_failed > 0) {
+        fprintf(stderr, "\n%d of the %d workers failed. Exiting.\n", n_failed, n_workers);
+        exit(1);
+    }
+
+    if (SHARED_SEEN != NULL) {
+        if (SHARED_SEEN->n_unclaimed > 0) {
+            fprintf(stderr, "Shared seen genomes reached %ld MB, %lu expansions could be repeated by several workers.\n", shared_memory, (unsigned long)SHARED_SEEN->n_unclaimed);
+        }
+        delete_shared_seen_set(SHARED_SEEN);
+        SHARED_SEEN = NULL;
+    }
+
+    return(n_visited);
+}
+
+// In the worker process, see run_work_units()
+void run_worker(struct rg_engine *e_ptr, int worker_idx, char *output_prefix, int is_binary) {
+    char *path = g_strdup_printf("%s.%d", output_prefix, worker_idx);
+    FILE *out = fopen(path, "w");
+    char *visited;
+    int i;
+
+    if (out == NULL) {
+        fprintf(stderr, "\nCould not open worker output %s. Exiting.\n", path);
+        exit(1);
+    }
+    e_ptr->sink = (is_binary ? create_binary_sink(out) : create_text_sink(out));
+
+    visited = g_strdup_printf("VISITED %ld", run_engine(e_ptr));
+
+    delete_sink(e_ptr->sink);
+    e_ptr->sink = NULL;
+    if (fclose(out) != 0) {
+        fprintf(stderr, "\nCould not write worker output %s. Exiting.\n", path);
+        exit(1);
+    }
+    g_free(path);
+    send_worker_message(WORKER_LINK, visited);
+    g_free(visited);
+
+    delete_worker_link(WORKER_LINK);
+    WORKER_LINK = NULL;
+    if (PEER_LINKS != NULL) {
+        for (i=0; i<N_WORKERS; i++) {
+            if (*(PEER_LINKS+i) != NULL) {
+                delete_worker_link(*(PEER_LINKS+i));
+            }
+        }
+        free(PEER_LINKS);
+        PEER_LINKS = NULL;
+    }
+    return;
+}
+
+/*
+    Hands out the units until all the workers are idle and none is left,
+    then tells the workers they are done.
+*/
+void coordinate_workers(struct worker_link **links, int n_workers) {
+    GQueue *units = g_queue_new();
+    struct pollfd *pfds = malloc(n_workers * sizeof(struct pollfd));
+    struct worker_link *wl_ptr;
+    char *message;
+    gint64 now;
+    int i, n_idle;
+
+    if (pfds == NULL) {
+        fprintf(stderr, "\nCreation of worker poll set failed. Exiting.\n");
+        exit(1);
+    }
+    g_queue_push_tail(units, g_strdup("UNIT 0 -1 0 -"));  // All the children of the WT genome
+
+    while (1) {
+        n_idle = 0;
+        for (i=0; i<n_workers; i++) {
+            wl_ptr = *(links+i);
+            if (wl_ptr->state == WORKER_IDLE && !g_queue_is_empty(units)) {
+                message = g_queue_pop_head(units);
+                send_worker_message(wl_ptr, message);
+                g_free(message);
+                wl_ptr->state = WORKER_BUSY;
+            }
+            n_idle += (wl_ptr->state == WORKER_IDLE);
+        }
+        if (n_idle == n_workers) {
+            break;
+        }
+        if (n_idle > 0) {
+            now = g_get_monotonic_time();
+            for (i=0; i<n_workers; i++) {
+                wl_ptr = *(links+i);
+                if (wl_ptr->state == WORKER_BUSY && now >= wl_ptr->next_ask_time) {
+                    send_worker_message(wl_ptr, "DONATE");
+                    wl_ptr->state = WORKER_ASKED;
+                }
+            }
+        }
+
+        for (i=0; i<n_workers; i++) {
+            (pfds+i)->fd = (*(links+i))->fd;
+            (pfds+i)->events = POLLIN;
+        }
+        if (poll(pfds, (unsigned int)n_workers, (n_idle > 0 ? WORKER_ASK_INTERVAL / 1000 : -1)) < 0 && errno != EINTR) {
+            fprintf(stderr, "\nWaiting for the workers failed. Exiting.\n");
+            exit(1);
+        }
+        for (i=0; i<n_workers; i++) {
+            wl_ptr = *(links+i);
+            if (((pfds+i)->revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                continue;
+            }
+            if (!receive_worker_bytes(wl_ptr)) {
+                fprintf(stderr, "\nWorker %d stopped before the end. Exiting.\n", i);
+                exit(1);
+            }
+            while ((message = next_worker_message(wl_ptr)) != NULL) {
+                if (strcmp(message, "IDLE") == 0) {
+                    wl_ptr->state = WORKER_IDLE;
+                    g_free(message);
+                }
+                else if (strcmp(message, "NONE") == 0 || strncmp(message, "UNIT ", 5) == 0) {
+                    if (wl_ptr->state == WORKER_ASKED) {
+                        wl_ptr->state = WORKER_BUSY;
+                    }
+                    if (*message == 'N') {
+                        wl_ptr->next_ask_time = g_get_monotonic_time() + WORKER_ASK_INTERVAL;
+                        g_free(message);
+                    }
+                    else {
+                        g_queue_push_tail(units, message);
+                    }
+                }
+                else {
+                    fprintf(stderr, "\nUnexpected message '%s' from worker %d. Exiting.\n", message, i);
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    for (i=0; i<n_workers; i++) {
+        send_worker_message(*(links+i), "DONE");
+    }
+    g_queue_free(units);
+    free(pfds);
+    return;
+}
+
+/*
+    Socket pairs between every two workers, before they are forked: the end
+    kept by worker i for worker j is at i * n_workers + j, and the diagonal
+    is -1.
+*/
+int* create_peer_fds(int n_workers) {
+    int *peer_fds = malloc(n_workers * n_workers * sizeof(int));
+    int i, j, fds[2];
+
+    if (peer_fds == NULL) {
+        fprintf(stderr, "\nCreation of peer sockets failed. Exiting.\n");
+        exit(1);
+    }
+    for (i=0; i<n_workers; i++) {
+        *(peer_fds+i*n_workers+i) = -1;
+        for (j=i+1; j<n_workers; j++) {
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+                fprintf(stderr, "\nCreation of the socket between workers %d and %d failed. Exiting.\n", i, j);
+                exit(1);
+            }
+            *(peer_fds+i*n_workers+j) = fds[0];
+            *(peer_fds+j*n_workers+i) = fds[1];
+        }
+    }
+    return(peer_fds);
+}
+/*
+    End functions for workers
+*/